@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <spawn.h>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+extern char** environ;
+
+// Times each binary from spawn to exit, the way login scripts and hotkeys run it: first
+// --help cold and warm, which is nothing but loading and relocation, then each CLI
+// subcommand on the first binary.
+// Usage: vivid-cli-bench <path to vivid-cli> [<path to vivid> ...] [--runs N]
+
+namespace {
+
+const int kColdRuns = 5;
+
+bool runOnce(const std::vector<std::string>& args, double& ms) {
+    std::vector<char*> argv;
+    for (const auto& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid;
+    int error = posix_spawn(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (error != 0) return false;
+
+    int status = 0;
+    if (waitpid(pid, &status, 0) != pid) return false;
+    ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// The binary and every shared object the loader maps for it
+std::vector<std::string> loadedFiles(const std::string& binary) {
+    std::vector<std::string> files = {binary};
+    std::string command = "LD_TRACE_LOADED_OBJECTS=1 '" + binary + "' 2>/dev/null";
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe) return files;
+
+    char buffer[512];
+    while (fgets(buffer, sizeof(buffer), pipe)) {
+        std::string line = buffer;
+        size_t arrow = line.find("=> ");
+        size_t start = (arrow != std::string::npos) ? arrow + 3 : line.find('/');
+        if (start == std::string::npos || line.compare(start, 1, "/") != 0) continue;
+        files.push_back(line.substr(start, line.find(" (", start) - start));
+    }
+    pclose(pipe);
+    return files;
+}
+
+// Drops the files' clean pages from the page cache. Pages other processes still map
+// (libc, usually) stay resident, so "cold" is a lower bound on a true first start.
+void evict(const std::vector<std::string>& files) {
+    for (const auto& file : files) {
+        int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) continue;
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+}
+
+double median(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+std::string firstDisplay(const std::string& vivid) {
+    std::string command = "'" + vivid + "' --list 2>/dev/null";
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe) return "";
+
+    char buffer[256];
+    std::string display;
+    if (fgets(buffer, sizeof(buffer), pipe)) {
+        display = buffer;
+        display = display.substr(0, display.find(' '));
+    }
+    pclose(pipe);
+    return display;
+}
+
+std::string baseName(const std::string& path) {
+    size_t slash = path.rfind('/');
+    return (slash == std::string::npos) ? path : path.substr(slash + 1);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> binaries;
+    int runs = 20;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--runs" && i + 1 < argc) {
+            runs = std::max(1, std::atoi(argv[++i]));
+        } else {
+            binaries.push_back(arg);
+        }
+    }
+    if (binaries.empty()) {
+        std::cerr << "usage: " << argv[0] << " <path to vivid-cli> [<path to vivid> ...] [--runs N]\n";
+        return 1;
+    }
+
+    std::cout << "Start to exit of --help (cold: median of " << kColdRuns
+              << " runs after evicting the binary and its libraries; warm: " << runs << " runs)\n\n";
+    std::cout << std::left << std::setw(14) << "binary" << std::setw(8) << "libs" << std::setw(10) << "cold ms"
+              << std::setw(10) << "warm min" << std::setw(10) << "median" << "max\n";
+
+    for (const auto& binary : binaries) {
+        std::vector<std::string> files = loadedFiles(binary);
+        std::vector<std::string> command = {binary, "--help"};
+        double ms;
+
+        std::vector<double> cold;
+        for (int i = 0; i < kColdRuns; i++) {
+            evict(files);
+            if (!runOnce(command, ms)) {
+                std::cerr << binary << " --help failed\n";
+                return 1;
+            }
+            cold.push_back(ms);
+        }
+
+        std::vector<double> warm;
+        for (int i = 0; i < runs; i++) {
+            if (!runOnce(command, ms)) {
+                std::cerr << binary << " --help failed\n";
+                return 1;
+            }
+            warm.push_back(ms);
+        }
+        std::sort(warm.begin(), warm.end());
+
+        std::cout << std::left << std::setw(14) << baseName(binary) << std::setw(8) << (files.size() - 1)
+                  << std::fixed << std::setprecision(2) << std::setw(10) << median(cold)
+                  << std::setw(10) << warm.front() << std::setw(10) << median(warm) << warm.back() << "\n";
+    }
+
+    const std::string& vivid = binaries.front();
+    std::string display = firstDisplay(vivid);
+    if (display.empty()) {
+        std::cout << "\n" << baseName(vivid) << " --list reported no display; skipping the commands\n";
+        return 0;
+    }
+
+    std::cout << "\nCLI startup-to-exit of " << baseName(vivid) << " (" << runs << " runs, display " << display << ")\n\n";
+    std::cout << std::left << std::setw(14) << "command" << std::setw(10) << "min ms"
+              << std::setw(10) << "median" << "max\n";
+
+    // --reset last, so the benchmark leaves the screen neutral
+    const std::vector<std::vector<std::string>> commands = {
+        {vivid, "--list"},
+        {vivid, "--set", display, "40"},
+        {vivid, "--reset"},
+    };
+
+    for (const auto& command : commands) {
+        std::vector<double> samples;
+        for (int i = 0; i < runs; i++) {
+            double ms;
+            if (!runOnce(command, ms)) {
+                std::cerr << command[1] << " failed\n";
+                return 1;
+            }
+            samples.push_back(ms);
+        }
+        std::sort(samples.begin(), samples.end());
+        std::cout << std::left << std::setw(14) << command[1] << std::fixed << std::setprecision(2)
+                  << std::setw(10) << samples.front() << std::setw(10) << samples[samples.size() / 2]
+                  << samples.back() << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include "backends/XRandrCtmWriter.h"
+#include "core/ColorMatrix.h"
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <vector>
+
+// Checks the tabled saturation matrices and the CTM property writer against a mock
+// property store, then reports the cost of a vibrance apply.
+
+namespace {
+
+class MockPropertyStore : public OutputPropertyStore {
+public:
+    std::map<std::string, std::vector<uint32_t>> values;
+    int writes = 0;
+    int commits = 0;
+    bool rejectCommit = false;
+
+    bool hasProperty(const std::string& output, const std::string& property) override {
+        return property == "CTM" && output != "VGA-1";
+    }
+
+    bool setProperty32(const std::string& output, const std::string& property,
+                       const std::vector<uint32_t>& data) override {
+        if (property != "CTM" || data.size() != 18) return false;
+        values[output] = data;
+        writes++;
+        return true;
+    }
+
+    bool commit() override {
+        commits++;
+        return !rejectCommit;
+    }
+};
+
+double fromS31_32(uint64_t value) {
+    double magnitude = static_cast<double>(value & ~(1ULL << 63)) / 4294967296.0;
+    return (value >> 63) ? -magnitude : magnitude;
+}
+
+bool check(bool condition, const char* what) {
+    if (!condition) std::cerr << "FAIL: " << what << "\n";
+    return condition;
+}
+
+bool verifyMatrices() {
+    bool ok = true;
+    ok &= check(vibranceToCtm(0).isIdentity(), "level 0 is identity");
+    ok &= check(vibranceToCtm(500) == vibranceToCtm(100), "levels clamp");
+
+    for (int level = -100; level <= 100; level++) {
+        const Ctm& ctm = vibranceToCtm(level);
+        ColorMatrix exact = vibranceToColorMatrix(level);
+        for (int row = 0; row < 3; row++) {
+            // Rows sum to 1 so a grey input stays the same grey
+            double sum = 0.0;
+            for (int col = 0; col < 3; col++) {
+                double value = fromS31_32(ctm.m[row * 3 + col]);
+                sum += value;
+                if (std::fabs(value - exact.m[row * 3 + col]) > 1.0 / 4294967296.0) {
+                    std::cerr << "FAIL: fixed point off at level " << level << "\n";
+                    return false;
+                }
+            }
+            if (std::fabs(sum - 1.0) > 1e-6) {
+                std::cerr << "FAIL: row " << row << " of level " << level << " sums to " << sum << "\n";
+                return false;
+            }
+        }
+    }
+    return ok;
+}
+
+bool verifyWriter() {
+    MockPropertyStore store;
+    XRandrCtmWriter writer(store);
+    bool ok = true;
+
+    std::vector<uint32_t> words = XRandrCtmWriter::encode(vibranceToCtm(-50));
+    uint64_t first = (static_cast<uint64_t>(words[1]) << 32) | words[0];
+    ok &= check(first == vibranceToCtm(-50).m[0], "low word first");
+
+    ok &= check(writer.apply({{"HDMI-A-1", vibranceToCtm(40)}}), "apply");
+    ok &= check(store.writes == 1 && store.commits == 1, "one write, one commit");
+    ok &= check(writer.apply({{"HDMI-A-1", vibranceToCtm(40)}}), "repeat apply");
+    ok &= check(store.writes == 1 && store.commits == 1, "unchanged matrix is not re-sent");
+
+    ok &= check(!writer.apply({{"HDMI-A-1", vibranceToCtm(10)}, {"VGA-1", vibranceToCtm(10)}}),
+                "unsupported output fails the batch");
+    ok &= check(store.writes == 1, "failed batch writes nothing");
+
+    store.rejectCommit = true;
+    ok &= check(!writer.apply({{"HDMI-A-1", vibranceToCtm(20)}}), "rejected commit reported");
+    store.rejectCommit = false;
+    ok &= check(writer.apply({{"HDMI-A-1", vibranceToCtm(40)}}), "apply after rejection");
+    ok &= check(store.writes == 3, "state re-sent after rejection");
+    return ok;
+}
+
+double nsPerApply() {
+    MockPropertyStore store;
+    XRandrCtmWriter writer(store);
+    const int iterations = 200000;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        writer.apply({{"HDMI-A-1", vibranceToCtm((i % 201) - 100)}});
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+double nsPerMatrix() {
+    // What every apply would cost without the table
+    const int iterations = 2000000;
+    volatile uint64_t sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        sink = sink + toCtm(vibranceToColorMatrix((i % 201) - 100)).m[4];
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "CTM saturation benchmark\n\n";
+
+    if (!verifyMatrices() || !verifyWriter()) {
+        return 1;
+    }
+    std::cout << "Verification: OK\n\n";
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  matrix + S31.32 conversion: " << nsPerMatrix() << " ns\n";
+    std::cout << "  apply via mock store:       " << nsPerApply() << " ns\n";
+    return 0;
+}
@@ -0,0 +1,366 @@
+#include "FakeDdcMonitor.h"
+#include "backends/DdcCi.h"
+#include "core/DdcDisplayCache.h"
+#include "core/DdcWriteScheduler.h"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Runs the DDC/CI protocol against a fake monitor: framing and checksums both ways,
+// unsupported features, retries on NAKs, null replies and corrupt replies, the per-bus
+// pacing, capabilities, the EDID-keyed display cache and the per-bus write scheduler.
+// Then times a command with the waits removed, which is the protocol's own cost, and
+// with the spec's waits, which is what a monitor actually sees; a start from the cache
+// against a full detection; and a slider drag and two buses through the scheduler.
+
+namespace {
+
+bool g_failed = false;
+
+const char* const kCapabilities =
+    "(prot(monitor)type(LCD)model(U2720Q)cmds(01 02 03 07 0C E3 F3)vcp(02 04 05 08 10 12 14(05 08 0B 0C) "
+    "16 18 1A 52 60(0F 11 1B) 62 8A AA(01 02) D6(01 04 05) DC(00 03 05) DF E0 E1 F0(00 08) FD)mccs_ver(2.1))";
+
+void expect(bool condition, const std::string& what) {
+    std::cout << "  " << std::left << std::setw(48) << what << (condition ? "ok" : "FAILED") << "\n";
+    if (!condition) g_failed = true;
+}
+
+DdcTiming noWaits() {
+    DdcTiming timing;
+    timing.replyDelay = std::chrono::milliseconds(0);
+    timing.commandInterval = std::chrono::milliseconds(0);
+    return timing;
+}
+
+struct Rig {
+    FakeDdcMonitor* monitor;
+    std::unique_ptr<DdcCi> ddc;
+
+    explicit Rig(const DdcTiming& timing, const std::string& path = "/dev/i2c-fake") {
+        auto fake = std::make_unique<FakeDdcMonitor>(path);
+        monitor = fake.get();
+        monitor->setFeature(VcpCode::BRIGHTNESS, 80, 100);
+        monitor->setFeature(VcpCode::CONTRAST, 50, 100);
+        monitor->setFeature(VcpCode::COLOR_PRESET, 0x05, 0x0B);
+        monitor->setFeature(VcpCode::SATURATION, 50, 100);
+        monitor->setCapabilities(kCapabilities);
+        monitor->setEdid(FakeDdcMonitor::makeEdid(1));
+        ddc = std::make_unique<DdcCi>(std::move(fake), timing);
+    }
+};
+
+void checkProtocol() {
+    std::cout << "protocol\n";
+    Rig rig(noWaits());
+    VcpValue value;
+
+    expect(rig.ddc->getVcp(VcpCode::SATURATION, value) && value.current == 50 && value.maximum == 100,
+           "get saturation");
+    expect(rig.ddc->setVcp(VcpCode::CONTRAST, 70) && rig.monitor->getCurrent(VcpCode::CONTRAST) == 70,
+           "set contrast");
+    expect(rig.ddc->setVcp(VcpCode::COLOR_PRESET, 0x08) && rig.ddc->getVcp(VcpCode::COLOR_PRESET, value) &&
+           value.current == 0x08, "set and read back colour preset");
+    expect(rig.ddc->setVcp(VcpCode::SATURATION, 300) && rig.monitor->getCurrent(VcpCode::SATURATION) == 300,
+           "16-bit value survives the wire");
+    expect(rig.monitor->getBadRequests() == 0, "every request framed and checksummed");
+
+    DdcCi::Stats before = rig.ddc->getStats();
+    expect(!rig.ddc->getVcp(static_cast<VcpCode>(0xDC), value) &&
+           rig.ddc->getStats().commands == before.commands + 1, "unsupported feature, no retry");
+}
+
+void checkRetries() {
+    std::cout << "retries\n";
+    VcpValue value;
+    {
+        Rig rig(noWaits());
+        rig.monitor->busyReplies(1);
+        expect(rig.ddc->getVcp(VcpCode::SATURATION, value) && rig.ddc->getStats().nullReplies == 1 &&
+               rig.ddc->getStats().retries == 1, "null reply, then the value");
+    }
+    {
+        Rig rig(noWaits());
+        rig.monitor->corruptReplies(2);
+        expect(rig.ddc->getVcp(VcpCode::SATURATION, value) && rig.ddc->getStats().checksumErrors == 2,
+               "corrupt replies rejected, then the value");
+    }
+    {
+        Rig rig(noWaits());
+        rig.monitor->nakWrites(1);
+        expect(rig.ddc->setVcp(VcpCode::CONTRAST, 30) && rig.monitor->getCurrent(VcpCode::CONTRAST) == 30,
+               "NAKed set retried");
+    }
+    {
+        Rig rig(noWaits());
+        rig.monitor->busyReplies(100);
+        expect(!rig.ddc->getVcp(VcpCode::SATURATION, value) &&
+               rig.ddc->getStats().commands == static_cast<uint64_t>(DdcTiming().maxTries), "gives up after maxTries");
+    }
+}
+
+void checkPacing() {
+    std::cout << "pacing\n";
+    Rig rig{DdcTiming()};
+    auto start = std::chrono::steady_clock::now();
+    rig.ddc->setVcp(VcpCode::SATURATION, 40);
+    double firstMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    rig.ddc->setVcp(VcpCode::SATURATION, 41);
+    rig.ddc->setVcp(VcpCode::SATURATION, 42);
+    double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    expect(firstMs < 10.0, "idle bus: first set does not wait");
+    expect(totalMs >= 100.0, "back-to-back sets spaced 50 ms apart");
+
+    // The deadline only covers what is left of it
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    start = std::chrono::steady_clock::now();
+    rig.ddc->setVcp(VcpCode::SATURATION, 43);
+    double afterIdleMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    expect(afterIdleMs < 10.0, "set after the interval elapsed does not wait");
+}
+
+void checkCapabilities() {
+    std::cout << "capabilities\n";
+    DdcCapabilities parsed;
+    expect(parseCapabilities(kCapabilities, parsed) && parsed.model == "U2720Q" && parsed.features.size() == 22 &&
+           parsed.features[0x14] == std::vector<uint8_t>({0x05, 0x08, 0x0B, 0x0C}) && parsed.supports(VcpCode::SATURATION),
+           "parse codes and permitted values");
+    expect(parseCapabilities("prot(monitor) vcp(10128A)", parsed) && parsed.features.size() == 3 &&
+           parsed.supports(VcpCode::CONTRAST), "no outer parentheses, no spaces");
+    expect(parseCapabilities("(vcp(14(05 08) 60(0F(01 02) 11) 8A))", parsed) &&
+           parsed.features[0x60] == std::vector<uint8_t>({0x0F, 0x11}) && parsed.supports(VcpCode::SATURATION),
+           "nested MCCS 3 value lists skipped");
+    expect(!parseCapabilities("(prot(monitor)type(lcd))", parsed), "no vcp list");
+
+    Rig rig(noWaits());
+    std::string text;
+    expect(rig.ddc->getCapabilities(text) && text == kCapabilities, "read in 32-byte fragments");
+    std::vector<uint8_t> edid;
+    expect(rig.ddc->readEdid(edid) && isValidEdid(edid), "EDID from 0x50");
+}
+
+void checkCache(const std::string& path) {
+    std::cout << "display cache\n";
+    std::vector<uint8_t> edid = FakeDdcMonitor::makeEdid(1);
+    {
+        Rig rig(noWaits());
+        DdcDisplayCache cache(path);
+        DdcMonitorRecord* record = cache.resolve("/dev/i2c-4", edid, *rig.ddc);
+        expect(record && cache.getDetectionCount() == 1 && record->parsed.supports(VcpCode::SATURATION),
+               "new EDID: probe and capabilities");
+        cache.recordValue(DdcDisplayCache::hashEdid(edid), VcpCode::SATURATION, {60, 100});
+        expect(cache.save(), "saved");
+    }
+    {
+        Rig rig(noWaits());
+        DdcDisplayCache cache(path);
+        DdcMonitorRecord* record = cache.load() ? cache.resolve("/dev/i2c-4", edid, *rig.ddc) : nullptr;
+        expect(record && cache.getDetectionCount() == 0 && rig.ddc->getStats().commands == 0,
+               "known EDID: no DDC/CI traffic");
+        expect(record && record->getValue(VcpCode::SATURATION).current == 60 && record->parsed.model == "U2720Q",
+               "values and capabilities survive reload");
+        expect(cache.getBusEdid("/dev/i2c-4") == DdcDisplayCache::hashEdid(edid), "bus mapped to the monitor");
+
+        cache.resolve("/dev/i2c-4", FakeDdcMonitor::makeEdid(2), *rig.ddc);
+        expect(cache.getDetectionCount() == 1 && cache.getMonitorCount() == 2, "changed EDID: detected again");
+    }
+    {
+        auto fake = std::make_unique<FakeDdcMonitor>();
+        DdcCi silent(std::move(fake), noWaits());
+        DdcDisplayCache cache(path);
+        expect(!cache.resolve("/dev/i2c-7", FakeDdcMonitor::makeEdid(3), silent) && cache.getMonitorCount() == 0,
+               "no DDC/CI answer: not remembered");
+    }
+}
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void checkScheduler() {
+    std::cout << "write scheduler\n";
+    {
+        Rig rig(noWaits());
+        DdcWriteScheduler scheduler(std::chrono::milliseconds(100));
+        scheduler.addMonitor("DDC-DP-1", rig.ddc.get());
+        for (uint16_t value = 1; value <= 100; value++) scheduler.submit("DDC-DP-1", VcpCode::SATURATION, value);
+        scheduler.flush();
+        DdcWriteScheduler::Stats stats = scheduler.getStats("DDC-DP-1");
+        expect(rig.monitor->getCurrent(VcpCode::SATURATION) == 100 && stats.issued <= 3 &&
+               stats.issued + stats.coalesced == 100, "burst coalesced, last value written");
+
+        scheduler.submit("DDC-DP-1", VcpCode::SATURATION, 100);
+        scheduler.flush();
+        expect(scheduler.getStats("DDC-DP-1").issued == stats.issued, "value already on the monitor not rewritten");
+        expect(!scheduler.submit("DDC-DP-9", VcpCode::SATURATION, 10), "unknown monitor refused");
+    }
+    {
+        Rig rig(noWaits());
+        DdcWriteScheduler scheduler(std::chrono::milliseconds(100));
+        scheduler.addMonitor("DDC-DP-1", rig.ddc.get());
+        scheduler.submit("DDC-DP-1", VcpCode::SATURATION, 10);
+        scheduler.flush();
+        auto start = std::chrono::steady_clock::now();
+        scheduler.submit("DDC-DP-1", VcpCode::SATURATION, 20);
+        scheduler.submit("DDC-DP-1", VcpCode::CONTRAST, 20);
+        scheduler.flush();
+        double elapsed = msSince(start);
+        expect(elapsed >= 90.0 && rig.monitor->getCurrent(VcpCode::CONTRAST) == 20,
+               "same code waits the interval, others do not");
+    }
+    {
+        Rig rig(noWaits());
+        DdcWriteScheduler scheduler(std::chrono::seconds(10));
+        scheduler.addMonitor("DDC-DP-1", rig.ddc.get());
+        scheduler.submit("DDC-DP-1", VcpCode::SATURATION, 10);
+        scheduler.flush();
+        auto start = std::chrono::steady_clock::now();
+        scheduler.submit("DDC-DP-1", VcpCode::SATURATION, 70);
+        scheduler.stop();
+        expect(rig.monitor->getCurrent(VcpCode::SATURATION) == 70 && msSince(start) < 1000.0,
+               "stop commits the settled value at once");
+    }
+    {
+        Rig rig(noWaits());
+        DdcWriteScheduler scheduler(std::chrono::milliseconds(0));
+        scheduler.addMonitor("DDC-DP-1", rig.ddc.get());
+        rig.monitor->nakWrites(DdcTiming().maxTries);
+        scheduler.submit("DDC-DP-1", VcpCode::SATURATION, 30);
+        scheduler.flush();
+        scheduler.submit("DDC-DP-1", VcpCode::SATURATION, 30);
+        scheduler.flush();
+        DdcWriteScheduler::Stats stats = scheduler.getStats("DDC-DP-1");
+        expect(stats.failed == 1 && stats.issued == 1 && rig.monitor->getCurrent(VcpCode::SATURATION) == 30,
+               "failed write not taken as settled");
+    }
+}
+
+// Four different codes on each of two buses, with the spec waits
+double msForTwoBuses(bool scheduled) {
+    Rig left{DdcTiming(), "/dev/i2c-4"};
+    Rig right{DdcTiming(), "/dev/i2c-5"};
+    const VcpCode codes[] = {VcpCode::BRIGHTNESS, VcpCode::CONTRAST, VcpCode::COLOR_PRESET, VcpCode::SATURATION};
+
+    auto start = std::chrono::steady_clock::now();
+    if (scheduled) {
+        DdcWriteScheduler scheduler(std::chrono::milliseconds(0));
+        scheduler.addMonitor("DDC-DP-1", left.ddc.get());
+        scheduler.addMonitor("DDC-DP-2", right.ddc.get());
+        for (VcpCode code : codes) {
+            scheduler.submit("DDC-DP-1", code, 7);
+            scheduler.submit("DDC-DP-2", code, 7);
+        }
+        scheduler.flush();
+    } else {
+        // Monitor by monitor, the way a caller applying a profile on one thread would
+        for (VcpCode code : codes) left.ddc->setVcp(code, 7);
+        for (VcpCode code : codes) right.ddc->setVcp(code, 7);
+    }
+    return msSince(start);
+}
+
+// A 1 s drag at 60 Hz with the spec waits; returns Set VCP commands and ms from when
+// the slider reached its last value to the monitor having it
+uint64_t dragWrites(bool scheduled, double& settleMs) {
+    Rig rig{DdcTiming()};
+    DdcWriteScheduler scheduler(DdcWriteScheduler::getConfiguredInterval());
+    scheduler.addMonitor("DDC-DP-1", rig.ddc.get());
+    uint64_t before = rig.ddc->getStats().commands;
+
+    auto next = std::chrono::steady_clock::now();
+    auto last = next;
+    for (uint16_t value = 40; value < 100; value++) {
+        // A direct write blocks past the next frame, so the slider runs ahead of it
+        std::this_thread::sleep_until(next);
+        last = next;
+        next += std::chrono::microseconds(16667);
+        if (scheduled) {
+            scheduler.submit("DDC-DP-1", VcpCode::SATURATION, value);
+        } else {
+            rig.ddc->setVcp(VcpCode::SATURATION, value);
+        }
+    }
+    scheduler.flush();
+    settleMs = msSince(last);
+    expect(rig.monitor->getCurrent(VcpCode::SATURATION) == 99, scheduled ? "drag settles on the last value (scheduler)"
+                                                                        : "drag settles on the last value (direct)");
+    return scheduled ? scheduler.getStats("DDC-DP-1").issued : rig.ddc->getStats().commands - before;
+}
+
+double msToStart(const std::string& path, bool cached) {
+    std::filesystem::remove(path);
+    if (cached) {
+        Rig rig(noWaits());
+        DdcDisplayCache cache(path);
+        cache.resolve("/dev/i2c-4", FakeDdcMonitor::makeEdid(1), *rig.ddc);
+        cache.save();
+    }
+
+    Rig rig{DdcTiming()};
+    auto start = std::chrono::steady_clock::now();
+    DdcDisplayCache cache(path);
+    cache.load();
+    std::vector<uint8_t> edid;
+    rig.ddc->readEdid(edid);
+    cache.resolve("/dev/i2c-4", edid, *rig.ddc);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+double nsPerCommand(bool withWaits, int commands) {
+    Rig rig(withWaits ? DdcTiming() : noWaits());
+    VcpValue value;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < commands; i += 2) {
+        rig.ddc->setVcp(VcpCode::SATURATION, static_cast<uint16_t>(i % 100));
+        rig.ddc->getVcp(VcpCode::SATURATION, value);
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / commands;
+}
+
+} // namespace
+
+int main() {
+    char directory[] = "/tmp/vivid-ddc-XXXXXX";
+    if (!mkdtemp(directory)) return 1;
+    std::string cachePath = std::string(directory) + "/ddc-cache.conf";
+
+    checkProtocol();
+    checkRetries();
+    checkPacing();
+    checkCapabilities();
+    checkCache(cachePath);
+    checkScheduler();
+
+    double directSettleMs = 0.0;
+    double scheduledSettleMs = 0.0;
+    uint64_t directWrites = dragWrites(false, directSettleMs);
+    uint64_t scheduledWrites = dragWrites(true, scheduledSettleMs);
+    double serialMs = msForTwoBuses(false);
+    double parallelMs = msForTwoBuses(true);
+    expect(scheduledWrites * 4 < directWrites, "drag writes cut by the interval");
+    expect(parallelMs < serialMs * 0.75, "buses written in parallel");
+
+    std::cout << "\nper command (set + get pairs)\n" << std::fixed << std::setprecision(1)
+              << "  protocol only            " << nsPerCommand(false, 200000) << " ns\n"
+              << "  with spec waits          " << nsPerCommand(true, 10) / 1e6 << " ms\n";
+    std::cout << "\none monitor, start to known (spec waits)\n"
+              << "  from the cache           " << std::setprecision(3) << msToStart(cachePath, true) << " ms\n"
+              << "  full detection           " << std::setprecision(1) << msToStart(cachePath, false) << " ms\n";
+    std::cout << "\n1 s slider drag at 60 Hz (spec waits, " << DdcWriteScheduler::getConfiguredInterval().count()
+              << " ms interval)\n"
+              << "  direct                   " << directWrites << " writes, settled " << directSettleMs << " ms after release\n"
+              << "  scheduled                " << scheduledWrites << " writes, settled " << scheduledSettleMs
+              << " ms after release\n";
+    std::cout << "\nfour writes on each of two buses (spec waits)\n"
+              << "  monitor by monitor       " << serialMs << " ms\n"
+              << "  one thread per bus       " << parallelMs << " ms\n";
+
+    std::filesystem::remove_all(directory);
+    return g_failed ? 1 : 0;
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include "backends/DdcCi.h"
+#include "backends/I2cDevice.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+// A DDC/CI monitor behind a fake i2c-dev: answers Get VCP and Capabilities, applies Set
+// VCP, serves its EDID at 0x50, and checks every request's framing and checksum the way
+// a real scaler would (a bad request is silently ignored). Faults can be queued to
+// exercise the retry paths.
+class FakeDdcMonitor : public I2cDevice {
+public:
+    explicit FakeDdcMonitor(std::string path = "/dev/i2c-fake") : m_path(std::move(path)) {}
+
+    void setFeature(VcpCode code, uint16_t current, uint16_t maximum) {
+        m_features[static_cast<uint8_t>(code)] = {current, maximum};
+    }
+    void setCapabilities(std::string text) { m_capabilities = std::move(text); }
+    void setEdid(std::vector<uint8_t> edid) { m_edid = std::move(edid); }
+
+    // A valid base block; serial tells monitors of the same model apart
+    static std::vector<uint8_t> makeEdid(uint32_t serial) {
+        std::vector<uint8_t> edid(128, 0);
+        const uint8_t header[] = {0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00};
+        std::copy(header, header + 8, edid.begin());
+        edid[8] = 0x10;  // manufacturer "DEL"
+        edid[9] = 0xAC;
+        std::memcpy(&edid[12], &serial, sizeof(serial));
+        edid[18] = 1;    // EDID 1.4
+        edid[19] = 4;
+        uint8_t sum = 0;
+        for (size_t i = 0; i < 127; i++) sum += edid[i];
+        edid[127] = static_cast<uint8_t>(-sum);
+        return edid;
+    }
+
+    uint16_t getCurrent(VcpCode code) const {
+        auto it = m_features.find(static_cast<uint8_t>(code));
+        return (it != m_features.end()) ? it->second.current : 0;
+    }
+
+    // Each applies to that many of the next transactions
+    void nakWrites(int count) { m_nakWrites = count; }
+    void busyReplies(int count) { m_busyReplies = count; }
+    void corruptReplies(int count) { m_corruptReplies = count; }
+
+    int getWrites() const { return m_writes; }
+    int getBadRequests() const { return m_badRequests; }
+
+    int write(uint8_t address, const uint8_t* data, size_t length) override {
+        if (address == 0x50 && !m_edid.empty() && length == 1) {
+            m_edidOffset = data[0];
+            return 0;
+        }
+        if (address != 0x37) return -ENXIO;
+        if (m_nakWrites > 0) {
+            m_nakWrites--;
+            return -EIO;
+        }
+        m_writes++;
+        m_reply.clear();
+
+        if (length < 3 || data[0] != 0x51 || (data[1] & 0x80) == 0 || (data[1] & 0x7F) + 3u != length ||
+            DdcCi::requestChecksum(data, length - 1) != data[length - 1]) {
+            m_badRequests++;
+            return 0;
+        }
+
+        const uint8_t* payload = data + 2;
+        if (payload[0] == 0x01 && length == 5) {
+            auto it = m_features.find(payload[1]);
+            VcpValue value = (it != m_features.end()) ? it->second : VcpValue();
+            uint8_t result = (it != m_features.end()) ? 0x00 : 0x01;
+            m_reply = {0x6E, 0x88, 0x02, result, payload[1], 0x00,
+                       static_cast<uint8_t>(value.maximum >> 8), static_cast<uint8_t>(value.maximum),
+                       static_cast<uint8_t>(value.current >> 8), static_cast<uint8_t>(value.current)};
+            m_reply.push_back(DdcCi::replyChecksum(m_reply.data(), m_reply.size()));
+        } else if (payload[0] == 0xF3 && length == 6) {
+            size_t offset = static_cast<size_t>((payload[1] << 8) | payload[2]);
+            size_t count = (offset < m_capabilities.size()) ? std::min<size_t>(32, m_capabilities.size() - offset) : 0;
+            m_reply = {0x6E, static_cast<uint8_t>(0x80 | (3 + count)), 0xE3, payload[1], payload[2]};
+            m_reply.insert(m_reply.end(), m_capabilities.begin() + std::min(offset, m_capabilities.size()),
+                           m_capabilities.begin() + std::min(offset + count, m_capabilities.size()));
+            m_reply.push_back(DdcCi::replyChecksum(m_reply.data(), m_reply.size()));
+        } else if (payload[0] == 0x03 && length == 7) {
+            auto it = m_features.find(payload[1]);
+            if (it != m_features.end()) {
+                it->second.current = static_cast<uint16_t>((payload[2] << 8) | payload[3]);
+            }
+        } else {
+            m_badRequests++;
+        }
+        return 0;
+    }
+
+    int read(uint8_t address, uint8_t* data, size_t length) override {
+        if (address == 0x50 && !m_edid.empty()) {
+            std::memset(data, 0, length);
+            for (size_t i = 0; i < length && m_edidOffset + i < m_edid.size(); i++) data[i] = m_edid[m_edidOffset + i];
+            return 0;
+        }
+        if (address != 0x37) return -ENXIO;
+        std::vector<uint8_t> reply = m_reply;
+        if (m_busyReplies > 0) {
+            m_busyReplies--;
+            reply = {0x6E, 0x80, 0xBE};
+        } else if (m_corruptReplies > 0 && !reply.empty()) {
+            m_corruptReplies--;
+            reply.back() ^= 0x01;
+        }
+        if (reply.empty()) return -EIO;
+
+        std::memset(data, 0, length);
+        std::memcpy(data, reply.data(), std::min(length, reply.size()));
+        return 0;
+    }
+
+    const std::string& path() const override { return m_path; }
+
+private:
+    std::string m_path;
+    std::map<uint8_t, VcpValue> m_features;
+    std::string m_capabilities;
+    std::vector<uint8_t> m_edid;
+    size_t m_edidOffset = 0;
+    std::vector<uint8_t> m_reply;
+    int m_nakWrites = 0;
+    int m_busyReplies = 0;
+    int m_corruptReplies = 0;
+    int m_writes = 0;
+    int m_badRequests = 0;
+};
@@ -0,0 +1,155 @@
+#include "ipc/IpcClient.h"
+#include "ipc/IpcServer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Checks the wire format, then measures request round trips against an in-process
+// server whose handler does no display work, so the numbers are the IPC cost alone.
+
+namespace {
+
+bool check(bool condition, const char* what) {
+    if (!condition) std::cerr << "FAIL: " << what << "\n";
+    return condition;
+}
+
+bool verifyProtocol() {
+    bool ok = true;
+
+    IpcRequest request;
+    request.opcode = IpcOpcode::SET;
+    request.value = -42;
+    request.durationMs = 150;
+    request.output = "HDMI-A-1";
+
+    std::vector<uint8_t> frame;
+    encodeRequest(request, frame);
+    long payload = completeFrame(frame.data(), frame.size());
+    ok &= check(payload == static_cast<long>(frame.size() - kIpcFrameHeader), "request frame length");
+    ok &= check(completeFrame(frame.data(), frame.size() - 1) == 0, "partial frame waits");
+
+    IpcRequest decoded;
+    ok &= check(decodeRequest(frame.data() + kIpcFrameHeader, payload, decoded), "request decodes");
+    ok &= check(decoded.opcode == request.opcode && decoded.value == -42 &&
+                decoded.durationMs == 150 && decoded.output == "HDMI-A-1", "request round trip");
+
+    frame[kIpcFrameHeader] = 99;
+    ok &= check(!decodeRequest(frame.data() + kIpcFrameHeader, payload, decoded), "unknown opcode rejected");
+
+    IpcResponse response;
+    response.value = 7;
+    response.outputs = {{"eDP-1", 20}, {"DP-2", -5}};
+    frame.clear();
+    encodeResponse(response, frame);
+    IpcResponse decodedResponse;
+    payload = completeFrame(frame.data(), frame.size());
+    ok &= check(payload > 0 && decodeResponse(frame.data() + kIpcFrameHeader, payload, decodedResponse),
+                "response decodes");
+    ok &= check(decodedResponse.outputs.size() == 2 && decodedResponse.outputs[1].output == "DP-2" &&
+                decodedResponse.outputs[1].vibrance == -5, "response round trip");
+
+    IpcRequest save;
+    save.opcode = IpcOpcode::PROFILE_SAVE;
+    save.profile.name = "game";
+    save.profile.executable = "wine64";
+    save.profile.displayVibrance = {{"DP-1", 60.0f}, {"eDP-1", -12.5f}};
+    frame.clear();
+    encodeRequest(save, frame);
+    payload = completeFrame(frame.data(), frame.size());
+    ok &= check(payload > 0 && decodeRequest(frame.data() + kIpcFrameHeader, payload, decoded) &&
+                decoded.profile.name == "game" && decoded.profile.enabled &&
+                decoded.profile.displayVibrance.at("eDP-1") == -12.5f, "profile round trip");
+
+    uint8_t oversized[] = {0xFF, 0xFF, 0xFF, 0x7F};
+    ok &= check(completeFrame(oversized, sizeof(oversized)) < 0, "oversized frame rejected");
+    return ok;
+}
+
+IpcResponse echo(const IpcRequest& request) {
+    IpcResponse response;
+    response.value = request.value;
+    return response;
+}
+
+void reportLatency(const std::string& socketPath) {
+    IpcClient client;
+    if (!client.connect(socketPath)) return;
+
+    const int iterations = 20000;
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    for (int i = 0; i < iterations; i++) {
+        auto start = std::chrono::steady_clock::now();
+        client.setVibrance("HDMI-A-1", i % 201 - 100);
+        samples.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+
+    std::cout << "  round trip (SET): p50 " << samples[iterations / 2] << " us, p99 "
+              << samples[iterations * 99 / 100] << " us, max " << samples.back() << " us\n";
+}
+
+void reportThroughput(const std::string& socketPath, int clients) {
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> completed{0};
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < clients; i++) {
+        threads.emplace_back([&]() {
+            IpcClient client;
+            if (!client.connect(socketPath)) return;
+            while (running.load(std::memory_order_relaxed)) {
+                if (client.ping()) completed++;
+            }
+        });
+    }
+
+    auto duration = std::chrono::seconds(1);
+    std::this_thread::sleep_for(duration);
+    running = false;
+    for (auto& thread : threads) thread.join();
+
+    std::cout << "  " << clients << " client(s): " << completed.load() / std::chrono::duration<double>(duration).count()
+              << " requests/s\n";
+}
+
+} // namespace
+
+int main() {
+    std::cout << "Daemon IPC benchmark\n\n";
+
+    if (!verifyProtocol()) {
+        return 1;
+    }
+    std::cout << "Verification: OK\n\n";
+
+    std::string socketPath = "/tmp/vivid-ipc-bench-" + std::to_string(getpid()) + ".sock";
+    IpcServer server(echo);
+    if (!server.listen(socketPath) || !server.start()) {
+        std::cerr << "Cannot listen on " << socketPath << "\n";
+        return 1;
+    }
+
+    IpcServer second(echo);
+    if (!check(!second.listen(socketPath), "second instance refused")) {
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    reportLatency(socketPath);
+    for (int clients : {1, 4}) {
+        reportThroughput(socketPath, clients);
+    }
+    server.stop();
+
+    std::string lockPath = socketPath + ".lock";
+    unlink(lockPath.c_str());
+    return 0;
+}
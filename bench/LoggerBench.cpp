@@ -0,0 +1,58 @@
+#include "core/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Cost at the call site of one typical slider-path message: disabled, enabled into the
+// ring (drained between batches so nothing is dropped), and the std::endl-flushed ostream
+// write it replaces. Run with stderr redirected, e.g. 2>/dev/null.
+
+namespace {
+
+const int kBatch = 256;  // fits the ring with room to spare
+const int kBatches = 400;
+
+template <typename Log>
+double nsPerMessage(Log log, bool flushBetween) {
+    std::vector<double> samples;
+    for (int batch = 0; batch < kBatches; batch++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kBatch; i++) log(batch * kBatch + i);
+        samples.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kBatch);
+        if (flushBetween) Logger::flush();
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+} // namespace
+
+int main() {
+    const std::string display = "DP-1";
+    auto message = [&](int i) {
+        LOG_DEBUG << "Setting " << display << " vibrance to " << (i % 200 - 100) * 0.5f;
+    };
+
+    Logger::setThreshold(LogLevel::INFO);
+    double disabled = nsPerMessage(message, false);
+
+    Logger::setThreshold(LogLevel::DEBUG);
+    uint64_t droppedBefore = Logger::getDroppedCount();
+    double enabled = nsPerMessage(message, true);
+    uint64_t dropped = Logger::getDroppedCount() - droppedBefore;
+
+    std::ofstream sink("/dev/null");
+    double ostream = nsPerMessage([&](int i) {
+        sink << "Setting " << display << " vibrance to " << (i % 200 - 100) * 0.5f << std::endl;
+    }, false);
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "disabled level     " << disabled << " ns\n"
+              << "enabled, ring      " << enabled << " ns (" << dropped << " dropped)\n"
+              << "ostream + endl     " << ostream << " ns\n";
+    return dropped == 0 ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+#include "core/Metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Checks histogram percentiles against exact ones and that per-thread shards lose no
+// counts, then compares the cost of one latency record against a mutex-guarded map.
+
+namespace {
+
+const char* const kDisplays[] = {"DP-1", "DP-2", "HDMI-A-1"};
+
+uint64_t exactPercentile(std::vector<uint64_t> values, double percentile) {
+    std::sort(values.begin(), values.end());
+    size_t rank = static_cast<size_t>(percentile / 100.0 * values.size() + 0.5);
+    rank = std::max<size_t>(1, std::min(rank, values.size()));
+    return values[rank - 1];
+}
+
+bool checkBuckets() {
+    // Every value must land in a bucket whose high edge is within 1/32 above it
+    for (uint64_t value = 0; value < (uint64_t(1) << 36); value = value * 5 / 4 + 1) {
+        uint64_t high = LatencyHistogram::bucketHigh(LatencyHistogram::bucketOf(value));
+        if (high < value || high - value > value / 32) {
+            std::cerr << "bucket for " << value << " ends at " << high << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkAccuracy() {
+    // Log-normal around 80 us with a long tail, roughly what an X gamma upload looks like
+    std::mt19937_64 rng(7);
+    std::lognormal_distribution<double> latency(std::log(80000.0), 0.8);
+    std::vector<uint64_t> values;
+    for (int i = 0; i < 200000; i++) {
+        uint64_t ns = static_cast<uint64_t>(latency(rng));
+        values.push_back(ns);
+        Metrics::recordLatency("check", "accuracy", std::chrono::nanoseconds(ns));
+    }
+
+    MetricsReport report = Metrics::collect();
+    for (const auto& summary : report.latencies) {
+        if (summary.series != "check") continue;
+
+        bool ok = summary.count == values.size() && summary.maxNs == *std::max_element(values.begin(), values.end());
+        for (auto pair : {std::make_pair(50.0, summary.p50Ns), std::make_pair(99.0, summary.p99Ns)}) {
+            uint64_t exact = exactPercentile(values, pair.first);
+            double error = std::fabs(static_cast<double>(pair.second) - exact) / exact;
+            std::cout << "p" << pair.first << ": " << pair.second << " ns, exact " << exact
+                      << " ns, error " << std::setprecision(2) << error * 100 << "%\n";
+            ok = ok && error < 1.0 / 32;
+        }
+        return ok;
+    }
+    return false;
+}
+
+bool checkThreads(int threads) {
+    const uint64_t perThread = 100000;
+    uint64_t before = Metrics::collect().counters[static_cast<int>(Counter::SLIDER_COALESCED)];
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; i++) {
+        workers.emplace_back([perThread]() {
+            for (uint64_t n = 0; n < perThread; n++) Metrics::count(Counter::SLIDER_COALESCED);
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    uint64_t after = Metrics::collect().counters[static_cast<int>(Counter::SLIDER_COALESCED)];
+    bool ok = after - before == perThread * threads;
+    std::cout << "counts from " << threads << " exited threads: " << (ok ? "ok" : "LOST") << "\n";
+    return ok;
+}
+
+template <typename Record>
+double nsPerRecord(int threads, Record record) {
+    const int perThread = 1000000;
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < threads; i++) {
+        workers.emplace_back([&record, perThread]() {
+            for (int n = 0; n < perThread; n++) {
+                record(kDisplays[n % 3], std::chrono::nanoseconds(50000 + n % 4096));
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / perThread;  // wall time per record on each thread
+}
+
+} // namespace
+
+int main() {
+    bool ok = checkBuckets() && checkAccuracy() && checkThreads(8);
+    if (!ok) {
+        std::cerr << "FAILED\n";
+        return 1;
+    }
+
+    std::mutex mutex;
+    std::map<std::string, std::vector<uint64_t>> guarded;
+    auto locked = [&](const char* display, std::chrono::nanoseconds elapsed) {
+        std::lock_guard<std::mutex> lock(mutex);
+        guarded[display].push_back(elapsed.count());
+    };
+    auto sharded = [](const char* display, std::chrono::nanoseconds elapsed) {
+        Metrics::recordLatency("apply.native", display, elapsed);
+    };
+
+    int cores = std::max(2u, std::thread::hardware_concurrency());
+    std::cout << "\nns per record\n";
+    std::cout << std::left << std::setw(10) << "threads" << std::setw(12) << "sharded" << "mutex+map\n";
+    for (int threads = 1; threads <= cores; threads *= 2) {
+        double fast = nsPerRecord(threads, sharded);
+        double slow = nsPerRecord(threads, locked);
+        guarded.clear();
+        std::cout << std::left << std::fixed << std::setprecision(1) << std::setw(10) << threads
+                  << std::setw(12) << fast << slow << "\n";
+    }
+    return 0;
+}
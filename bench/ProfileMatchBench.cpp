@@ -0,0 +1,176 @@
+#include "core/ProfileMatcher.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Checks the compiled matcher against a linear scan over synthetic profile packs, then
+// reports per-focus-change match latency percentiles for each pack size.
+
+namespace {
+
+const int kPackSizes[] = {100, 1000, 10000};
+
+std::vector<AppProfile> makePack(int count) {
+    std::vector<AppProfile> profiles;
+    for (int i = 0; i < count; i++) {
+        AppProfile profile;
+        profile.name = "profile-" + std::to_string(i);
+        profile.enabled = (i % 17) != 0;
+        profile.pathMatching = false;
+
+        switch (i % 3) {
+            case 0:
+                profile.executable = (i % 2) ? "game" + std::to_string(i) + ".exe" : "steam:" + std::to_string(i);
+                break;
+            case 1:
+                profile.executable = "/opt/games/studio" + std::to_string(i % 50) + "/title" + std::to_string(i);
+                profile.pathMatching = true;
+                break;
+            case 2:
+                profile.windowTitle = "Title " + std::to_string(i) + " -";
+                break;
+        }
+        profiles.push_back(profile);
+    }
+    return profiles;
+}
+
+std::vector<MatchQuery> makeQueries(int count, std::mt19937& rng) {
+    std::uniform_int_distribution<int> pick(0, count * 2);
+    std::vector<MatchQuery> queries;
+    for (int i = 0; i < 5000; i++) {
+        int id = pick(rng);  // half of these name no profile
+        MatchQuery query;
+        switch (i % 4) {
+            case 0:
+                query.executable = "/home/user/.wine/drive_c/game" + std::to_string(id) + ".exe";
+                break;
+            case 1:
+                query.executable = "/opt/games/studio" + std::to_string(id % 50) + "/title" + std::to_string(id) + "/bin/run";
+                break;
+            case 2:
+                query.executable = "/usr/bin/editor";
+                query.title = "Welcome - Title " + std::to_string(id) + " - Launcher v2";
+                break;
+            case 3:
+                query.appId = "steam:" + std::to_string(id);
+                query.executable = "firefox";
+                query.title = "Some page about nothing in particular - Mozilla Firefox";
+                break;
+        }
+        queries.push_back(query);
+    }
+    return queries;
+}
+
+std::string basenameOf(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return (slash == std::string::npos) ? path : path.substr(slash + 1);
+}
+
+bool isPathPrefix(const std::string& prefix, const std::string& path) {
+    if (path.compare(0, prefix.size(), prefix) != 0) return false;
+    return path.size() == prefix.size() || path[prefix.size()] == '/' || prefix.back() == '/';
+}
+
+// What every focus change would cost without the index
+int linearMatch(const std::vector<AppProfile>& profiles, const MatchQuery& query) {
+    int bestPath = ProfileMatcher::kNoMatch;
+    size_t bestPathLength = 0;
+    int firstTitle = ProfileMatcher::kNoMatch;
+
+    std::vector<std::string> keys;
+    if (!query.appId.empty()) keys.push_back(query.appId);
+    if (!query.executable.empty()) {
+        keys.push_back(query.executable);
+        keys.push_back(basenameOf(query.executable));
+    }
+    for (const std::string& key : keys) {
+        for (size_t i = 0; i < profiles.size(); i++) {
+            const AppProfile& profile = profiles[i];
+            if (!profile.enabled || profile.executable.empty() || profile.pathMatching) continue;
+            if (profile.executable == key || basenameOf(profile.executable) == key) {
+                return static_cast<int>(i);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < profiles.size(); i++) {
+        const AppProfile& profile = profiles[i];
+        if (!profile.enabled) continue;
+        if (profile.pathMatching && !profile.executable.empty() && !query.executable.empty() &&
+            query.executable[0] == '/' && isPathPrefix(profile.executable, query.executable) &&
+            profile.executable.size() > bestPathLength) {
+            bestPath = static_cast<int>(i);
+            bestPathLength = profile.executable.size();
+        }
+        if (firstTitle == ProfileMatcher::kNoMatch && !profile.windowTitle.empty() &&
+            query.title.find(profile.windowTitle) != std::string::npos) {
+            firstTitle = static_cast<int>(i);
+        }
+    }
+    return (bestPath != ProfileMatcher::kNoMatch) ? bestPath : firstTitle;
+}
+
+double percentile(std::vector<double>& samples, double p) {
+    size_t index = std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+} // namespace
+
+int main() {
+    std::cout << "Profile matching benchmark\n\n";
+    std::mt19937 rng(42);
+
+    std::cout << std::left << std::setw(10) << "profiles" << std::setw(12) << "build ms"
+              << std::setw(10) << "p50 ns" << std::setw(10) << "p99 ns" << std::setw(12) << "max ns"
+              << "linear p50 ns\n";
+
+    for (int count : kPackSizes) {
+        std::vector<AppProfile> profiles = makePack(count);
+        std::vector<MatchQuery> queries = makeQueries(count, rng);
+
+        ProfileMatcher matcher;
+        auto buildStart = std::chrono::steady_clock::now();
+        matcher.build(profiles);
+        double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+
+        std::vector<double> samples;
+        std::vector<double> linearSamples;
+        int hits = 0;
+        for (const auto& query : queries) {
+            auto start = std::chrono::steady_clock::now();
+            int found = matcher.match(query);
+            auto middle = std::chrono::steady_clock::now();
+            int expected = linearMatch(profiles, query);
+            auto end = std::chrono::steady_clock::now();
+
+            if (found != expected) {
+                std::cerr << "Mismatch for " << query.executable << " / \"" << query.title << "\": "
+                          << found << " vs linear " << expected << "\n";
+                return 1;
+            }
+            hits += (found != ProfileMatcher::kNoMatch);
+            samples.push_back(std::chrono::duration<double, std::nano>(middle - start).count());
+            linearSamples.push_back(std::chrono::duration<double, std::nano>(end - middle).count());
+        }
+
+        if (matcher.findByName("profile-" + std::to_string(count - 1)) != count - 1) {
+            std::cerr << "Name lookup failed\n";
+            return 1;
+        }
+
+        std::cout << std::left << std::setw(10) << count << std::fixed << std::setprecision(2)
+                  << std::setw(12) << buildMs << std::setprecision(0)
+                  << std::setw(10) << percentile(samples, 0.50) << std::setw(10) << percentile(samples, 0.99)
+                  << std::setw(12) << percentile(samples, 1.0) << percentile(linearSamples, 0.50)
+                  << "   (" << hits << "/" << queries.size() << " matched)\n";
+    }
+    return 0;
+}
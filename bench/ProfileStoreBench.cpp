@@ -0,0 +1,196 @@
+#include "core/ProfileStore.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Round-trips 10k profiles through the store, then compares snapshot load time with
+// replaying the same edits from the journal and with a line-per-field text format, and
+// times the incremental refresh a live reload does after another writer's save.
+
+namespace {
+
+const int kProfileCount = 10000;
+const int kRuns = 20;
+
+std::vector<AppProfile> makeProfiles(int count) {
+    std::vector<AppProfile> profiles;
+    for (int i = 0; i < count; i++) {
+        AppProfile profile;
+        profile.name = "profile-" + std::to_string(i);
+        profile.executable = "/opt/games/studio" + std::to_string(i % 50) + "/title" + std::to_string(i);
+        profile.windowTitle = (i % 3 == 0) ? "Title " + std::to_string(i) : "";
+        profile.pathMatching = (i % 2) == 0;
+        profile.enabled = (i % 17) != 0;
+        profile.displayVibrance["DP-1"] = static_cast<float>(i % 100);
+        if (i % 4 == 0) profile.displayVibrance["HDMI-A-1"] = -static_cast<float>(i % 50);
+        profiles.push_back(profile);
+    }
+    return profiles;
+}
+
+bool sameProfiles(const std::vector<AppProfile>& a, const std::vector<AppProfile>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].name != b[i].name || a[i].executable != b[i].executable ||
+            a[i].windowTitle != b[i].windowTitle || a[i].pathMatching != b[i].pathMatching ||
+            a[i].enabled != b[i].enabled || a[i].displayVibrance != b[i].displayVibrance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// What a conventional key=value config would cost to parse
+void writeText(const std::string& path, const std::vector<AppProfile>& profiles) {
+    std::ofstream file(path);
+    for (const auto& profile : profiles) {
+        file << "[" << profile.name << "]\n"
+             << "executable=" << profile.executable << "\n"
+             << "title=" << profile.windowTitle << "\n"
+             << "path_matching=" << profile.pathMatching << "\n"
+             << "enabled=" << profile.enabled << "\n";
+        for (const auto& pair : profile.displayVibrance) {
+            file << "vibrance." << pair.first << "=" << pair.second << "\n";
+        }
+    }
+}
+
+void readText(const std::string& path, std::vector<AppProfile>& profiles) {
+    profiles.clear();
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+        if (line[0] == '[') {
+            profiles.emplace_back();
+            profiles.back().name = line.substr(1, line.size() - 2);
+            continue;
+        }
+        size_t equals = line.find('=');
+        std::string key = line.substr(0, equals);
+        std::string value = line.substr(equals + 1);
+        AppProfile& profile = profiles.back();
+        if (key == "executable") profile.executable = value;
+        else if (key == "title") profile.windowTitle = value;
+        else if (key == "path_matching") profile.pathMatching = value == "1";
+        else if (key == "enabled") profile.enabled = value == "1";
+        else if (key.rfind("vibrance.", 0) == 0) profile.displayVibrance[key.substr(9)] = std::stof(value);
+    }
+}
+
+template <typename Load>
+double medianMs(Load load) {
+    std::vector<double> samples;
+    for (int run = 0; run < kRuns; run++) {
+        auto start = std::chrono::steady_clock::now();
+        load();
+        samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::nth_element(samples.begin(), samples.begin() + kRuns / 2, samples.end());
+    return samples[kRuns / 2];
+}
+
+} // namespace
+
+int main() {
+    std::cout << "Profile store benchmark (" << kProfileCount << " profiles)\n\n";
+
+    std::string directory = (std::filesystem::temp_directory_path() /
+                             ("vivid-store-bench-" + std::to_string(getpid()))).string();
+    std::filesystem::remove_all(directory);
+    std::vector<AppProfile> profiles = makeProfiles(kProfileCount);
+    std::vector<AppProfile> loaded;
+    int status = 0;
+
+    {
+        // Every profile saved one at a time: the journal path
+        ProfileStore store(directory);
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& profile : profiles) store.put(profile);
+        double putUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        size_t journalBytes = store.getJournalBytes();
+
+        ProfileStore replay(directory);
+        double replayMs = medianMs([&] { replay.load(loaded); });
+        if (!sameProfiles(profiles, loaded)) {
+            std::cerr << "Journal replay did not round-trip\n";
+            status = 1;
+        }
+
+        auto compactStart = std::chrono::steady_clock::now();
+        store.compact(profiles);
+        double compactMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compactStart).count();
+
+        ProfileStore snapshot(directory);
+        double snapshotMs = medianMs([&] { snapshot.load(loaded); });
+        if (!sameProfiles(profiles, loaded) || snapshot.getJournalBytes() != 0) {
+            std::cerr << "Snapshot did not round-trip\n";
+            status = 1;
+        }
+
+        // An edit and a delete on top of the snapshot
+        AppProfile edited = profiles[10];
+        edited.displayVibrance["DP-1"] = 42.0f;
+        store.put(edited);
+        store.remove(profiles[20].name);
+        std::vector<AppProfile> expected = profiles;
+        expected[10] = edited;
+        expected.erase(expected.begin() + 20);
+        ProfileStore layered(directory);
+        if (!layered.load(loaded) || !sameProfiles(expected, loaded)) {
+            std::cerr << "Snapshot plus journal did not round-trip\n";
+            status = 1;
+        }
+
+        // A torn append must cost only the record it tore
+        {
+            std::ofstream journal(store.getJournalPath(), std::ios::app | std::ios::binary);
+            const char tail[] = "\x40\x00\x00\x00partial";
+            journal.write(tail, sizeof(tail) - 1);
+        }
+        ProfileStore torn(directory);
+        if (!torn.load(loaded) || !sameProfiles(expected, loaded)) {
+            std::cerr << "Torn journal tail was not dropped\n";
+            status = 1;
+        }
+
+        // Live reload: another writer saves one profile, the watcher-side store catches up
+        edited.windowTitle = "Edited elsewhere";
+        store.put(edited);
+        expected[10] = edited;
+        auto refreshStart = std::chrono::steady_clock::now();
+        ProfileStore::Refresh refreshed = torn.refresh(loaded);
+        double refreshUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - refreshStart).count();
+        if (refreshed != ProfileStore::Refresh::INCREMENTAL || torn.getLastRecordCount() != 1 ||
+            !sameProfiles(expected, loaded)) {
+            std::cerr << "Incremental refresh did not pick up the external save\n";
+            status = 1;
+        }
+
+        std::string textPath = directory + "/profiles.txt";
+        writeText(textPath, profiles);
+        double textMs = medianMs([&] { readText(textPath, loaded); });
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << "put (journal append + fdatasync): " << putUs / kProfileCount << " us/profile, "
+                  << journalBytes / 1024 << " KiB journal\n"
+                  << "compact:                          " << compactMs << " ms, "
+                  << snapshot.getSnapshotBytes() / 1024 << " KiB snapshot\n\n"
+                  << "load, median of " << kRuns << ":\n"
+                  << "  mmapped snapshot   " << snapshotMs << " ms\n"
+                  << "  journal replay     " << replayMs << " ms\n"
+                  << "  text key=value     " << textMs << " ms\n"
+                  << "refresh after one external save: " << refreshUs << " us\n";
+    }
+
+    std::filesystem::remove_all(directory);
+    return status;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "backends/GammaBackend.h"
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Headless GammaBackend: accepts every upload for a fixed set of outputs and keeps the
+// last ramp per output, so apply paths can be timed and checked without a display.
+class RecordingBackend : public GammaBackend {
+public:
+    explicit RecordingBackend(std::vector<std::string> outputs, int gammaSize = 1024)
+        : m_outputs(std::move(outputs)), m_gammaSize(gammaSize) {}
+
+    const char* name() const override { return "recording"; }
+    bool isAvailable() const override { return true; }
+    bool refresh() override { return true; }
+    std::vector<std::string> getOutputs() const override { return m_outputs; }
+    int getGammaSize(const std::string& output) const override { return known(output) ? m_gammaSize : 0; }
+    double getRefreshRate(const std::string& output) const override { return known(output) ? 60.0 : 0.0; }
+
+    bool applyGamma(const std::vector<GammaTarget>& targets) override {
+        for (const auto& target : targets) {
+            if (!known(target.output)) return false;
+        }
+        m_uploads += targets.size();
+        m_flushes++;
+        return true;
+    }
+
+    bool applyRamps(const std::vector<RampTarget>& targets) override {
+        for (const auto& target : targets) {
+            if (!known(target.output) || !target.ramp || target.ramp->size() != m_gammaSize) return false;
+        }
+        for (const auto& target : targets) {
+            m_lastRamps[target.output] = target.ramp;
+        }
+        m_uploads += targets.size();
+        m_flushes++;
+        return true;
+    }
+
+    bool resetAll() override {
+        m_lastRamps.clear();
+        m_flushes++;
+        return true;
+    }
+
+    uint64_t getUploads() const { return m_uploads.load(); }
+    uint64_t getFlushes() const { return m_flushes.load(); }
+    std::shared_ptr<const GammaRamp> getLastRamp(const std::string& output) const {
+        auto it = m_lastRamps.find(output);
+        return (it != m_lastRamps.end()) ? it->second : nullptr;
+    }
+
+private:
+    std::vector<std::string> m_outputs;
+    int m_gammaSize;
+    std::map<std::string, std::shared_ptr<const GammaRamp>> m_lastRamps;
+    std::atomic<uint64_t> m_uploads{0};
+    std::atomic<uint64_t> m_flushes{0};
+
+    bool known(const std::string& output) const {
+        for (const auto& name : m_outputs) {
+            if (name == output) return true;
+        }
+        return false;
+    }
+};
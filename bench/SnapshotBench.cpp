@@ -0,0 +1,185 @@
+#include "core/SnapshotCell.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Stress-checks SnapshotCell (torn versions, reordering, leaks), then compares reader
+// throughput against the mutex-guarded vector copy that getDisplays() used to return.
+// With --stress only the check runs; test-snapshot-tsan.sh runs it under ThreadSanitizer.
+
+namespace {
+
+std::atomic<int64_t> g_liveStates{0};
+std::atomic<size_t> g_sink{0};  // keeps the timed reads from being optimised out
+
+// Every field equals version, so a torn or half-built version is detectable
+struct State {
+    uint64_t version = 0;
+    std::vector<uint64_t> values;
+    std::vector<std::string> names;
+
+    explicit State(uint64_t v = 0) : version(v), values(8, v), names(4, std::to_string(v)) { g_liveStates++; }
+    State(const State& other) : version(other.version), values(other.values), names(other.names) { g_liveStates++; }
+    State& operator=(const State&) = default;
+    ~State() { g_liveStates--; }
+
+    bool consistent() const {
+        std::string name = std::to_string(version);
+        return std::all_of(values.begin(), values.end(), [&](uint64_t v) { return v == version; }) &&
+               std::all_of(names.begin(), names.end(), [&](const std::string& n) { return n == name; });
+    }
+};
+
+bool stress(int readers, int writers, std::chrono::milliseconds duration) {
+    std::atomic<bool> failed{false};
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> writes{0};
+
+    {
+        SnapshotCell<State> cell;
+        std::vector<std::thread> threads;
+
+        for (int i = 0; i < writers; i++) {
+            threads.emplace_back([&, i]() {
+                uint64_t count = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    if ((count++ + i) % 2 == 0) {
+                        cell.update([](State& state) {
+                            state.version++;
+                            std::fill(state.values.begin(), state.values.end(), state.version);
+                            std::fill(state.names.begin(), state.names.end(), std::to_string(state.version));
+                        });
+                    } else {
+                        uint64_t next = cell.load()->version + 1;
+                        cell.update([next](State& state) {
+                            state = State(std::max(next, state.version + 1));
+                        });
+                    }
+                    writes++;
+                }
+            });
+        }
+
+        for (int i = 0; i < readers; i++) {
+            threads.emplace_back([&]() {
+                uint64_t last = 0;
+                uint64_t count = 0;
+                std::vector<SnapshotCell<State>::Snapshot> held;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    auto snapshot = cell.load();
+                    if (!snapshot->consistent() || snapshot->version < last) {
+                        failed = true;
+                    }
+                    last = snapshot->version;
+
+                    // Keep a few old versions alive across publishes, then drop them
+                    if (++count % 64 == 0) held.push_back(snapshot);
+                    if (held.size() > 16) held.clear();
+                }
+                reads += count;
+            });
+        }
+
+        std::this_thread::sleep_for(duration);
+        stop = true;
+        for (auto& thread : threads) thread.join();
+
+        if (g_liveStates.load() != 1) {
+            std::cerr << "Leaked or double-freed versions: " << g_liveStates.load() << " live, expected 1\n";
+            failed = true;
+        }
+    }
+
+    if (g_liveStates.load() != 0) {
+        std::cerr << "Cell did not free its last version\n";
+        failed = true;
+    }
+
+    std::cout << "stress: " << readers << " readers, " << writers << " writers, "
+              << reads.load() << " reads, " << writes.load() << " publishes: "
+              << (failed ? "FAILED" : "ok") << "\n";
+    return !failed;
+}
+
+struct Display {
+    std::string id;
+    std::string name;
+    int currentVibrance = 0;
+    bool connected = true;
+};
+
+std::vector<Display> makeDisplays() {
+    std::vector<Display> displays;
+    for (const char* id : {"DP-1", "DP-2", "HDMI-A-1"}) {
+        displays.push_back({id, std::string(id) + " (Dell U2720Q)", 0, true});
+    }
+    return displays;
+}
+
+template <typename Read>
+double readsPerSecond(int threads, Read read) {
+    const auto duration = std::chrono::milliseconds(300);
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> total{0};
+    std::vector<std::thread> workers;
+
+    for (int i = 0; i < threads; i++) {
+        workers.emplace_back([&]() {
+            uint64_t count = 0;
+            size_t sink = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                sink += read();
+                count++;
+            }
+            total += count;
+            g_sink += sink;
+        });
+    }
+    std::this_thread::sleep_for(duration);
+    stop = true;
+    for (auto& worker : workers) worker.join();
+    return total.load() / std::chrono::duration<double>(duration).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool stressOnly = argc > 1 && std::strcmp(argv[1], "--stress") == 0;
+    int cores = std::max(2u, std::thread::hardware_concurrency());
+
+    bool ok = stress(cores, 2, std::chrono::milliseconds(stressOnly ? 2000 : 500)) &&
+              stress(1, 1, std::chrono::milliseconds(200));
+    if (stressOnly || !ok) return ok ? 0 : 1;
+
+    std::cout << "\nReader throughput, Mreads/s (3 displays)\n";
+    std::cout << std::left << std::setw(10) << "threads" << std::setw(16) << "snapshot"
+              << std::setw(16) << "mutex+copy" << "atomic shared_ptr\n";
+
+    SnapshotCell<std::vector<Display>> cell(makeDisplays());
+    std::mutex mutex;
+    std::vector<Display> guarded = makeDisplays();
+    std::shared_ptr<const std::vector<Display>> shared = std::make_shared<const std::vector<Display>>(makeDisplays());
+
+    for (int threads = 1; threads <= cores; threads *= 2) {
+        double snapshot = readsPerSecond(threads, [&]() { return cell.load()->size(); });
+        double copy = readsPerSecond(threads, [&]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::vector<Display> displays = guarded;
+            return displays.size();
+        });
+        double atomicShared = readsPerSecond(threads, [&]() { return std::atomic_load(&shared)->size(); });
+
+        std::cout << std::left << std::fixed << std::setprecision(2) << std::setw(10) << threads
+                  << std::setw(16) << snapshot / 1e6 << std::setw(16) << copy / 1e6 << atomicShared / 1e6 << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,452 @@
+#include "RecordingBackend.h"
+#include "core/GammaRampCache.h"
+#include "core/ProfileMatcher.h"
+#include "core/ProfileStore.h"
+#include "core/RampKernel.h"
+#include "core/SnapshotCell.h"
+#include "core/VibranceController.h"
+#include "core/XrandrQuery.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#ifndef VIVID_VERSION
+#define VIVID_VERSION "unknown"
+#endif
+
+// Repeatable microbenchmarks for the hot paths, headless: the apply cases drive a real
+// VibranceController against RecordingBackend. Results go to stdout as JSON for
+// regression tracking across releases.
+//
+// Usage: vivid-bench [--filter <substring>] [--repetitions <n>] [--min-batch-ms <ms>] [--text]
+//
+// Each case runs in batches sized so one batch takes at least --min-batch-ms; every
+// repetition is one batch, and the reported ns per op are taken across repetitions.
+
+namespace {
+
+using Batch = std::function<void(uint64_t iterations)>;
+
+struct Case {
+    std::string name;
+    std::function<Batch()> setup;  // runs only when the case is selected
+};
+
+struct Result {
+    std::string name;
+    uint64_t batch = 0;
+    std::vector<double> nsPerOp;  // one per repetition
+};
+
+struct Options {
+    std::string filter;
+    int repetitions = 10;
+    double minBatchMs = 5.0;
+    bool text = false;
+};
+
+std::atomic<uint64_t> g_sink{0};  // keeps results of timed work alive
+std::string g_workDirectory;
+
+const char* const kOutputs[] = {"DP-1", "DP-2", "HDMI-A-1"};
+
+double batchMs(const Batch& batch, uint64_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    batch(iterations);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+Result measure(const std::string& name, const Batch& batch, const Options& options) {
+    Result result;
+    result.name = name;
+
+    // Grow the batch until it is long enough to time; this doubles as the warm-up
+    uint64_t iterations = 1;
+    while (batchMs(batch, iterations) < options.minBatchMs && iterations < (uint64_t(1) << 32)) {
+        iterations *= 2;
+    }
+    result.batch = iterations;
+
+    for (int i = 0; i < options.repetitions; i++) {
+        result.nsPerOp.push_back(batchMs(batch, iterations) * 1e6 / iterations);
+    }
+    return result;
+}
+
+// Roughly what `xrandr --query` prints on a three-monitor desk with two empty ports
+std::string makeQueryOutput() {
+    std::ostringstream out;
+    out << "Screen 0: minimum 320 x 200, current 6400 x 1440, maximum 16384 x 16384\n";
+    const char* ports[] = {"DP-1", "DP-2", "DP-3", "HDMI-A-1", "HDMI-A-2"};
+    for (int port = 0; port < 5; port++) {
+        bool connected = port != 2 && port != 4;
+        out << ports[port] << (connected ? " connected " : " disconnected ")
+            << (port == 0 ? "primary " : "") << "2560x1440+" << port * 2560 << "+0 (normal left inverted right x axis y axis) 597mm x 336mm\n";
+        if (!connected) continue;
+        for (int mode = 0; mode < 24; mode++) {
+            out << "   " << 2560 - mode * 80 << "x" << 1440 - mode * 45 << "     "
+                << (mode == 0 ? "143.97*+" : "59.95 ") << "  119.88   99.95    60.00\n";
+        }
+    }
+    return out.str();
+}
+
+std::string makeMonitorListing() {
+    return "Monitors: 3\n"
+           " 0: +*DP-1 2560/597x1440/336+0+0  DP-1\n"
+           " 1: +DP-2 2560/597x1440/336+2560+0  DP-2\n"
+           " 2: +HDMI-A-1 1920/527x1080/296+5120+0  HDMI-A-1\n";
+}
+
+std::vector<AppProfile> makeProfiles(int count) {
+    std::vector<AppProfile> profiles;
+    for (int i = 0; i < count; i++) {
+        AppProfile profile;
+        profile.name = "profile-" + std::to_string(i);
+        profile.enabled = true;
+        profile.pathMatching = (i % 3) == 1;
+        switch (i % 3) {
+            case 0: profile.executable = "game" + std::to_string(i) + ".exe"; break;
+            case 1: profile.executable = "/opt/games/title" + std::to_string(i); break;
+            case 2: profile.windowTitle = "Title " + std::to_string(i) + " -"; break;
+        }
+        profile.displayVibrance["DP-1"] = static_cast<float>(i % 100);
+        profiles.push_back(profile);
+    }
+    return profiles;
+}
+
+std::vector<MatchQuery> makeQueries(int count) {
+    std::vector<MatchQuery> queries;
+    for (int i = 0; i < 1024; i++) {
+        int id = (i * 7919) % (count * 2);  // half of these name no profile
+        MatchQuery query;
+        switch (i % 3) {
+            case 0: query.executable = "/home/user/.wine/drive_c/game" + std::to_string(id) + ".exe"; break;
+            case 1: query.executable = "/opt/games/title" + std::to_string(id) + "/bin/run"; break;
+            case 2:
+                query.executable = "/usr/bin/editor";
+                query.title = "Welcome - Title " + std::to_string(id) + " - Launcher v2";
+                break;
+        }
+        queries.push_back(query);
+    }
+    return queries;
+}
+
+void expectOutputs(const char* parser, const std::vector<std::string>& outputs) {
+    if (outputs != std::vector<std::string>(std::begin(kOutputs), std::end(kOutputs))) {
+        std::cerr << "vivid-bench: " << parser << " found " << outputs.size() << " outputs, expected 3\n";
+        std::exit(1);
+    }
+}
+
+std::unique_ptr<VibranceController> makeController(RecordingBackend*& backend) {
+    std::vector<std::string> outputs(std::begin(kOutputs), std::end(kOutputs));
+    auto recording = std::make_unique<RecordingBackend>(outputs);
+    backend = recording.get();
+    return std::make_unique<VibranceController>(std::move(recording));
+}
+
+std::vector<Case> makeCases() {
+    std::vector<Case> cases;
+
+    for (int size : {256, 1024, 4096}) {
+        cases.push_back({"ramp.generate/" + std::to_string(size), [size]() -> Batch {
+            auto ramp = std::make_shared<GammaRamp>(size);
+            return [ramp, size](uint64_t iterations) {
+                RampParams params;
+                for (uint64_t i = 0; i < iterations; i++) {
+                    params.vibrance = static_cast<int>(i % 201) - 100;
+                    generateRamp(params, *ramp);
+                    g_sink += ramp->red[size / 2];
+                }
+            };
+        }});
+    }
+
+    cases.push_back({"ramp.cache_hit/1024", []() -> Batch {
+        auto cache = std::make_shared<GammaRampCache>();
+        cache->get(1024, 0);  // builds the full table for a common size
+        return [cache](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                g_sink += cache->get(1024, static_cast<int>(i % 201) - 100)->size();
+            }
+        };
+    }});
+
+    cases.push_back({"enumerate.parse_query", []() -> Batch {
+        auto text = std::make_shared<std::string>(makeQueryOutput());
+        expectOutputs("parseConnectedOutputs", parseConnectedOutputs(*text));
+        return [text](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) g_sink += parseConnectedOutputs(*text).size();
+        };
+    }});
+
+    cases.push_back({"enumerate.parse_listmonitors", []() -> Batch {
+        auto text = std::make_shared<std::string>(makeMonitorListing());
+        expectOutputs("parseMonitorOutputs", parseMonitorOutputs(*text));
+        return [text](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) g_sink += parseMonitorOutputs(*text).size();
+        };
+    }});
+
+    for (int count : {100, 1000, 10000}) {
+        cases.push_back({"profile.match/" + std::to_string(count), [count]() -> Batch {
+            auto matcher = std::make_shared<ProfileMatcher>();
+            matcher->build(makeProfiles(count));
+            auto queries = std::make_shared<std::vector<MatchQuery>>(makeQueries(count));
+            return [matcher, queries](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++) {
+                    g_sink += matcher->match((*queries)[i & 1023]) + 1;
+                }
+            };
+        }});
+    }
+
+    cases.push_back({"profile.build/1000", []() -> Batch {
+        auto profiles = std::make_shared<std::vector<AppProfile>>(makeProfiles(1000));
+        return [profiles](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                ProfileMatcher matcher;
+                matcher.build(*profiles);
+                g_sink += matcher.getTitleStateCount();
+            }
+        };
+    }});
+
+    cases.push_back({"snapshot.load", []() -> Batch {
+        DisplayList displays;
+        for (const char* output : kOutputs) displays.push_back({output, output, 0, true});
+        auto cell = std::make_shared<SnapshotCell<DisplayList>>(displays);
+        return [cell](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) g_sink += cell->load()->size();
+        };
+    }});
+
+    cases.push_back({"config.load/1000", []() -> Batch {
+        // Compacted snapshot plus a journal of recent edits, as after a week of use
+        std::string directory = g_workDirectory + "/store";
+        std::vector<AppProfile> profiles = makeProfiles(1000);
+        {
+            ProfileStore store(directory);
+            std::vector<AppProfile> ignored;
+            store.load(ignored);
+            store.compact(profiles);
+            for (int i = 0; i < 100; i++) {
+                profiles[i * 7].displayVibrance["DP-2"] = static_cast<float>(i);
+                store.put(profiles[i * 7]);
+            }
+        }
+        return [directory](uint64_t iterations) {
+            std::vector<AppProfile> loaded;
+            for (uint64_t i = 0; i < iterations; i++) {
+                ProfileStore store(directory);
+                store.load(loaded);
+                g_sink += loaded.size();
+            }
+        };
+    }});
+
+    cases.push_back({"apply.set_vibrance", []() -> Batch {
+        RecordingBackend* backend = nullptr;
+        std::shared_ptr<VibranceController> controller = makeController(backend);
+        return [controller, backend](uint64_t iterations) {
+            uint64_t before = backend->getUploads();
+            for (uint64_t i = 0; i < iterations; i++) {
+                controller->setVibrance(kOutputs[i % 3], static_cast<int>(i % 200) - 99);
+            }
+            if (backend->getUploads() - before != iterations) {
+                std::cerr << "vivid-bench: set_vibrance reached the backend "
+                          << backend->getUploads() - before << " times, expected " << iterations << "\n";
+                std::exit(1);
+            }
+        };
+    }});
+
+    cases.push_back({"apply.set_temperature", []() -> Batch {
+        // Toggling between two white points: both sets of ramps stay cached, so upload only
+        RecordingBackend* backend = nullptr;
+        std::shared_ptr<VibranceController> controller = makeController(backend);
+        controller->setVibrance("DP-1", 40);
+        return [controller](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                controller->setTemperature(4500 + static_cast<int>(i % 2) * 100);
+            }
+        };
+    }});
+
+    cases.push_back({"apply.night_light_step", []() -> Batch {
+        // A new white point every step: builds only the levels the 3 outputs show, then uploads
+        RecordingBackend* backend = nullptr;
+        std::shared_ptr<VibranceController> controller = makeController(backend);
+        controller->setVibrance("DP-1", 40);
+        auto step = std::make_shared<int>(0);
+        return [controller, step](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                controller->setTemperature(1000 + (*step)++ % 9000);
+            }
+        };
+    }});
+
+    cases.push_back({"apply.get_displays", []() -> Batch {
+        RecordingBackend* backend = nullptr;
+        std::shared_ptr<VibranceController> controller = makeController(backend);
+        return [controller](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) g_sink += controller->getDisplays()->size();
+        };
+    }});
+
+    return cases;
+}
+
+std::string jsonString(const std::string& value) {
+    std::string out = "\"";
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+struct Summary {
+    double median, mean, min, max, stddev;
+};
+
+Summary summarize(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    Summary summary;
+    size_t n = samples.size();
+    summary.median = (n % 2) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    summary.min = samples.front();
+    summary.max = samples.back();
+    double sum = 0.0;
+    for (double sample : samples) sum += sample;
+    summary.mean = sum / n;
+    double squares = 0.0;
+    for (double sample : samples) squares += (sample - summary.mean) * (sample - summary.mean);
+    summary.stddev = (n > 1) ? std::sqrt(squares / (n - 1)) : 0.0;
+    return summary;
+}
+
+void printJson(const std::vector<Result>& results, const Options& options) {
+    char host[256] = "unknown";
+    gethostname(host, sizeof(host) - 1);
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    std::ostringstream out;
+    out << std::setprecision(6);
+    out << "{\n  \"context\": {\n"
+        << "    \"project\": \"vivid\",\n"
+        << "    \"version\": " << jsonString(VIVID_VERSION) << ",\n"
+        << "    \"date\": " << jsonString(date) << ",\n"
+        << "    \"host\": " << jsonString(host) << ",\n"
+        << "    \"cpus\": " << std::thread::hardware_concurrency() << ",\n"
+        << "    \"compiler\": " << jsonString(__VERSION__) << ",\n"
+#ifdef NDEBUG
+        << "    \"assertions\": false,\n"
+#else
+        << "    \"assertions\": true,\n"
+#endif
+        << "    \"ramp_isa\": " << jsonString(getRampIsaName(getRampIsa())) << ",\n"
+        << "    \"repetitions\": " << options.repetitions << "\n"
+        << "  },\n  \"benchmarks\": [";
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& result = results[i];
+        Summary summary = summarize(result.nsPerOp);
+        out << (i ? ",\n" : "\n")
+            << "    {\"name\": " << jsonString(result.name)
+            << ", \"batch\": " << result.batch
+            << ", \"ns_per_op\": {\"median\": " << summary.median << ", \"mean\": " << summary.mean
+            << ", \"min\": " << summary.min << ", \"max\": " << summary.max
+            << ", \"stddev\": " << summary.stddev << "}}";
+    }
+    out << "\n  ]\n}\n";
+    std::cout << out.str();
+}
+
+void printText(const std::vector<Result>& results) {
+    std::cout << std::left << std::setw(32) << "benchmark" << std::right << std::setw(14) << "median ns"
+              << std::setw(14) << "min ns" << std::setw(10) << "cv %" << "\n";
+    for (const auto& result : results) {
+        Summary summary = summarize(result.nsPerOp);
+        std::cout << std::left << std::setw(32) << result.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << summary.median << std::setw(14) << summary.min
+                  << std::setw(10) << (summary.mean > 0 ? summary.stddev / summary.mean * 100 : 0.0) << "\n";
+    }
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        } else if (arg == "--repetitions" && hasValue) {
+            options.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--min-batch-ms" && hasValue) {
+            options.minBatchMs = std::max(0.1, std::atof(argv[++i]));
+        } else if (arg == "--text") {
+            options.text = true;
+        } else {
+            std::cerr << "usage: vivid-bench [--filter <substring>] [--repetitions <n>] "
+                         "[--min-batch-ms <ms>] [--text]\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) return 2;
+
+    // Controllers probe capabilities into $HOME/.config; keep that and the store out of the real one
+    g_workDirectory = (std::filesystem::temp_directory_path() / ("vivid-bench-" + std::to_string(getpid()))).string();
+    std::filesystem::remove_all(g_workDirectory);
+    std::filesystem::create_directories(g_workDirectory);
+    setenv("HOME", g_workDirectory.c_str(), 1);
+
+    std::vector<Result> results;
+    for (const auto& benchCase : makeCases()) {
+        if (!options.filter.empty() && benchCase.name.find(options.filter) == std::string::npos) continue;
+        Batch batch = benchCase.setup();
+        results.push_back(measure(benchCase.name, batch, options));
+    }
+
+    std::filesystem::remove_all(g_workDirectory);
+
+    if (options.text) {
+        printText(results);
+    } else {
+        printJson(results, options);
+    }
+    return 0;
+}
@@ -1,48 +1,79 @@
 #include "SaturationController.h"
-#include <iostream>
+#include "core/GammaRamp.h"
+#include "backends/GammaBackend.h"
+#include "backends/DdcCi.h"
+#include "core/DdcDisplayCache.h"
+#include "core/DdcWriteScheduler.h"
+#include "core/Logger.h"
 #include <cstdlib>
 #include <fstream>
+#include <iterator>
 #include <sstream>
 #include <algorithm>
+#include <cmath>
+#include <unistd.h>
 
 #ifdef HAVE_X11
 #include <X11/Xlib.h>
 #include <X11/extensions/Xrandr.h>
+#include "backends/XRandrGammaBackend.h"
 #endif
 
-SaturationController::SaturationController() : currentMethod("None"), initialized(false) {
+SaturationController::SaturationController(bool ddcOnly)
+    : currentMethod("None"), initialized(false), ddcOnly(ddcOnly) {
     initialize();
 }
 
-SaturationController::~SaturationController() = default;
+SaturationController::~SaturationController() {
+    // Settled values still waiting out their interval go to the monitors first
+    if (ddcScheduler) ddcScheduler->stop();
+    // Last-known values are only written out here and after detection, not per change
+    if (ddcCache) ddcCache->save();
+}
+
+namespace {
+
+// The kernel's copy when DRM has one, which costs no bus traffic; the monitor's otherwise
+bool readBusEdid(const DdcBus& bus, DdcCi& ddc, std::vector<uint8_t>& edid) {
+    if (!bus.edidPath.empty()) {
+        std::ifstream file(bus.edidPath, std::ios::binary);
+        edid.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (isValidEdid(edid)) {
+            edid.resize(128);
+            return true;
+        }
+    }
+    return ddc.readEdid(edid);
+}
+
+} // namespace
 
 bool SaturationController::initialize() {
-    std::cout << "Initializing Vivid saturation controller...\n";
+    LOG_INFO << "Initializing Vivid saturation controller...";
     
     // Try different methods in order of preference
-    if (tryX11Method()) {
+    if (!ddcOnly && tryX11Method()) {
         currentMethod = "X11/xrandr";
-        std::cout << "✓ Using X11/xrandr method\n";
+        LOG_INFO << "✓ Using X11/xrandr method";
         initialized = true;
         return true;
     }
     
     if (tryDDCMethod()) {
         currentMethod = "DDC/CI";
-        std::cout << "✓ Using DDC/CI method\n";
+        LOG_INFO << "✓ Using DDC/CI method";
         initialized = true;
         return true;
     }
     
-    std::cerr << "✗ No compatible saturation control method found!\n";
-    std::cerr << "  Make sure you're running on X11 or have ddcutil installed.\n";
-    std::cerr << "  Current session: ";
-    if (std::getenv("WAYLAND_DISPLAY")) {
-        std::cerr << "Wayland (limited support)\n";
-    } else if (std::getenv("DISPLAY")) {
-        std::cerr << "X11 (should work)\n";
+    LOG_ERROR << "✗ No compatible saturation control method found!";
+    if (ddcOnly) {
+        LOG_ERROR << "  DDC/CI needs access to /dev/i2c-* (i2c-dev module, i2c group).";
     } else {
-        std::cerr << "Unknown\n";
+        const char* session = std::getenv("WAYLAND_DISPLAY") ? "Wayland (limited support)"
+                            : std::getenv("DISPLAY") ? "X11 (should work)" : "Unknown";
+        LOG_ERROR << "  Make sure you're running on X11 or can access /dev/i2c-* (i2c-dev module, i2c group).";
+        LOG_ERROR << "  Current session: " << session;
     }
     
     currentMethod = "None (Demo Mode)";
@@ -56,43 +87,58 @@ bool SaturationController::isX11Session() {
 
 bool SaturationController::tryX11Method() {
     if (!isX11Session()) {
-        std::cout << "  X11 not available (not running X11 session)\n";
+        LOG_INFO << "  X11 not available (not running X11 session)";
         return false;
     }
     
 #ifdef HAVE_X11
     Display* display = XOpenDisplay(nullptr);
     if (!display) {
-        std::cout << "  X11 not available (cannot connect to display)\n";
+        LOG_INFO << "  X11 not available (cannot connect to display)";
         return false;
     }
     
     // Check if xrandr extension is available
     int event_base, error_base;
     if (!XRRQueryExtension(display, &event_base, &error_base)) {
-        std::cout << "  X11 not available (xrandr extension missing)\n";
+        LOG_INFO << "  X11 not available (xrandr extension missing)";
         XCloseDisplay(display);
         return false;
     }
     
     XCloseDisplay(display);
-    std::cout << "  X11/xrandr available\n";
+    
+    auto backend = std::make_unique<XRandrGammaBackend>();
+    if (backend->open()) {
+        gammaBackend = std::move(backend);
+    }
+    
+    LOG_INFO << "  X11/xrandr available";
     return true;
 #else
-    std::cout << "  X11 not available (not compiled with X11 support)\n";
+    LOG_INFO << "  X11 not available (not compiled with X11 support)";
     return false;
 #endif
 }
 
 bool SaturationController::tryDDCMethod() {
-    // Check if ddcutil is available
-    std::cout << "  Checking for ddcutil...\n";
-    int result = system("which ddcutil > /dev/null 2>&1");
-    if (result == 0) {
-        std::cout << "  ddcutil found\n";
+    // Talk DDC/CI in-process over i2c-dev; needs the i2c-dev module and access to the nodes
+    LOG_INFO << "  Checking for DDC/CI buses...";
+    size_t usable = 0;
+    for (const auto& bus : findDdcBuses()) {
+        if (access(bus.devicePath.c_str(), R_OK | W_OK) == 0) {
+            usable++;
+        }
+    }
+    
+    if (usable > 0) {
+        LOG_INFO << "  " << usable << " display I2C bus(es) accessible";
+        ddcCache = std::make_unique<DdcDisplayCache>();
+        ddcCache->load();
+        ddcScheduler = std::make_unique<DdcWriteScheduler>(DdcWriteScheduler::getConfiguredInterval());
         return true;
     } else {
-        std::cout << "  ddcutil not found (install with: sudo dnf install ddcutil)\n";
+        LOG_INFO << "  No accessible display I2C bus (load i2c-dev and join the i2c group)";
         return false;
     }
 }
@@ -101,62 +147,72 @@ std::vector<std::string> SaturationController::getDisplays() {
     if (currentMethod == "X11/xrandr") {
         return getX11Displays();
     } else if (currentMethod == "DDC/CI") {
-        // Use ddcutil to get displays
-        std::vector<std::string> displays;
-        std::cout << "Detecting DDC/CI displays...\n";
-        FILE* pipe = popen("ddcutil detect --brief 2>/dev/null | grep 'Display' | awk '{print $2}'", "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                std::string display = buffer;
-                display.erase(display.find_last_not_of(" \n\r\t") + 1);
-                if (!display.empty()) {
-                    displays.push_back("DDC-" + display);
-                }
-            }
-            pclose(pipe);
-        }
-        if (displays.empty()) {
-            displays.push_back("No DDC/CI displays found");
-        }
-        return displays;
+        return getDDCDisplays();
     }
     
     // Demo mode - return fake displays
     return {"Demo-Display-1", "Demo-Display-2"};
 }
 
-std::vector<std::string> SaturationController::getX11Displays() {
+std::vector<std::string> SaturationController::getDDCDisplays() {
     std::vector<std::string> displays;
+    LOG_INFO << "Detecting DDC/CI displays...";
+    // Detection talks to the buses directly, so no write may be in flight
+    ddcScheduler->flush();
     
-#ifdef HAVE_X11
-    Display* dpy = XOpenDisplay(nullptr);
-    if (!dpy) {
-        displays.push_back("Error: Cannot connect to X11");
-        return displays;
+    for (const auto& bus : findDdcBuses()) {
+        std::string name = "DDC-" + (bus.connector.empty() ? bus.devicePath.substr(5) : bus.connector);
+        
+        // Keep each bus's DdcCi across detections so its pacing carries over
+        auto it = ddcDisplays.find(name);
+        if (it == ddcDisplays.end()) {
+            auto device = I2cBusDevice::open(bus.devicePath);
+            if (!device) continue;
+            DdcDisplay display;
+            display.ddc = std::make_unique<DdcCi>(std::move(device));
+            it = ddcDisplays.emplace(name, std::move(display)).first;
+        }
+        
+        // Reading the EDID is the whole check for a monitor the cache already knows
+        std::vector<uint8_t> edid;
+        if (!readBusEdid(bus, *it->second.ddc, edid)) continue;
+        if (ddcCache->resolve(bus.devicePath, edid, *it->second.ddc)) {
+            it->second.edidHash = DdcDisplayCache::hashEdid(edid);
+            ddcScheduler->addMonitor(name, it->second.ddc.get());
+            LOG_INFO << "  Found DDC/CI display: " << name << " on " << bus.devicePath;
+            displays.push_back(name);
+        }
     }
+    ddcCache->save();
     
-    XRRScreenResources* screen_resources = XRRGetScreenResources(dpy, DefaultRootWindow(dpy));
-    if (!screen_resources) {
-        displays.push_back("Error: Cannot get screen resources");
-        XCloseDisplay(dpy);
-        return displays;
+    if (displays.empty()) {
+        LOG_INFO << "  No DDC/CI displays found";
     }
+    return displays;
+}
+
+std::vector<std::string> SaturationController::getX11Displays() {
+    std::vector<std::string> displays;
     
-    std::cout << "Found " << screen_resources->noutput << " X11 outputs\n";
-    
-    for (int i = 0; i < screen_resources->noutput; i++) {
-        XRROutputInfo* output_info = XRRGetOutputInfo(dpy, screen_resources, screen_resources->outputs[i]);
-        if (output_info && output_info->connection == RR_Connected) {
-            std::string displayName = std::string(output_info->name);
-            displays.push_back(displayName);
-            std::cout << "  Found connected display: " << displayName << "\n";
+#ifdef HAVE_X11
+    // Reuse the persistent connection; refresh() is one XRRGetScreenResourcesCurrent
+    if (!gammaBackend) {
+        auto backend = std::make_unique<XRandrGammaBackend>();
+        if (!backend->open()) {
+            displays.push_back("Error: Cannot connect to X11");
+            return displays;
         }
-        if (output_info) XRRFreeOutputInfo(output_info);
+        gammaBackend = std::move(backend);
+    } else if (!gammaBackend->refresh()) {
+        displays.push_back("Error: Cannot get screen resources");
+        return displays;
     }
     
-    XRRFreeScreenResources(screen_resources);
-    XCloseDisplay(dpy);
+    displays = gammaBackend->getOutputs();
+    LOG_INFO << "Found " << displays.size() << " connected X11 outputs";
+    for (const auto& displayName : displays) {
+        LOG_INFO << "  Found connected display: " << displayName;
+    }
 #else
     displays.push_back("X11 support not compiled");
 #endif
@@ -172,39 +228,30 @@ bool SaturationController::setSaturation(const std::string& display, float satur
     // Clamp saturation to valid range
     saturation = std::max(0.0f, std::min(2.0f, saturation));
     
-    std::cout << "Setting " << display << " saturation to " << (saturation * 100) << "%\n";
+    LOG_DEBUG << "Setting " << display << " saturation to " << (saturation * 100) << "%";
     
     if (currentMethod == "X11/xrandr") {
         bool success = setX11Saturation(display, saturation);
         if (success) {
             currentSaturations[display] = saturation;
-            std::cout << "✓ Successfully set saturation\n";
+            LOG_DEBUG << "✓ Successfully set saturation";
         } else {
-            std::cout << "✗ Failed to set saturation\n";
+            LOG_WARN << "✗ Failed to set saturation";
         }
         return success;
     } else if (currentMethod == "DDC/CI") {
-        // Use ddcutil to set saturation (VCP code 0x8A is common for saturation)
-        if (display.substr(0, 4) == "DDC-") {
-            std::string displayNum = display.substr(4); // Remove "DDC-" prefix
-            int vcpValue = static_cast<int>(saturation * 50); // Convert to 0-100 range
-            
-            std::string command = "ddcutil setvcp 8A " + std::to_string(vcpValue) + " --display " + displayNum + " 2>/dev/null";
-            std::cout << "Running: " << command << "\n";
-            int result = system(command.c_str());
-            
-            if (result == 0) {
-                currentSaturations[display] = saturation;
-                std::cout << "✓ Successfully set DDC/CI saturation\n";
-                return true;
-            } else {
-                std::cout << "✗ DDC/CI command failed\n";
-            }
+        bool success = setDDCSaturation(display, saturation);
+        if (success) {
+            currentSaturations[display] = saturation;
+            LOG_DEBUG << "✓ DDC/CI saturation queued";
+        } else {
+            LOG_WARN << "✗ DDC/CI saturation write failed on " << display;
         }
+        return success;
     } else {
         // Demo mode
         currentSaturations[display] = saturation;
-        std::cout << "✓ Demo mode: saturation set (no actual change)\n";
+        LOG_DEBUG << "✓ Demo mode: saturation set (no actual change)";
         return true;
     }
     
@@ -218,21 +265,64 @@ bool SaturationController::setX11Saturation(const std::string& display, float sa
     float gamma = 1.0f / saturation; // Inverse relationship for visual effect
     gamma = std::max(0.5f, std::min(2.0f, gamma));
     
+    if (gammaBackend && gammaBackend->applyGamma(display, uniformChannelGamma(gamma))) {
+        return true;
+    }
+    
     std::string command = "xrandr --output " + display + " --gamma " + 
                          std::to_string(gamma) + ":" + std::to_string(gamma) + ":" + std::to_string(gamma);
     
-    std::cout << "Running: " << command << "\n";
+    LOG_DEBUG << "Running: " << command;
     int result = system(command.c_str());
     
     return result == 0;
 }
 
+bool SaturationController::setDDCSaturation(const std::string& display, float saturation) {
+    auto it = ddcDisplays.find(display);
+    if (it == ddcDisplays.end()) return false;
+    
+    DdcDisplay& target = it->second;
+    DdcMonitorRecord* record = ddcCache->findMonitor(target.edidHash);
+    if (!record || !record->allows(VcpCode::SATURATION)) return false;
+    
+    // The range comes from the cache after the first read
+    VcpValue value = record->getValue(VcpCode::SATURATION);
+    if (value.maximum == 0) {
+        ddcScheduler->flush();
+        if (!target.ddc->getVcp(VcpCode::SATURATION, value) || value.maximum == 0) return false;
+    }
+    
+    // 1.0 lands on the monitor's midpoint, where its neutral setting usually is. The bus
+    // thread writes it; the cache already takes it as the value the monitor will settle on.
+    value.current = static_cast<uint16_t>(std::lround(saturation / 2.0f * value.maximum));
+    if (!ddcScheduler->submit(display, VcpCode::SATURATION, value.current)) return false;
+    ddcCache->recordValue(target.edidHash, VcpCode::SATURATION, value);
+    return true;
+}
+
 float SaturationController::getSaturation(const std::string& display) {
     auto it = currentSaturations.find(display);
-    return (it != currentSaturations.end()) ? it->second : 1.0f;
+    if (it != currentSaturations.end()) return it->second;
+    
+    // Not set by this process: the last value the cache saw, else ask the monitor once
+    auto ddc = ddcDisplays.find(display);
+    if (ddc == ddcDisplays.end()) return 1.0f;
+    DdcMonitorRecord* record = ddcCache->findMonitor(ddc->second.edidHash);
+    if (!record || !record->allows(VcpCode::SATURATION)) return 1.0f;
+    
+    VcpValue value = record->getValue(VcpCode::SATURATION);
+    if (value.maximum == 0) {
+        ddcScheduler->flush();
+        if (!ddc->second.ddc->getVcp(VcpCode::SATURATION, value) || value.maximum == 0) return 1.0f;
+        ddcCache->recordValue(ddc->second.edidHash, VcpCode::SATURATION, value);
+    }
+    float saturation = 2.0f * value.current / value.maximum;
+    currentSaturations[display] = saturation;
+    return saturation;
 }
 
 bool SaturationController::resetSaturation(const std::string& display) {
-    std::cout << "Resetting " << display << " to normal saturation\n";
+    LOG_DEBUG << "Resetting " << display << " to normal saturation";
     return setSaturation(display, 1.0f);
 }
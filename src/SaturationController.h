@@ -1,12 +1,22 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 
-// Simple class to handle saturation control across different methods
+class GammaBackend;
+class DdcCi;
+class DdcDisplayCache;
+class DdcWriteScheduler;
+
+// Simple class to handle saturation control across different methods. X11 gamma is
+// tried before DDC/CI unless ddcOnly is set; vivid-cli and the daemon set it, since
+// gamma there belongs to VibranceController and what they want is the monitor's own
+// saturation control.
 class SaturationController {
 public:
-    SaturationController();
+    explicit SaturationController(bool ddcOnly = false);
     ~SaturationController();
     
     // Core functionality
@@ -19,11 +29,25 @@ public:
     // Get current method being used
     std::string getCurrentMethod() const { return currentMethod; }
     bool isInitialized() const { return initialized; }
+    // Per-monitor write counters in DDC/CI mode; nullptr otherwise
+    const DdcWriteScheduler* getDdcScheduler() const { return ddcScheduler.get(); }
     
 private:
     std::string currentMethod;
     std::map<std::string, float> currentSaturations;
     bool initialized;
+    bool ddcOnly;
+    std::unique_ptr<GammaBackend> gammaBackend;
+    
+    // DDC/CI monitors by display name; each owns its bus and that bus's command pacing
+    struct DdcDisplay {
+        std::unique_ptr<DdcCi> ddc;
+        std::string edidHash;  // the monitor's record in ddcCache
+    };
+    std::map<std::string, DdcDisplay> ddcDisplays;
+    std::unique_ptr<DdcDisplayCache> ddcCache;
+    // Declared after ddcDisplays so its bus threads stop before the DdcCi they use go
+    std::unique_ptr<DdcWriteScheduler> ddcScheduler;
     
     // Different methods to try (in order of preference)
     bool tryX11Method();
@@ -33,4 +57,6 @@ private:
     bool isX11Session();
     std::vector<std::string> getX11Displays();
     bool setX11Saturation(const std::string& display, float saturation);
+    std::vector<std::string> getDDCDisplays();
+    bool setDDCSaturation(const std::string& display, float saturation);
 };
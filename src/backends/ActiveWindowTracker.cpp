@@ -0,0 +1,287 @@
+#include "ActiveWindowTracker.h"
+#include "../core/Metrics.h"
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#ifdef HAVE_X11
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/Xutil.h>
+#include "XErrorRouter.h"
+
+namespace {
+
+// One XGetWindowProperty; empty when the window or property is gone
+std::string readStringProperty(Display* display, Window window, Atom property, Atom type) {
+    Atom actualType;
+    int actualFormat;
+    unsigned long count, remaining;
+    unsigned char* data = nullptr;
+    std::string value;
+
+    Metrics::count(Counter::X_ROUND_TRIPS);
+    if (XGetWindowProperty(display, window, property, 0, 1024, False, type, &actualType,
+                           &actualFormat, &count, &remaining, &data) == Success && data) {
+        if (actualFormat == 8) {
+            value.assign(reinterpret_cast<const char*>(data), count);
+        }
+        XFree(data);
+    }
+    return value;
+}
+
+bool readCardinal(Display* display, Window window, Atom property, Atom type, unsigned long& value) {
+    Atom actualType;
+    int actualFormat;
+    unsigned long count, remaining;
+    unsigned char* data = nullptr;
+    bool found = false;
+
+    Metrics::count(Counter::X_ROUND_TRIPS);
+    if (XGetWindowProperty(display, window, property, 0, 1, False, type, &actualType,
+                           &actualFormat, &count, &remaining, &data) == Success && data) {
+        if (actualFormat == 32 && count == 1) {
+            // Format 32 data comes back as longs
+            value = *reinterpret_cast<unsigned long*>(data);
+            found = true;
+        }
+        XFree(data);
+    }
+    return found;
+}
+
+} // namespace
+
+ActiveWindowTracker::ActiveWindowTracker(FocusCallback callback)
+    : m_callback(std::move(callback)) {}
+
+ActiveWindowTracker::~ActiveWindowTracker() {
+    stop();
+}
+
+bool ActiveWindowTracker::start(const char* displayName) {
+    if (isRunning()) return true;
+
+    m_display = XOpenDisplay(displayName);
+    if (!m_display) return false;
+
+    m_stopFd = eventfd(0, EFD_CLOEXEC);
+    if (m_stopFd < 0) {
+        XCloseDisplay(m_display);
+        m_display = nullptr;
+        return false;
+    }
+
+    // Focused windows close all the time; a BadWindow from one still being queried is routine
+    XErrorRouter::ignore(m_display);
+
+    m_root = DefaultRootWindow(m_display);
+    m_netActiveWindow = XInternAtom(m_display, "_NET_ACTIVE_WINDOW", False);
+    m_netWmPid = XInternAtom(m_display, "_NET_WM_PID", False);
+    m_netWmName = XInternAtom(m_display, "_NET_WM_NAME", False);
+    m_utf8String = XInternAtom(m_display, "UTF8_STRING", False);
+
+    XSelectInput(m_display, m_root, PropertyChangeMask);
+    XFlush(m_display);
+
+    m_thread = std::thread(&ActiveWindowTracker::run, this);
+    return true;
+}
+
+void ActiveWindowTracker::stop() {
+    if (m_thread.joinable()) {
+        uint64_t one = 1;
+        ssize_t written = write(m_stopFd, &one, sizeof(one));
+        (void)written;
+        m_thread.join();
+    }
+    if (m_stopFd >= 0) {
+        close(m_stopFd);
+        m_stopFd = -1;
+    }
+    if (m_display) {
+        // Errors still in flight arrive while the route stands; a closed Display* can be reused
+        XSync(m_display, False);
+        XErrorRouter::release(m_display);
+        XCloseDisplay(m_display);
+        m_display = nullptr;
+    }
+    m_cache.clear();
+}
+
+ActiveWindow ActiveWindowTracker::getActiveWindow() const {
+    std::lock_guard<std::mutex> lock(m_activeMutex);
+    return m_active;
+}
+
+ActiveWindowTracker::Stats ActiveWindowTracker::getStats() const {
+    Stats stats;
+    stats.focusChanges = m_focusChanges.load();
+    stats.propertyReads = m_propertyReads.load();
+    stats.cacheHits = m_cacheHits.load();
+    return stats;
+}
+
+unsigned long ActiveWindowTracker::readActiveWindow() {
+    unsigned long window = 0;
+    m_propertyReads++;
+    readCardinal(m_display, m_root, m_netActiveWindow, XA_WINDOW, window);
+    return window;
+}
+
+const ActiveWindow& ActiveWindowTracker::resolve(unsigned long window) {
+    auto inserted = m_cache.emplace(window, CachedWindow());
+    CachedWindow& cached = inserted.first->second;
+    if (inserted.second) {
+        // Watch it from now on: property changes invalidate, destruction evicts
+        cached.info.window = window;
+        XSelectInput(m_display, window, PropertyChangeMask | StructureNotifyMask);
+    }
+
+    if (cached.classValid && cached.pidValid && cached.titleValid) {
+        m_cacheHits++;
+        return cached.info;
+    }
+
+    if (!cached.classValid) {
+        XClassHint hint = {};
+        m_propertyReads++;
+        Metrics::count(Counter::X_ROUND_TRIPS);
+        if (XGetClassHint(m_display, window, &hint)) {
+            cached.info.instance = hint.res_name ? hint.res_name : "";
+            cached.info.className = hint.res_class ? hint.res_class : "";
+            if (hint.res_name) XFree(hint.res_name);
+            if (hint.res_class) XFree(hint.res_class);
+        }
+        cached.classValid = true;
+    }
+
+    if (!cached.pidValid) {
+        unsigned long pid = 0;
+        m_propertyReads++;
+        cached.info.pid = readCardinal(m_display, window, m_netWmPid, XA_CARDINAL, pid) ? static_cast<int>(pid) : -1;
+        cached.pidValid = true;
+    }
+
+    if (!cached.titleValid) {
+        m_propertyReads++;
+        cached.info.title = readStringProperty(m_display, window, m_netWmName, m_utf8String);
+        if (cached.info.title.empty()) {
+            m_propertyReads++;
+            cached.info.title = readStringProperty(m_display, window, XA_WM_NAME, XA_STRING);
+        }
+        cached.titleValid = true;
+    }
+    return cached.info;
+}
+
+bool ActiveWindowTracker::invalidate(unsigned long window, unsigned long atom) {
+    auto it = m_cache.find(window);
+    if (it == m_cache.end()) return false;
+
+    CachedWindow& cached = it->second;
+    if (atom == XA_WM_CLASS) {
+        cached.classValid = false;
+    } else if (atom == m_netWmPid) {
+        cached.pidValid = false;
+    } else if (atom == m_netWmName || atom == XA_WM_NAME) {
+        cached.titleValid = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void ActiveWindowTracker::publish(unsigned long window) {
+    ActiveWindow info = window ? resolve(window) : ActiveWindow();
+    {
+        std::lock_guard<std::mutex> lock(m_activeMutex);
+        m_active = info;
+    }
+    m_callback(info);
+}
+
+void ActiveWindowTracker::run() {
+    struct pollfd fds[2];
+    fds[0].fd = ConnectionNumber(m_display);
+    fds[0].events = POLLIN;
+    fds[1].fd = m_stopFd;
+    fds[1].events = POLLIN;
+
+    // Report whatever has focus now, then only changes
+    unsigned long active = readActiveWindow();
+    m_focusChanges++;
+    publish(active);
+
+    while (true) {
+        if (XPending(m_display) == 0) {
+            fds[0].revents = 0;
+            fds[1].revents = 0;
+            if (poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+            if (fds[1].revents & POLLIN) return;
+            if (fds[0].revents & (POLLERR | POLLHUP)) return;
+        }
+
+        // Drain the whole batch first: a focus switch and the new window's title update
+        // often arrive together, and the callback should see the end state once
+        bool focusChanged = false;
+        bool activeChanged = false;
+        while (XPending(m_display) > 0) {
+            XEvent event;
+            XNextEvent(m_display, &event);
+
+            if (event.type == PropertyNotify) {
+                const XPropertyEvent& property = event.xproperty;
+                if (property.window == m_root) {
+                    if (property.atom == m_netActiveWindow) focusChanged = true;
+                } else if (invalidate(property.window, property.atom) && property.window == active) {
+                    activeChanged = true;
+                }
+            } else if (event.type == DestroyNotify) {
+                m_cache.erase(event.xdestroywindow.window);
+            }
+        }
+
+        if (focusChanged) {
+            unsigned long window = readActiveWindow();
+            if (window != active) {
+                active = window;
+                activeChanged = true;
+                m_focusChanges++;
+            }
+        }
+
+        if (activeChanged) {
+            publish(active);
+        }
+    }
+}
+
+#else
+
+// Without X11 there is no focus to follow; start() fails and VividManager skips profiles
+ActiveWindowTracker::ActiveWindowTracker(FocusCallback callback)
+    : m_callback(std::move(callback)) {}
+
+ActiveWindowTracker::~ActiveWindowTracker() = default;
+
+bool ActiveWindowTracker::start(const char*) {
+    return false;
+}
+
+void ActiveWindowTracker::stop() {}
+
+ActiveWindow ActiveWindowTracker::getActiveWindow() const {
+    return ActiveWindow();
+}
+
+ActiveWindowTracker::Stats ActiveWindowTracker::getStats() const {
+    return Stats();
+}
+
+#endif
@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct _XDisplay;
+
+struct ActiveWindow {
+    unsigned long window = 0;
+    std::string instance;   // WM_CLASS res_name, usually the executable name
+    std::string className;  // WM_CLASS res_class
+    std::string title;      // _NET_WM_NAME, WM_NAME when the client sets no EWMH name
+    int pid = -1;           // _NET_WM_PID; -1 when the client does not set it
+};
+
+// Follows focus through PropertyNotify on the root window's _NET_ACTIVE_WINDOW. The
+// thread sleeps in poll() while focus is stable. Window properties are read once per
+// window and kept until that window reports a change to them, so a focus switch back
+// to a known window costs one property read.
+class ActiveWindowTracker {
+public:
+    // Runs on the tracker thread, on each focus change and when the focused window's
+    // class, pid or title changes
+    using FocusCallback = std::function<void(const ActiveWindow& window)>;
+
+    struct Stats {
+        uint64_t focusChanges = 0;
+        uint64_t propertyReads = 0;
+        uint64_t cacheHits = 0;
+    };
+
+    explicit ActiveWindowTracker(FocusCallback callback);
+    ~ActiveWindowTracker();
+
+    ActiveWindowTracker(const ActiveWindowTracker&) = delete;
+    ActiveWindowTracker& operator=(const ActiveWindowTracker&) = delete;
+
+    bool start(const char* displayName = nullptr);
+    void stop();
+    bool isRunning() const { return m_thread.joinable(); }
+
+    ActiveWindow getActiveWindow() const;
+    Stats getStats() const;
+
+private:
+    struct CachedWindow {
+        ActiveWindow info;
+        bool classValid = false;
+        bool pidValid = false;
+        bool titleValid = false;
+    };
+
+    FocusCallback m_callback;
+    _XDisplay* m_display = nullptr;
+    unsigned long m_root = 0;
+    int m_stopFd = -1;
+    std::thread m_thread;
+
+    // Atoms, interned once at start
+    unsigned long m_netActiveWindow = 0;
+    unsigned long m_netWmPid = 0;
+    unsigned long m_netWmName = 0;
+    unsigned long m_utf8String = 0;
+
+    std::map<unsigned long, CachedWindow> m_cache;  // tracker thread only
+    mutable std::mutex m_activeMutex;
+    ActiveWindow m_active;
+
+    std::atomic<uint64_t> m_focusChanges{0};
+    std::atomic<uint64_t> m_propertyReads{0};
+    std::atomic<uint64_t> m_cacheHits{0};
+
+    void run();
+    unsigned long readActiveWindow();
+    const ActiveWindow& resolve(unsigned long window);
+    // Returns true when the property is one the cache holds for that window
+    bool invalidate(unsigned long window, unsigned long atom);
+    void publish(unsigned long window);
+};
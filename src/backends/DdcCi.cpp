@@ -0,0 +1,345 @@
+#include "DdcCi.h"
+#include "../core/Metrics.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <thread>
+
+namespace {
+
+const uint8_t kDdcAddress = 0x37;       // 7-bit; 0x6E/0x6F on the wire
+const uint8_t kHostAddress = 0x51;      // source address of every host request
+const uint8_t kDisplayAddress = 0x6E;   // source address of every display reply
+const uint8_t kLengthFlag = 0x80;
+
+const uint8_t kGetVcpRequest = 0x01;
+const uint8_t kGetVcpReply = 0x02;
+const uint8_t kSetVcpRequest = 0x03;
+const uint8_t kCapabilitiesRequest = 0xF3;
+const uint8_t kCapabilitiesReply = 0xE3;
+const size_t kGetVcpReplyData = 8;      // opcode, result, code, type, max, current
+const size_t kCapabilitiesReplyData = 35;  // opcode, offset, up to 32 bytes of text
+const size_t kMaxCapabilities = 4096;
+
+const uint8_t kEdidAddress = 0x50;
+const size_t kEdidLength = 128;
+
+std::string readFirstLine(const std::filesystem::path& path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+// Two hex digits at text[i]; capabilities strings from some monitors omit the spaces
+bool readHexByte(const std::string& text, size_t i, uint8_t& value) {
+    if (i + 1 >= text.size() || !std::isxdigit(static_cast<unsigned char>(text[i])) ||
+        !std::isxdigit(static_cast<unsigned char>(text[i + 1]))) {
+        return false;
+    }
+    value = static_cast<uint8_t>(std::stoi(text.substr(i, 2), nullptr, 16));
+    return true;
+}
+
+// Index of the parenthesis closing the one at open, or npos
+size_t matchingParen(const std::string& text, size_t open) {
+    int depth = 0;
+    for (size_t i = open; i < text.size(); i++) {
+        if (text[i] == '(') depth++;
+        else if (text[i] == ')' && --depth == 0) return i;
+    }
+    return std::string::npos;
+}
+
+// "10 12 14(05 08 0B) 8A": codes, each optionally followed by its permitted values
+void parseFeatures(const std::string& text, std::map<uint8_t, std::vector<uint8_t>>& features) {
+    uint8_t code = 0;
+    bool haveCode = false;
+    size_t i = 0;
+    while (i < text.size()) {
+        uint8_t value;
+        if (text[i] == '(') {
+            size_t close = matchingParen(text, i);
+            if (close == std::string::npos) return;
+            // Values at the first level only; MCCS 3 nests sub-lists inside them
+            for (size_t j = i + 1; j < close; j++) {
+                if (text[j] == '(') {
+                    j = matchingParen(text, j);
+                    if (j == std::string::npos) return;
+                } else if (haveCode && readHexByte(text, j, value)) {
+                    features[code].push_back(value);
+                    j++;
+                }
+            }
+            i = close + 1;
+        } else if (readHexByte(text, i, value)) {
+            code = value;
+            haveCode = true;
+            features[code];
+            i += 2;
+        } else {
+            i++;
+        }
+    }
+}
+
+} // namespace
+
+bool parseCapabilities(const std::string& text, DdcCapabilities& capabilities) {
+    capabilities = DdcCapabilities();
+
+    size_t first = text.find_first_not_of(" \t\r\n");
+    size_t last = text.find_last_not_of(" \t\r\n");
+    if (first == std::string::npos) return false;
+    std::string body = text.substr(first, last - first + 1);
+    if (body.front() == '(' && matchingParen(body, 0) == body.size() - 1) {
+        body = body.substr(1, body.size() - 2);
+    }
+
+    // Top level is name(value) groups: prot, type, model, cmds, vcp, mccs_ver...
+    bool sawFeatures = false;
+    size_t i = 0;
+    while (i < body.size()) {
+        size_t open = body.find('(', i);
+        if (open == std::string::npos) break;
+        size_t close = matchingParen(body, open);
+        if (close == std::string::npos) break;
+
+        std::string name = body.substr(i, open - i);
+        name.erase(0, name.find_first_not_of(" \t"));
+        std::string value = body.substr(open + 1, close - open - 1);
+        if (name == "model") {
+            capabilities.model = value;
+        } else if (name == "vcp") {
+            parseFeatures(value, capabilities.features);
+            sawFeatures = true;
+        }
+        i = close + 1;
+    }
+    return sawFeatures;
+}
+
+bool isValidEdid(const std::vector<uint8_t>& edid) {
+    static const uint8_t kHeader[] = {0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00};
+    if (edid.size() < kEdidLength || !std::equal(kHeader, kHeader + 8, edid.begin())) return false;
+
+    uint8_t sum = 0;
+    for (size_t i = 0; i < kEdidLength; i++) sum += edid[i];
+    return sum == 0;
+}
+
+std::vector<DdcBus> findDdcBuses() {
+    std::vector<DdcBus> buses;
+    std::set<std::string> seen;
+    std::error_code ec;
+
+    // card0-DP-1/ddc links to the connector's adapter; DP AUX adapters are children
+    bool anyConnector = false;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/class/drm", ec)) {
+        std::string name = entry.path().filename().string();
+        size_t dash = name.find('-');
+        if (name.rfind("card", 0) != 0 || dash == std::string::npos) continue;
+        anyConnector = true;
+        if (readFirstLine(entry.path() / "status") == "disconnected") continue;
+
+        std::string adapter;
+        std::error_code linkError;
+        auto ddc = std::filesystem::read_symlink(entry.path() / "ddc", linkError);
+        if (!linkError) {
+            adapter = ddc.filename().string();
+        } else {
+            for (const auto& child : std::filesystem::directory_iterator(entry.path(), linkError)) {
+                std::string childName = child.path().filename().string();
+                if (childName.rfind("i2c-", 0) == 0) {
+                    adapter = childName;
+                    break;
+                }
+            }
+        }
+        if (!adapter.empty() && seen.insert(adapter).second) {
+            buses.push_back({"/dev/" + adapter, name.substr(dash + 1), (entry.path() / "edid").string()});
+        }
+    }
+
+    // Drivers that register no DRM connectors (the NVIDIA blob) still expose the adapters
+    if (!anyConnector) {
+        for (const auto& entry : std::filesystem::directory_iterator("/sys/bus/i2c/devices", ec)) {
+            std::string adapter = entry.path().filename().string();
+            if (adapter.rfind("i2c-", 0) != 0) continue;
+            if (readFirstLine(entry.path() / "name").find("SMBus") != std::string::npos) continue;
+            buses.push_back({"/dev/" + adapter, "", ""});
+        }
+    }
+
+    std::sort(buses.begin(), buses.end(),
+              [](const DdcBus& a, const DdcBus& b) { return a.devicePath < b.devicePath; });
+    return buses;
+}
+
+DdcCi::DdcCi(std::unique_ptr<I2cDevice> device, const DdcTiming& timing)
+    : m_device(std::move(device)), m_timing(timing), m_readyAt(std::chrono::steady_clock::now()) {}
+
+uint8_t DdcCi::replyChecksum(const uint8_t* data, size_t length) {
+    uint8_t sum = 0x50;
+    for (size_t i = 0; i < length; i++) sum ^= data[i];
+    return sum;
+}
+
+uint8_t DdcCi::requestChecksum(const uint8_t* data, size_t length) {
+    uint8_t sum = kDisplayAddress;
+    for (size_t i = 0; i < length; i++) sum ^= data[i];
+    return sum;
+}
+
+void DdcCi::waitUntilReady() {
+    auto now = std::chrono::steady_clock::now();
+    if (m_readyAt > now) {
+        std::this_thread::sleep_for(m_readyAt - now);
+    }
+}
+
+// A command that needed retries leaves the monitor more room before the next one
+void DdcCi::finishCommand(int tries) {
+    m_readyAt = std::chrono::steady_clock::now() + m_timing.commandInterval * tries;
+}
+
+bool DdcCi::sendRequest(const uint8_t* payload, size_t length) {
+    uint8_t message[8];
+    message[0] = kHostAddress;
+    message[1] = static_cast<uint8_t>(kLengthFlag | length);
+    std::memcpy(message + 2, payload, length);
+    message[2 + length] = requestChecksum(message, 2 + length);
+
+    m_stats.commands++;
+    Metrics::count(Counter::DDC_COMMANDS);
+    return m_device->write(kDdcAddress, message, length + 3) == 0;
+}
+
+bool DdcCi::exchange(const uint8_t* request, size_t length, uint8_t replyOpcode, size_t maxPayload,
+                     std::vector<uint8_t>& payload) {
+    // Source, length, payload, checksum
+    std::vector<uint8_t> reply(maxPayload + 3);
+
+    for (int attempt = 1; attempt <= m_timing.maxTries; attempt++) {
+        if (attempt > 1) {
+            m_stats.retries++;
+            Metrics::count(Counter::DDC_RETRIES);
+        }
+        waitUntilReady();
+        if (!sendRequest(request, length)) {
+            finishCommand(attempt);
+            continue;
+        }
+
+        std::this_thread::sleep_for(m_timing.replyDelay);
+        std::fill(reply.begin(), reply.end(), 0);
+        int result = m_device->read(kDdcAddress, reply.data(), reply.size());
+        finishCommand(attempt);
+        if (result != 0 || reply[0] != kDisplayAddress || (reply[1] & kLengthFlag) == 0) continue;
+
+        // Null message: the monitor is busy and wants the request again
+        size_t count = reply[1] & ~kLengthFlag;
+        if (count == 0) {
+            m_stats.nullReplies++;
+            continue;
+        }
+        if (count > maxPayload) continue;
+        if (reply[2 + count] != replyChecksum(reply.data(), 2 + count)) {
+            m_stats.checksumErrors++;
+            continue;
+        }
+        if (reply[2] != replyOpcode) continue;
+
+        payload.assign(reply.begin() + 2, reply.begin() + 2 + count);
+        return true;
+    }
+    return false;
+}
+
+bool DdcCi::getVcp(VcpCode code, VcpValue& value) {
+    LatencyTimer timer;
+    const uint8_t request[] = {kGetVcpRequest, static_cast<uint8_t>(code)};
+
+    std::vector<uint8_t> payload;
+    if (!exchange(request, sizeof(request), kGetVcpReply, kGetVcpReplyData, payload) ||
+        payload.size() != kGetVcpReplyData || payload[2] != static_cast<uint8_t>(code)) {
+        timer.record("ddc.failed", path());
+        return false;
+    }
+
+    // Result code 1: the monitor does not have this feature, asking again won't help
+    if (payload[1] != 0) {
+        timer.record("ddc.unsupported", path());
+        return false;
+    }
+
+    value.maximum = static_cast<uint16_t>((payload[4] << 8) | payload[5]);
+    value.current = static_cast<uint16_t>((payload[6] << 8) | payload[7]);
+    timer.record("ddc.getvcp", path());
+    return true;
+}
+
+bool DdcCi::setVcp(VcpCode code, uint16_t value) {
+    LatencyTimer timer;
+    const uint8_t request[] = {kSetVcpRequest, static_cast<uint8_t>(code),
+                               static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value & 0xFF)};
+
+    // Set VCP has no reply; a NAK is the only failure the bus reports
+    for (int attempt = 1; attempt <= m_timing.maxTries; attempt++) {
+        if (attempt > 1) {
+            m_stats.retries++;
+            Metrics::count(Counter::DDC_RETRIES);
+        }
+        waitUntilReady();
+        bool sent = sendRequest(request, sizeof(request));
+        finishCommand(attempt);
+        if (sent) {
+            timer.record("ddc.setvcp", path());
+            return true;
+        }
+    }
+
+    timer.record("ddc.failed", path());
+    return false;
+}
+
+bool DdcCi::getCapabilities(std::string& text) {
+    LatencyTimer timer;
+    text.clear();
+
+    // Each reply carries the offset it answers and up to 32 bytes; an empty one ends it
+    size_t offset = 0;
+    while (offset < kMaxCapabilities) {
+        const uint8_t request[] = {kCapabilitiesRequest, static_cast<uint8_t>(offset >> 8),
+                                   static_cast<uint8_t>(offset & 0xFF)};
+        std::vector<uint8_t> payload;
+        if (!exchange(request, sizeof(request), kCapabilitiesReply, kCapabilitiesReplyData, payload) ||
+            payload.size() < 3 || static_cast<size_t>((payload[1] << 8) | payload[2]) != offset) {
+            timer.record("ddc.failed", path());
+            return false;
+        }
+
+        size_t count = payload.size() - 3;
+        if (count == 0) break;
+        for (size_t i = 3; i < payload.size(); i++) {
+            if (payload[i] != 0) text += static_cast<char>(payload[i]);
+        }
+        offset += count;
+    }
+
+    timer.record("ddc.capabilities", path());
+    return !text.empty();
+}
+
+bool DdcCi::readEdid(std::vector<uint8_t>& edid) {
+    // Not DDC/CI traffic, so the command pacing does not apply
+    const uint8_t offset = 0;
+    edid.assign(kEdidLength, 0);
+    if (m_device->write(kEdidAddress, &offset, 1) != 0 || m_device->read(kEdidAddress, edid.data(), kEdidLength) != 0) {
+        return false;
+    }
+    return isValidEdid(edid);
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include "I2cDevice.h"
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// MCCS VCP feature codes vivid uses
+enum class VcpCode : uint8_t {
+    BRIGHTNESS = 0x10,
+    CONTRAST = 0x12,
+    COLOR_PRESET = 0x14,
+    SATURATION = 0x8A
+};
+
+struct VcpValue {
+    uint16_t current = 0;
+    uint16_t maximum = 0;
+};
+
+// DDC/CI waits. The defaults are the spec's minimums; a fake bus can run with none.
+struct DdcTiming {
+    std::chrono::milliseconds replyDelay{40};       // between a request and reading its reply
+    std::chrono::milliseconds commandInterval{50};  // after each command, before the next on the bus
+    int maxTries = 4;
+};
+
+// What a monitor's capabilities string says it supports
+struct DdcCapabilities {
+    std::string model;
+    std::map<uint8_t, std::vector<uint8_t>> features;  // VCP code -> permitted values; empty when continuous
+
+    bool supports(VcpCode code) const { return features.count(static_cast<uint8_t>(code)) > 0; }
+};
+
+// Parses "(prot(monitor)type(lcd)model(X)vcp(10 12 14(05 08 0B) 8A))"; false without a vcp list
+bool parseCapabilities(const std::string& text, DdcCapabilities& capabilities);
+
+// A DDC/CI-capable bus and the DRM connector it belongs to, if any
+struct DdcBus {
+    std::string devicePath;  // /dev/i2c-N
+    std::string connector;   // e.g. DP-1; empty when the bus was found without DRM
+    std::string edidPath;    // the connector's EDID as the kernel last read it; empty without DRM
+};
+
+// Buses of the connected DRM connectors; every non-SMBus adapter when no driver
+// registers connectors
+std::vector<DdcBus> findDdcBuses();
+
+// VCP get/set with one monitor on one bus. The inter-command delay is a deadline kept
+// per bus, so a command only sleeps for whatever is left of it. A busy monitor's null
+// reply, a NAK or a bad checksum is retried with growing spacing; an unsupported
+// feature is not.
+class DdcCi {
+public:
+    explicit DdcCi(std::unique_ptr<I2cDevice> device, const DdcTiming& timing = DdcTiming());
+
+    bool getVcp(VcpCode code, VcpValue& value);
+    bool setVcp(VcpCode code, uint16_t value);
+    // The whole capabilities string, fragment by fragment; a second or more of bus time
+    bool getCapabilities(std::string& text);
+    // Base EDID block from address 0x50, header and checksum verified
+    bool readEdid(std::vector<uint8_t>& edid);
+
+    const std::string& path() const { return m_device->path(); }
+
+    struct Stats {
+        uint64_t commands = 0;
+        uint64_t retries = 0;
+        uint64_t checksumErrors = 0;
+        uint64_t nullReplies = 0;
+    };
+    Stats getStats() const { return m_stats; }
+
+    // Reply checksum: XOR of the virtual host address 0x50 and every byte received
+    static uint8_t replyChecksum(const uint8_t* data, size_t length);
+    // Request checksum: XOR of the display's write address 0x6E and every byte sent
+    static uint8_t requestChecksum(const uint8_t* data, size_t length);
+
+private:
+    std::unique_ptr<I2cDevice> m_device;
+    DdcTiming m_timing;
+    std::chrono::steady_clock::time_point m_readyAt;
+    Stats m_stats;
+
+    void waitUntilReady();
+    void finishCommand(int tries);
+    bool sendRequest(const uint8_t* payload, size_t length);
+    // One request and its reply, retried until the reply is well formed and starts with
+    // replyOpcode; payload gets the reply's data bytes, opcode first
+    bool exchange(const uint8_t* request, size_t length, uint8_t replyOpcode, size_t maxPayload,
+                  std::vector<uint8_t>& payload);
+};
+
+// True when edid is a base block with a valid header and checksum
+bool isValidEdid(const std::vector<uint8_t>& edid);
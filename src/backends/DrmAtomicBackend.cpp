@@ -0,0 +1,444 @@
+#include "DrmAtomicBackend.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <drm.h>
+#include <drm_mode.h>
+
+namespace {
+
+// Old blobs are destroyed past this; a CRTC still using one keeps its own kernel reference
+const size_t kMaxBlobs = 32;
+
+const char* const kConnectorTypes[] = {
+    "Unknown", "VGA", "DVI-I", "DVI-D", "DVI-A", "Composite", "SVIDEO", "LVDS",
+    "Component", "DIN", "DP", "HDMI-A", "HDMI-B", "TV", "eDP", "Virtual",
+    "DSI", "DPI", "Writeback", "SPI", "USB"
+};
+
+static_assert(sizeof(drm_color_lut) == 4 * sizeof(uint16_t), "GAMMA_LUT entry layout");
+
+// Same names the kernel uses in /sys/class/drm, e.g. "HDMI-A-1"
+std::string connectorName(uint32_t type, uint32_t typeId) {
+    const size_t count = sizeof(kConnectorTypes) / sizeof(kConnectorTypes[0]);
+    std::string name = (type < count) ? kConnectorTypes[type] : "Unknown";
+    return name + "-" + std::to_string(typeId);
+}
+
+double modeRefreshRate(const drm_mode_modeinfo& mode) {
+    double vTotal = mode.vtotal;
+    if (mode.flags & DRM_MODE_FLAG_DBLSCAN) vTotal *= 2.0;
+    if (mode.flags & DRM_MODE_FLAG_INTERLACE) vTotal /= 2.0;
+    if (mode.htotal == 0 || vTotal <= 0.0) return 0.0;
+    return mode.clock * 1000.0 / (mode.htotal * vTotal);
+}
+
+template <typename T>
+uint64_t toPointer(T* pointer) {
+    return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pointer));
+}
+
+uint64_t hashBytes(const void* data, size_t length) {
+    // FNV-1a over 64-bit words; LUT blobs are a multiple of 8 bytes
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = 1469598103934665603ULL ^ length;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        hash ^= word;
+        hash *= 1099511628211ULL;
+    }
+    for (; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+} // namespace
+
+DrmAtomicBackend::DrmAtomicBackend(std::unique_ptr<DrmDevice> device)
+    : m_device(std::move(device)) {}
+
+DrmAtomicBackend::~DrmAtomicBackend() {
+    destroyBlobs();
+}
+
+std::unique_ptr<DrmAtomicBackend> DrmAtomicBackend::openFirstCapable(const std::string& dir) {
+    std::vector<std::string> cards;
+    if (const char* pinned = std::getenv("VIVID_DRM_DEVICE")) {
+        // Pins one node, e.g. the vkms card in tests
+        cards.push_back(pinned);
+    } else {
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+            std::string name = entry.path().filename().string();
+            if (name.rfind("card", 0) == 0) {
+                cards.push_back(entry.path().string());
+            }
+        }
+        std::sort(cards.begin(), cards.end());
+    }
+
+    for (const auto& path : cards) {
+        auto device = DrmCardDevice::open(path);
+        if (!device) continue;
+
+        auto backend = std::make_unique<DrmAtomicBackend>(std::move(device));
+        if (backend->initialize()) {
+            return backend;
+        }
+    }
+    return nullptr;
+}
+
+bool DrmAtomicBackend::initialize() {
+    drm_set_client_cap cap{};
+    cap.capability = DRM_CLIENT_CAP_ATOMIC;
+    cap.value = 1;
+    if (m_device->ioctl(DRM_IOCTL_SET_CLIENT_CAP, &cap) != 0) {
+        return false;
+    }
+    return refresh() && isAvailable();
+}
+
+bool DrmAtomicBackend::refresh() {
+    m_crtcs.clear();
+    m_outputToCrtc.clear();
+
+    // Two-call pattern; retry if a hotplug grows the lists between the calls
+    std::vector<uint32_t> crtcIds;
+    std::vector<uint32_t> connectorIds;
+    bool settled = false;
+    for (int attempt = 0; attempt < 3 && !settled; attempt++) {
+        drm_mode_card_res resources{};
+        resources.count_crtcs = static_cast<uint32_t>(crtcIds.size());
+        resources.crtc_id_ptr = toPointer(crtcIds.data());
+        resources.count_connectors = static_cast<uint32_t>(connectorIds.size());
+        resources.connector_id_ptr = toPointer(connectorIds.data());
+        if (m_device->ioctl(DRM_IOCTL_MODE_GETRESOURCES, &resources) != 0) {
+            return false;
+        }
+
+        settled = resources.count_crtcs <= crtcIds.size() &&
+                  resources.count_connectors <= connectorIds.size();
+        crtcIds.resize(resources.count_crtcs);
+        connectorIds.resize(resources.count_connectors);
+    }
+    if (!settled) return false;
+
+    for (uint32_t connectorId : connectorIds) {
+        // A non-zero mode count stops the kernel from forcing a slow connector probe
+        drm_mode_modeinfo mode{};
+        drm_mode_get_connector connector{};
+        connector.connector_id = connectorId;
+        connector.count_modes = 1;
+        connector.modes_ptr = toPointer(&mode);
+        if (m_device->ioctl(DRM_IOCTL_MODE_GETCONNECTOR, &connector) != 0) continue;
+        if (connector.connection != 1 || connector.encoder_id == 0) continue;
+
+        drm_mode_get_encoder encoder{};
+        encoder.encoder_id = connector.encoder_id;
+        if (m_device->ioctl(DRM_IOCTL_MODE_GETENCODER, &encoder) != 0 || encoder.crtc_id == 0) continue;
+
+        size_t index = m_crtcs.size();
+        for (size_t c = 0; c < m_crtcs.size(); c++) {
+            if (m_crtcs[c].id == encoder.crtc_id) {
+                index = c;
+                break;
+            }
+        }
+
+        if (index == m_crtcs.size()) {
+            Crtc crtc;
+            crtc.id = encoder.crtc_id;
+            if (!readCrtcProperties(crtc)) continue;
+
+            // Vblank requests address CRTCs by their position in the resource list
+            auto pipe = std::find(crtcIds.begin(), crtcIds.end(), crtc.id);
+            crtc.pipe = (pipe != crtcIds.end()) ? static_cast<int>(pipe - crtcIds.begin()) : -1;
+
+            drm_mode_crtc state{};
+            state.crtc_id = crtc.id;
+            if (m_device->ioctl(DRM_IOCTL_MODE_GETCRTC, &state) == 0 && state.mode_valid) {
+                crtc.refreshHz = modeRefreshRate(state.mode);
+            }
+            m_crtcs.push_back(crtc);
+        }
+
+        m_outputToCrtc[connectorName(connector.connector_type, connector.connector_type_id)] = index;
+    }
+    return true;
+}
+
+bool DrmAtomicBackend::readCrtcProperties(Crtc& crtc) {
+    std::vector<uint32_t> properties;
+    std::vector<uint64_t> values;
+
+    drm_mode_obj_get_properties request{};
+    request.obj_id = crtc.id;
+    request.obj_type = DRM_MODE_OBJECT_CRTC;
+    if (m_device->ioctl(DRM_IOCTL_MODE_OBJ_GETPROPERTIES, &request) != 0) return false;
+
+    properties.resize(request.count_props);
+    values.resize(request.count_props);
+    request.props_ptr = toPointer(properties.data());
+    request.prop_values_ptr = toPointer(values.data());
+    if (m_device->ioctl(DRM_IOCTL_MODE_OBJ_GETPROPERTIES, &request) != 0) return false;
+
+    size_t count = std::min<size_t>(request.count_props, properties.size());
+    for (size_t i = 0; i < count; i++) {
+        const std::string& name = getPropertyName(properties[i]);
+        if (name == "CTM") {
+            crtc.ctmProperty = properties[i];
+        } else if (name == "GAMMA_LUT") {
+            crtc.gammaLutProperty = properties[i];
+        } else if (name == "GAMMA_LUT_SIZE") {
+            crtc.gammaLutSize = static_cast<int>(values[i]);
+        }
+    }
+
+    if (crtc.gammaLutSize <= 0) {
+        crtc.gammaLutProperty = 0;
+    }
+    return crtc.ctmProperty != 0 || crtc.gammaLutProperty != 0;
+}
+
+const std::string& DrmAtomicBackend::getPropertyName(uint32_t property) {
+    // Property ids are per device, not per object, so one lookup serves every CRTC
+    auto it = m_propertyNames.find(property);
+    if (it != m_propertyNames.end()) return it->second;
+
+    drm_mode_get_property request{};
+    request.prop_id = property;
+    std::string name;
+    if (m_device->ioctl(DRM_IOCTL_MODE_GETPROPERTY, &request) == 0) {
+        name.assign(request.name, strnlen(request.name, DRM_PROP_NAME_LEN));
+    }
+    return m_propertyNames.emplace(property, name).first->second;
+}
+
+std::vector<std::string> DrmAtomicBackend::getOutputs() const {
+    std::vector<std::string> outputs;
+    for (const auto& pair : m_outputToCrtc) {
+        outputs.push_back(pair.first);
+    }
+    return outputs;
+}
+
+int DrmAtomicBackend::getGammaSize(const std::string& output) const {
+    auto it = m_outputToCrtc.find(output);
+    if (it == m_outputToCrtc.end()) return 0;
+    const Crtc& crtc = m_crtcs[it->second];
+    return crtc.gammaLutProperty ? crtc.gammaLutSize : 0;
+}
+
+double DrmAtomicBackend::getRefreshRate(const std::string& output) const {
+    auto it = m_outputToCrtc.find(output);
+    return (it != m_outputToCrtc.end()) ? m_crtcs[it->second].refreshHz : 0.0;
+}
+
+int DrmAtomicBackend::getCrtcPipe(const std::string& output) const {
+    auto it = m_outputToCrtc.find(output);
+    return (it != m_outputToCrtc.end()) ? m_crtcs[it->second].pipe : -1;
+}
+
+uint32_t DrmAtomicBackend::getBlob(const void* data, size_t length) {
+    uint64_t hash = hashBytes(data, length);
+    auto range = m_blobs.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        Blob& blob = it->second;
+        if (blob.data.size() == length && std::memcmp(blob.data.data(), data, length) == 0) {
+            blob.lastUse = ++m_useClock;
+            m_blobsReused++;
+            return blob.id;
+        }
+    }
+
+    drm_mode_create_blob create{};
+    create.data = toPointer(data);
+    create.length = static_cast<uint32_t>(length);
+    if (m_device->ioctl(DRM_IOCTL_MODE_CREATEPROPBLOB, &create) != 0) {
+        return 0;
+    }
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    Blob blob;
+    blob.id = create.blob_id;
+    blob.data.assign(bytes, bytes + length);
+    blob.lastUse = ++m_useClock;
+    m_blobs.emplace(hash, std::move(blob));
+    m_blobsCreated++;
+
+    evictBlobs();
+    return create.blob_id;
+}
+
+void DrmAtomicBackend::evictBlobs() {
+    while (m_blobs.size() > kMaxBlobs) {
+        auto oldest = m_blobs.begin();
+        for (auto it = m_blobs.begin(); it != m_blobs.end(); ++it) {
+            if (it->second.lastUse < oldest->second.lastUse) {
+                oldest = it;
+            }
+        }
+
+        drm_mode_destroy_blob destroy{};
+        destroy.blob_id = oldest->second.id;
+        m_device->ioctl(DRM_IOCTL_MODE_DESTROYPROPBLOB, &destroy);
+        m_blobs.erase(oldest);
+    }
+}
+
+void DrmAtomicBackend::destroyBlobs() {
+    for (const auto& pair : m_blobs) {
+        drm_mode_destroy_blob destroy{};
+        destroy.blob_id = pair.second.id;
+        m_device->ioctl(DRM_IOCTL_MODE_DESTROYPROPBLOB, &destroy);
+    }
+    m_blobs.clear();
+}
+
+uint32_t DrmAtomicBackend::getLutBlob(const uint16_t* red, const uint16_t* green, const uint16_t* blue, int size) {
+    // Interleave into drm_color_lut order in a reused buffer; the blob cache copies on a miss only
+    m_lutScratch.resize(static_cast<size_t>(size) * 4);
+    for (int i = 0; i < size; i++) {
+        m_lutScratch[i * 4 + 0] = red[i];
+        m_lutScratch[i * 4 + 1] = green[i];
+        m_lutScratch[i * 4 + 2] = blue[i];
+        m_lutScratch[i * 4 + 3] = 0;
+    }
+    return getBlob(m_lutScratch.data(), m_lutScratch.size() * sizeof(uint16_t));
+}
+
+bool DrmAtomicBackend::applyGamma(const std::vector<GammaTarget>& targets) {
+    for (const auto& target : targets) {
+        if (getGammaSize(target.output) <= 0) return false;
+    }
+
+    std::vector<PropertyWrite> writes;
+    for (const auto& target : targets) {
+        const Crtc& crtc = m_crtcs[m_outputToCrtc[target.output]];
+        GammaRamp ramp(crtc.gammaLutSize);
+        fillGammaRamp(ramp, target.gamma);
+
+        uint32_t blob = getLutBlob(ramp.red.data(), ramp.green.data(), ramp.blue.data(), ramp.size());
+        if (!blob) return false;
+        writes.push_back({crtc.id, crtc.gammaLutProperty, blob});
+    }
+    return commit(writes);
+}
+
+bool DrmAtomicBackend::applyRamps(const std::vector<RampTarget>& targets) {
+    for (const auto& target : targets) {
+        int size = getGammaSize(target.output);
+        if (size <= 0 || !target.ramp || target.ramp->size() != size) {
+            return false;
+        }
+    }
+
+    std::vector<PropertyWrite> writes;
+    for (const auto& target : targets) {
+        const Crtc& crtc = m_crtcs[m_outputToCrtc[target.output]];
+        const GammaRamp& ramp = *target.ramp;
+
+        uint32_t blob = getLutBlob(ramp.red.data(), ramp.green.data(), ramp.blue.data(), ramp.size());
+        if (!blob) return false;
+        writes.push_back({crtc.id, crtc.gammaLutProperty, blob});
+    }
+    return commit(writes);
+}
+
+bool DrmAtomicBackend::resetAll() {
+    // Blob id 0 puts both stages in bypass, which is exactly identity
+    std::vector<PropertyWrite> writes;
+    for (const auto& crtc : m_crtcs) {
+        if (crtc.ctmProperty) writes.push_back({crtc.id, crtc.ctmProperty, 0});
+        if (crtc.gammaLutProperty) writes.push_back({crtc.id, crtc.gammaLutProperty, 0});
+    }
+    return commit(writes);
+}
+
+bool DrmAtomicBackend::supportsColorMatrix() const {
+    for (const auto& pair : m_outputToCrtc) {
+        if (m_crtcs[pair.second].ctmProperty) return true;
+    }
+    return false;
+}
+
+bool DrmAtomicBackend::applyColorMatrix(const std::vector<MatrixTarget>& targets) {
+    for (const auto& target : targets) {
+        auto it = m_outputToCrtc.find(target.output);
+        if (it == m_outputToCrtc.end() || !m_crtcs[it->second].ctmProperty) {
+            return false;
+        }
+    }
+
+    std::vector<PropertyWrite> writes;
+    for (const auto& target : targets) {
+        const Crtc& crtc = m_crtcs[m_outputToCrtc[target.output]];
+
+        uint32_t blob = 0;
+        if (!target.ctm.isIdentity()) {
+            drm_color_ctm ctm{};
+            std::copy(std::begin(target.ctm.m), std::end(target.ctm.m), std::begin(ctm.matrix));
+            blob = getBlob(&ctm, sizeof(ctm));
+            if (!blob) return false;
+        }
+        writes.push_back({crtc.id, crtc.ctmProperty, blob});
+    }
+    return commit(writes);
+}
+
+bool DrmAtomicBackend::commit(const std::vector<PropertyWrite>& writes) {
+    if (writes.empty()) return true;
+
+    // The ioctl wants each object's properties contiguous
+    std::vector<PropertyWrite> sorted(writes);
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const PropertyWrite& a, const PropertyWrite& b) { return a.object < b.object; });
+
+    std::vector<uint32_t> objects;
+    std::vector<uint32_t> counts;
+    std::vector<uint32_t> properties;
+    std::vector<uint64_t> values;
+    for (const auto& write : sorted) {
+        if (objects.empty() || objects.back() != write.object) {
+            objects.push_back(write.object);
+            counts.push_back(0);
+        }
+        counts.back()++;
+        properties.push_back(write.property);
+        values.push_back(write.value);
+    }
+
+    auto submit = [&](uint32_t flags) {
+        drm_mode_atomic atomic{};
+        atomic.flags = flags;
+        atomic.count_objs = static_cast<uint32_t>(objects.size());
+        atomic.objs_ptr = toPointer(objects.data());
+        atomic.count_props_ptr = toPointer(counts.data());
+        atomic.props_ptr = toPointer(properties.data());
+        atomic.prop_values_ptr = toPointer(values.data());
+        return m_device->ioctl(DRM_IOCTL_MODE_ATOMIC, &atomic) == 0;
+    };
+
+    if (!submit(DRM_MODE_ATOMIC_TEST_ONLY)) {
+        m_testFailures++;
+        return false;
+    }
+
+    // Blocking commit: returns once the state is latched, so callers never queue behind EBUSY
+    return submit(0);
+}
+
+DrmAtomicBackend::BlobStats DrmAtomicBackend::getBlobStats() const {
+    BlobStats stats;
+    stats.blobs = m_blobs.size();
+    stats.created = m_blobsCreated;
+    stats.reused = m_blobsReused;
+    stats.testFailures = m_testFailures;
+    return stats;
+}
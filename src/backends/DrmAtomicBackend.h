@@ -0,0 +1,99 @@
+#pragma once
+#include "DrmDevice.h"
+#include "GammaBackend.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Drives the CTM and GAMMA_LUT CRTC properties through atomic commits, for sessions without
+// an X server (TTY, kiosk, compositor-less). Needs DRM master or an idle card.
+class DrmAtomicBackend : public GammaBackend {
+public:
+    struct BlobStats {
+        size_t blobs = 0;
+        uint64_t created = 0;
+        uint64_t reused = 0;
+        uint64_t testFailures = 0;
+    };
+
+    explicit DrmAtomicBackend(std::unique_ptr<DrmDevice> device);
+    ~DrmAtomicBackend() override;
+
+    // Tries every card under dir (or $VIVID_DRM_DEVICE), not just card0; first one with colour properties wins
+    static std::unique_ptr<DrmAtomicBackend> openFirstCapable(const std::string& dir = "/dev/dri");
+
+    // Enables the atomic client cap and enumerates connectors; false if the card has no colour pipeline
+    bool initialize();
+    bool refresh() override;
+
+    const char* name() const override { return "DRM Atomic"; }
+    bool isAvailable() const override { return !m_outputToCrtc.empty(); }
+    std::vector<std::string> getOutputs() const override;
+    int getGammaSize(const std::string& output) const override;
+    double getRefreshRate(const std::string& output) const override;
+
+    using GammaBackend::applyGamma;
+    using GammaBackend::applyColorMatrix;
+
+    bool applyGamma(const std::vector<GammaTarget>& targets) override;
+    bool applyRamps(const std::vector<RampTarget>& targets) override;
+    bool resetAll() override;
+
+    bool supportsColorMatrix() const override;
+    bool applyColorMatrix(const std::vector<MatrixTarget>& targets) override;
+
+    const std::string& getDevicePath() const { return m_device->path(); }
+
+    // For vblank pacing: the card's event fd and the CRTC index used by DRM_IOCTL_WAIT_VBLANK
+    int getVblankFd() const { return m_device->fd(); }
+    int getCrtcPipe(const std::string& output) const;
+    BlobStats getBlobStats() const;
+
+private:
+    struct Crtc {
+        uint32_t id = 0;
+        int pipe = -1;
+        double refreshHz = 0.0;
+        uint32_t ctmProperty = 0;
+        uint32_t gammaLutProperty = 0;
+        int gammaLutSize = 0;
+    };
+
+    struct Blob {
+        uint32_t id = 0;
+        std::vector<uint8_t> data;
+        uint64_t lastUse = 0;
+    };
+
+    struct PropertyWrite {
+        uint32_t object;
+        uint32_t property;
+        uint64_t value;
+    };
+
+    std::unique_ptr<DrmDevice> m_device;
+    std::vector<Crtc> m_crtcs;
+    std::map<std::string, size_t> m_outputToCrtc;
+    std::map<uint32_t, std::string> m_propertyNames;
+
+    // Content hash -> blob; identical LUTs and matrices reuse one kernel blob
+    std::unordered_multimap<uint64_t, Blob> m_blobs;
+    uint64_t m_useClock = 0;
+    uint64_t m_blobsCreated = 0;
+    uint64_t m_blobsReused = 0;
+    uint64_t m_testFailures = 0;
+    std::vector<uint16_t> m_lutScratch;
+
+    bool readCrtcProperties(Crtc& crtc);
+    const std::string& getPropertyName(uint32_t property);
+    uint32_t getBlob(const void* data, size_t length);
+    void evictBlobs();
+    void destroyBlobs();
+    uint32_t getLutBlob(const uint16_t* red, const uint16_t* green, const uint16_t* blue, int size);
+
+    // TEST_ONLY first, so a rejected state never reaches the screen
+    bool commit(const std::vector<PropertyWrite>& writes);
+};
@@ -0,0 +1,24 @@
+#include "DrmDevice.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+DrmCardDevice::~DrmCardDevice() {
+    ::close(m_fd);
+}
+
+std::unique_ptr<DrmCardDevice> DrmCardDevice::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+    return std::unique_ptr<DrmCardDevice>(new DrmCardDevice(fd, path));
+}
+
+int DrmCardDevice::ioctl(unsigned long request, void* arg) {
+    // Same retry rule as libdrm's drmIoctl
+    int result;
+    do {
+        result = ::ioctl(m_fd, request, arg);
+    } while (result == -1 && (errno == EINTR || errno == EAGAIN));
+    return result == 0 ? 0 : -errno;
+}
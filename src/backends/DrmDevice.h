@@ -0,0 +1,34 @@
+#pragma once
+#include <memory>
+#include <string>
+
+// Seam over the DRM ioctl interface so the atomic backend can run against a mock
+class DrmDevice {
+public:
+    virtual ~DrmDevice() = default;
+
+    // 0 on success, -errno on failure
+    virtual int ioctl(unsigned long request, void* arg) = 0;
+    virtual const std::string& path() const = 0;
+
+    // Pollable descriptor for DRM events; mocks have none
+    virtual int fd() const { return -1; }
+};
+
+// A /dev/dri/cardN node
+class DrmCardDevice : public DrmDevice {
+public:
+    ~DrmCardDevice() override;
+
+    static std::unique_ptr<DrmCardDevice> open(const std::string& path);
+
+    int ioctl(unsigned long request, void* arg) override;
+    const std::string& path() const override { return m_path; }
+    int fd() const override { return m_fd; }
+
+private:
+    DrmCardDevice(int fd, const std::string& path) : m_fd(fd), m_path(path) {}
+
+    int m_fd;
+    std::string m_path;
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "../core/ColorMatrix.h"
+#include "../core/GammaRamp.h"
+
+struct GammaTarget {
+    std::string output;
+    ChannelGamma gamma;
+};
+
+// Prebuilt ramp; its size must match getGammaSize(output)
+struct RampTarget {
+    std::string output;
+    std::shared_ptr<const GammaRamp> ramp;
+};
+
+// Colour transform already in kernel S31.32 form; see vibranceToCtm()
+struct MatrixTarget {
+    std::string output;
+    Ctm ctm;
+};
+
+// In-process display backend that uploads gamma ramps without spawning tools
+class GammaBackend {
+public:
+    virtual ~GammaBackend() = default;
+
+    virtual const char* name() const = 0;
+    virtual bool isAvailable() const = 0;
+
+    // Re-reads outputs and CRTCs, e.g. after a hotplug
+    virtual bool refresh() = 0;
+    virtual std::vector<std::string> getOutputs() const = 0;
+    virtual int getGammaSize(const std::string& output) const = 0;
+
+    // Refresh of the output's current mode in Hz; 0 when unknown
+    virtual double getRefreshRate(const std::string& output) const {
+        (void)output;
+        return 0.0;
+    }
+
+    // Uploads every target and flushes once; fails if any output is unknown
+    virtual bool applyGamma(const std::vector<GammaTarget>& targets) = 0;
+    virtual bool applyRamps(const std::vector<RampTarget>& targets) = 0;
+    virtual bool resetAll() = 0;
+
+    // Real saturation through a hardware colour matrix; only some backends have one
+    virtual bool supportsColorMatrix() const { return false; }
+    virtual bool applyColorMatrix(const std::vector<MatrixTarget>& targets) {
+        (void)targets;
+        return false;
+    }
+
+    bool applyGamma(const std::string& output, const ChannelGamma& gamma) {
+        return applyGamma(std::vector<GammaTarget>{{output, gamma}});
+    }
+
+    bool applyRamp(const std::string& output, std::shared_ptr<const GammaRamp> ramp) {
+        return applyRamps(std::vector<RampTarget>{{output, std::move(ramp)}});
+    }
+
+    bool applyColorMatrix(const std::string& output, const Ctm& ctm) {
+        return applyColorMatrix(std::vector<MatrixTarget>{{output, ctm}});
+    }
+};
@@ -0,0 +1,13 @@
+#pragma once
+#include <functional>
+
+// Calls back (on its own thread) when outputs appear, disappear or change mode
+class HotplugMonitor {
+public:
+    using ChangeCallback = std::function<void()>;
+
+    virtual ~HotplugMonitor() = default;
+
+    virtual void stop() = 0;
+    virtual bool isRunning() const = 0;
+};
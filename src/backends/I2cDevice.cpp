@@ -0,0 +1,44 @@
+#include "I2cDevice.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+I2cBusDevice::~I2cBusDevice() {
+    ::close(m_fd);
+}
+
+std::unique_ptr<I2cBusDevice> I2cBusDevice::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+    return std::unique_ptr<I2cBusDevice>(new I2cBusDevice(fd, path));
+}
+
+int I2cBusDevice::write(uint8_t address, const uint8_t* data, size_t length) {
+    return transfer(address, 0, const_cast<uint8_t*>(data), length);
+}
+
+int I2cBusDevice::read(uint8_t address, uint8_t* data, size_t length) {
+    return transfer(address, I2C_M_RD, data, length);
+}
+
+// I2C_RDWR names the address per message, so no I2C_SLAVE state is left on the fd
+int I2cBusDevice::transfer(uint8_t address, uint16_t flags, uint8_t* data, size_t length) {
+    i2c_msg message = {};
+    message.addr = address;
+    message.flags = flags;
+    message.len = static_cast<uint16_t>(length);
+    message.buf = data;
+
+    i2c_rdwr_ioctl_data request = {};
+    request.msgs = &message;
+    request.nmsgs = 1;
+
+    int result;
+    do {
+        result = ::ioctl(m_fd, I2C_RDWR, &request);
+    } while (result == -1 && errno == EINTR);
+    return result >= 0 ? 0 : -errno;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Seam over i2c-dev so DDC/CI can run against a fake bus
+class I2cDevice {
+public:
+    virtual ~I2cDevice() = default;
+
+    // One plain I2C message to or from a 7-bit address; 0 on success, -errno on failure
+    virtual int write(uint8_t address, const uint8_t* data, size_t length) = 0;
+    virtual int read(uint8_t address, uint8_t* data, size_t length) = 0;
+    virtual const std::string& path() const = 0;
+};
+
+// A /dev/i2c-N node
+class I2cBusDevice : public I2cDevice {
+public:
+    ~I2cBusDevice() override;
+
+    static std::unique_ptr<I2cBusDevice> open(const std::string& path);
+
+    int write(uint8_t address, const uint8_t* data, size_t length) override;
+    int read(uint8_t address, uint8_t* data, size_t length) override;
+    const std::string& path() const override { return m_path; }
+
+private:
+    I2cBusDevice(int fd, const std::string& path) : m_fd(fd), m_path(path) {}
+
+    int m_fd;
+    std::string m_path;
+
+    int transfer(uint8_t address, uint16_t flags, uint8_t* data, size_t length);
+};
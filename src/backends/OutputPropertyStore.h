@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Per-output integer properties (RandR output properties on X); mocked in tests
+class OutputPropertyStore {
+public:
+    virtual ~OutputPropertyStore() = default;
+
+    virtual bool hasProperty(const std::string& output, const std::string& property) = 0;
+
+    // Replaces a 32-bit integer property; may be buffered until commit()
+    virtual bool setProperty32(const std::string& output, const std::string& property,
+                               const std::vector<uint32_t>& values) = 0;
+
+    // Sends buffered writes and reports whether the server accepted all of them
+    virtual bool commit() = 0;
+};
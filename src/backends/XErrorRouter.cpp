@@ -0,0 +1,55 @@
+#include "XErrorRouter.h"
+#include <map>
+#include <mutex>
+#include <X11/Xlib.h>
+
+namespace {
+
+struct Route {
+    bool counting = false;
+    int errors = 0;
+};
+
+std::mutex g_mutex;
+std::map<Display*, Route> g_routes;
+XErrorHandler g_previousHandler = nullptr;
+std::once_flag g_installed;
+
+int routeError(Display* display, XErrorEvent* error) {
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        auto it = g_routes.find(display);
+        if (it != g_routes.end()) {
+            if (it->second.counting) it->second.errors++;
+            return 0;
+        }
+    }
+    return g_previousHandler ? g_previousHandler(display, error) : 0;
+}
+
+void route(Display* display, bool counting) {
+    std::call_once(g_installed, []() { g_previousHandler = XSetErrorHandler(routeError); });
+    std::lock_guard<std::mutex> lock(g_mutex);
+    Route& entry = g_routes[display];
+    entry.counting = counting;
+    entry.errors = 0;
+}
+
+} // namespace
+
+void XErrorRouter::ignore(Display* display) {
+    route(display, false);
+}
+
+void XErrorRouter::count(Display* display) {
+    route(display, true);
+}
+
+int XErrorRouter::release(Display* display) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    auto it = g_routes.find(display);
+    if (it == g_routes.end()) return 0;
+    int errors = it->second.errors;
+    g_routes.erase(it);
+    return errors;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+struct _XDisplay;
+
+// Xlib has one error handler for every connection and thread, so swapping it around a
+// call races with any other thread doing the same. This installs a single handler, once,
+// and routes each error by connection: dropped, counted, or passed to whatever handler
+// was there before (Xlib's default exits). Only built with X11.
+class XErrorRouter {
+public:
+    // Errors on display are dropped until release()
+    static void ignore(_XDisplay* display);
+    // Errors on display are counted until release()
+    static void count(_XDisplay* display);
+    // Back to the previous handler; returns the errors counted since count()
+    static int release(_XDisplay* display);
+};
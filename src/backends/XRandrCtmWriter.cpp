@@ -0,0 +1,63 @@
+#include "XRandrCtmWriter.h"
+
+namespace {
+const char* const kCtmProperty = "CTM";
+}
+
+XRandrCtmWriter::XRandrCtmWriter(OutputPropertyStore& store)
+    : m_store(store) {}
+
+bool XRandrCtmWriter::isSupported(const std::string& output) {
+    auto it = m_supported.find(output);
+    if (it != m_supported.end()) return it->second;
+
+    bool supported = m_store.hasProperty(output, kCtmProperty);
+    m_supported[output] = supported;
+    return supported;
+}
+
+void XRandrCtmWriter::invalidate() {
+    m_supported.clear();
+    m_written.clear();
+}
+
+std::vector<uint32_t> XRandrCtmWriter::encode(const Ctm& ctm) {
+    std::vector<uint32_t> words(18);
+    for (int i = 0; i < 9; i++) {
+        words[i * 2] = static_cast<uint32_t>(ctm.m[i] & 0xffffffffULL);
+        words[i * 2 + 1] = static_cast<uint32_t>(ctm.m[i] >> 32);
+    }
+    return words;
+}
+
+bool XRandrCtmWriter::apply(const std::vector<MatrixTarget>& targets) {
+    for (const auto& target : targets) {
+        if (!isSupported(target.output)) {
+            return false;
+        }
+    }
+
+    bool pending = false;
+    for (const auto& target : targets) {
+        auto it = m_written.find(target.output);
+        if (it != m_written.end() && it->second == target.ctm) continue;
+
+        if (!m_store.setProperty32(target.output, kCtmProperty, encode(target.ctm))) {
+            m_written.clear();
+            return false;
+        }
+        pending = true;
+    }
+    if (!pending) return true;
+
+    if (!m_store.commit()) {
+        // The server state is unknown now; send everything again next time
+        m_written.clear();
+        return false;
+    }
+
+    for (const auto& target : targets) {
+        m_written[target.output] = target.ctm;
+    }
+    return true;
+}
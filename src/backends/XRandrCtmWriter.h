@@ -0,0 +1,29 @@
+#pragma once
+#include "GammaBackend.h"
+#include "OutputPropertyStore.h"
+#include <map>
+#include <string>
+#include <vector>
+
+// Uploads CTMs through the RandR "CTM" output property exposed by the modesetting and amdgpu
+// X drivers; the driver forwards it to the KMS CTM, so this is real saturation under X
+class XRandrCtmWriter {
+public:
+    explicit XRandrCtmWriter(OutputPropertyStore& store);
+
+    bool isSupported(const std::string& output);
+
+    // Validates every output first; unchanged matrices are not re-sent
+    bool apply(const std::vector<MatrixTarget>& targets);
+
+    // Forget probed support and written values, e.g. after the output list changed
+    void invalidate();
+
+    // 18 32-bit words, low half first, as the drivers memcpy them into struct drm_color_ctm
+    static std::vector<uint32_t> encode(const Ctm& ctm);
+
+private:
+    OutputPropertyStore& m_store;
+    std::map<std::string, bool> m_supported;
+    std::map<std::string, Ctm> m_written;
+};
@@ -0,0 +1,302 @@
+#include "XRandrGammaBackend.h"
+#include "OutputPropertyStore.h"
+#include "XRandrCtmWriter.h"
+#include "XErrorRouter.h"
+#include "../core/Metrics.h"
+#include <cstdint>
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/extensions/Xrandr.h>
+
+namespace {
+
+// RandR output properties on the backend's own connection
+class XRandrPropertyStore : public OutputPropertyStore {
+public:
+    XRandrPropertyStore(Display* display, const std::map<std::string, unsigned long>& outputs)
+        : m_display(display), m_outputs(outputs) {}
+
+    bool hasProperty(const std::string& output, const std::string& property) override {
+        auto it = m_outputs.find(output);
+        Atom atom = getAtom(property);
+        if (it == m_outputs.end() || atom == None) return false;
+
+        Metrics::count(Counter::X_ROUND_TRIPS);
+        XRRPropertyInfo* info = XRRQueryOutputProperty(m_display, it->second, atom);
+        if (!info) return false;
+        XFree(info);
+        return true;
+    }
+
+    bool setProperty32(const std::string& output, const std::string& property,
+                       const std::vector<uint32_t>& values) override {
+        auto it = m_outputs.find(output);
+        Atom atom = getAtom(property);
+        if (it == m_outputs.end() || atom == None) return false;
+
+        // Format 32 data travels as longs on the client side
+        std::vector<long> data(values.begin(), values.end());
+        XRRChangeOutputProperty(m_display, it->second, atom, XA_INTEGER, 32, PropModeReplace,
+                                reinterpret_cast<unsigned char*>(data.data()), static_cast<int>(data.size()));
+        return true;
+    }
+
+    bool commit() override {
+        // A driver rejecting the value answers with an X error; the default handler would
+        // exit. Only errors on this connection count, whatever other threads are doing.
+        XErrorRouter::count(m_display);
+        Metrics::count(Counter::X_ROUND_TRIPS);
+        XSync(m_display, False);
+        return XErrorRouter::release(m_display) == 0;
+    }
+
+private:
+    Display* m_display;
+    const std::map<std::string, unsigned long>& m_outputs;
+    std::map<std::string, Atom> m_atoms;
+
+    Atom getAtom(const std::string& name) {
+        auto it = m_atoms.find(name);
+        if (it != m_atoms.end()) return it->second;
+
+        // Only-if-exists: no driver registered the property means no atom either
+        Metrics::count(Counter::X_ROUND_TRIPS);
+        Atom atom = XInternAtom(m_display, name.c_str(), True);
+        m_atoms[name] = atom;
+        return atom;
+    }
+};
+
+double modeRefreshRate(const XRRScreenResources* resources, RRMode mode) {
+    for (int i = 0; i < resources->nmode; i++) {
+        const XRRModeInfo& info = resources->modes[i];
+        if (info.id != mode) continue;
+
+        double vTotal = info.vTotal;
+        if (info.modeFlags & RR_DoubleScan) vTotal *= 2.0;
+        if (info.modeFlags & RR_Interlace) vTotal /= 2.0;
+        if (info.hTotal == 0 || vTotal <= 0.0) return 0.0;
+        return static_cast<double>(info.dotClock) / (info.hTotal * vTotal);
+    }
+    return 0.0;
+}
+
+} // namespace
+
+XRandrGammaBackend::XRandrGammaBackend() = default;
+
+XRandrGammaBackend::~XRandrGammaBackend() {
+    close();
+}
+
+bool XRandrGammaBackend::open(const char* displayName) {
+    if (m_display) return true;
+
+    m_display = XOpenDisplay(displayName);
+    if (!m_display) return false;
+
+    int eventBase, errorBase;
+    int major = 0, minor = 0;
+    if (!XRRQueryExtension(m_display, &eventBase, &errorBase) ||
+        !XRRQueryVersion(m_display, &major, &minor) ||
+        major < 1 || (major == 1 && minor < 2)) {
+        // Per-CRTC gamma needs RandR 1.2
+        close();
+        return false;
+    }
+
+    m_root = DefaultRootWindow(m_display);
+    m_propertyStore = std::make_unique<XRandrPropertyStore>(m_display, m_outputIds);
+    m_ctmWriter = std::make_unique<XRandrCtmWriter>(*m_propertyStore);
+    if (!refresh()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void XRandrGammaBackend::close() {
+    m_ctmWriter.reset();
+    m_propertyStore.reset();
+    releaseCrtcs();
+    if (m_display) {
+        XCloseDisplay(m_display);
+        m_display = nullptr;
+    }
+}
+
+void XRandrGammaBackend::releaseCrtcs() {
+    for (auto& crtc : m_crtcs) {
+        if (crtc.buffer) XRRFreeGamma(crtc.buffer);
+    }
+    m_crtcs.clear();
+    m_outputToCrtc.clear();
+    m_outputIds.clear();
+    if (m_ctmWriter) m_ctmWriter->invalidate();
+}
+
+bool XRandrGammaBackend::refresh() {
+    if (!m_display) return false;
+
+    Metrics::count(Counter::X_ROUND_TRIPS);
+    XRRScreenResources* resources = XRRGetScreenResourcesCurrent(m_display, m_root);
+    if (!resources) return false;
+
+    releaseCrtcs();
+
+    for (int i = 0; i < resources->noutput; i++) {
+        Metrics::count(Counter::X_ROUND_TRIPS);
+        XRROutputInfo* info = XRRGetOutputInfo(m_display, resources, resources->outputs[i]);
+        if (!info) continue;
+
+        bool wanted = m_onlyOutput.empty() || m_onlyOutput.compare(0, std::string::npos, info->name, info->nameLen) == 0;
+        if (wanted && info->connection == RR_Connected && info->crtc != 0) {
+            size_t index = m_crtcs.size();
+            for (size_t c = 0; c < m_crtcs.size(); c++) {
+                if (m_crtcs[c].id == info->crtc) {
+                    index = c;
+                    break;
+                }
+            }
+
+            if (index == m_crtcs.size()) {
+                Crtc crtc;
+                crtc.id = info->crtc;
+                Metrics::count(Counter::X_ROUND_TRIPS, 2);  // gamma size and CRTC info
+                crtc.gammaSize = XRRGetCrtcGammaSize(m_display, info->crtc);
+                if (XRRCrtcInfo* crtcInfo = XRRGetCrtcInfo(m_display, resources, info->crtc)) {
+                    crtc.refreshHz = modeRefreshRate(resources, crtcInfo->mode);
+                    XRRFreeCrtcInfo(crtcInfo);
+                }
+                if (crtc.gammaSize > 0) {
+                    crtc.buffer = XRRAllocGamma(crtc.gammaSize);
+                }
+                if (crtc.buffer) {
+                    m_crtcs.push_back(crtc);
+                } else {
+                    index = SIZE_MAX;
+                }
+            }
+
+            if (index != SIZE_MAX) {
+                std::string name(info->name, info->nameLen);
+                m_outputToCrtc[name] = index;
+                m_outputIds[name] = resources->outputs[i];
+            }
+        }
+        XRRFreeOutputInfo(info);
+
+        // Restricted: every output after the one we want would only cost more round trips
+        if (wanted && !m_onlyOutput.empty()) break;
+    }
+
+    XRRFreeScreenResources(resources);
+    return true;
+}
+
+std::vector<std::string> XRandrGammaBackend::getOutputs() const {
+    std::vector<std::string> outputs;
+    for (const auto& pair : m_outputToCrtc) {
+        outputs.push_back(pair.first);
+    }
+    return outputs;
+}
+
+int XRandrGammaBackend::getGammaSize(const std::string& output) const {
+    auto it = m_outputToCrtc.find(output);
+    return (it != m_outputToCrtc.end()) ? m_crtcs[it->second].gammaSize : 0;
+}
+
+double XRandrGammaBackend::getRefreshRate(const std::string& output) const {
+    auto it = m_outputToCrtc.find(output);
+    return (it != m_outputToCrtc.end()) ? m_crtcs[it->second].refreshHz : 0.0;
+}
+
+bool XRandrGammaBackend::applyGamma(const std::vector<GammaTarget>& targets) {
+    if (!m_display) return false;
+
+    // Resolve everything first so a bad output name never leaves a half-applied batch
+    for (const auto& target : targets) {
+        if (m_outputToCrtc.find(target.output) == m_outputToCrtc.end()) {
+            return false;
+        }
+    }
+
+    for (const auto& target : targets) {
+        Crtc& crtc = m_crtcs[m_outputToCrtc[target.output]];
+        fillGammaRamp(crtc.buffer->red, crtc.buffer->green, crtc.buffer->blue, crtc.gammaSize, target.gamma);
+        XRRSetCrtcGamma(m_display, crtc.id, crtc.buffer);
+    }
+
+    // Requests are buffered by Xlib; one flush sends the whole batch without a round trip
+    XFlush(m_display);
+    return true;
+}
+
+bool XRandrGammaBackend::applyRamps(const std::vector<RampTarget>& targets) {
+    if (!m_display) return false;
+
+    for (const auto& target : targets) {
+        auto it = m_outputToCrtc.find(target.output);
+        if (it == m_outputToCrtc.end() || !target.ramp ||
+            target.ramp->size() != m_crtcs[it->second].gammaSize) {
+            return false;
+        }
+    }
+
+    for (const auto& target : targets) {
+        const Crtc& crtc = m_crtcs[m_outputToCrtc[target.output]];
+        const GammaRamp& ramp = *target.ramp;
+
+        // Point the request straight at the cached ramp; XRRSetCrtcGamma only reads it
+        XRRCrtcGamma gamma;
+        gamma.size = ramp.size();
+        gamma.red = const_cast<unsigned short*>(ramp.red.data());
+        gamma.green = const_cast<unsigned short*>(ramp.green.data());
+        gamma.blue = const_cast<unsigned short*>(ramp.blue.data());
+        XRRSetCrtcGamma(m_display, crtc.id, &gamma);
+    }
+
+    XFlush(m_display);
+    return true;
+}
+
+bool XRandrGammaBackend::resetAll() {
+    if (!m_display) return false;
+
+    for (auto& crtc : m_crtcs) {
+        fillGammaRamp(crtc.buffer->red, crtc.buffer->green, crtc.buffer->blue, crtc.gammaSize, ChannelGamma());
+        XRRSetCrtcGamma(m_display, crtc.id, crtc.buffer);
+    }
+
+    XFlush(m_display);
+    return true;
+}
+
+bool XRandrGammaBackend::supportsColorMatrix() const {
+    if (!m_ctmWriter) return false;
+    for (const auto& pair : m_outputIds) {
+        if (m_ctmWriter->isSupported(pair.first)) return true;
+    }
+    return false;
+}
+
+bool XRandrGammaBackend::applyColorMatrix(const std::vector<MatrixTarget>& targets) {
+    return m_ctmWriter && m_ctmWriter->apply(targets);
+}
+
+bool XRandrGammaBackend::reapplyCurrent() {
+    if (!m_display) return false;
+
+    for (const auto& crtc : m_crtcs) {
+        Metrics::count(Counter::X_ROUND_TRIPS);
+        XRRCrtcGamma* current = XRRGetCrtcGamma(m_display, crtc.id);
+        if (!current) return false;
+        XRRSetCrtcGamma(m_display, crtc.id, current);
+        XRRFreeGamma(current);
+    }
+
+    Metrics::count(Counter::X_ROUND_TRIPS);
+    XSync(m_display, False);
+    return true;
+}
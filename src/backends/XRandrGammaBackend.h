@@ -0,0 +1,63 @@
+#pragma once
+#include "GammaBackend.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct _XDisplay;
+struct _XRRCrtcGamma;
+class OutputPropertyStore;
+class XRandrCtmWriter;
+
+// Persistent Xlib connection that drives CRTC gamma through XRRSetCrtcGamma
+class XRandrGammaBackend : public GammaBackend {
+public:
+    XRandrGammaBackend();
+    ~XRandrGammaBackend() override;
+
+    bool open(const char* displayName = nullptr);
+    // Limits refresh() to one output so a one-shot apply skips the other CRTCs' queries
+    void restrictTo(const std::string& output) { m_onlyOutput = output; }
+    void close();
+    bool refresh() override;
+
+    const char* name() const override { return "XRandR Gamma"; }
+    bool isAvailable() const override { return m_display != nullptr; }
+    std::vector<std::string> getOutputs() const override;
+    int getGammaSize(const std::string& output) const override;
+    double getRefreshRate(const std::string& output) const override;
+
+    using GammaBackend::applyGamma;
+    using GammaBackend::applyColorMatrix;
+
+    bool applyGamma(const std::vector<GammaTarget>& targets) override;
+    bool applyRamps(const std::vector<RampTarget>& targets) override;
+    bool resetAll() override;
+
+    // Through the driver's "CTM" output property (modesetting, amdgpu); absent on other drivers
+    bool supportsColorMatrix() const override;
+    bool applyColorMatrix(const std::vector<MatrixTarget>& targets) override;
+
+    // Uploads the ramps currently on screen again and waits for the server; used to time applies
+    bool reapplyCurrent();
+
+private:
+    struct Crtc {
+        unsigned long id = 0;
+        int gammaSize = 0;
+        double refreshHz = 0.0;
+        _XRRCrtcGamma* buffer = nullptr;
+    };
+
+    _XDisplay* m_display = nullptr;
+    unsigned long m_root = 0;
+    std::vector<Crtc> m_crtcs;
+    std::map<std::string, size_t> m_outputToCrtc;
+    std::map<std::string, unsigned long> m_outputIds;
+    std::string m_onlyOutput;
+    std::unique_ptr<OutputPropertyStore> m_propertyStore;
+    std::unique_ptr<XRandrCtmWriter> m_ctmWriter;
+
+    void releaseCrtcs();
+};
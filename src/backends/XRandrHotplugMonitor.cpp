@@ -0,0 +1,102 @@
+#include "XRandrHotplugMonitor.h"
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <X11/Xlib.h>
+#include <X11/extensions/Xrandr.h>
+
+XRandrHotplugMonitor::XRandrHotplugMonitor(ChangeCallback callback)
+    : m_callback(std::move(callback)) {}
+
+XRandrHotplugMonitor::~XRandrHotplugMonitor() {
+    stop();
+}
+
+bool XRandrHotplugMonitor::start(const char* displayName) {
+    if (isRunning()) return true;
+
+    m_display = XOpenDisplay(displayName);
+    if (!m_display) return false;
+
+    int errorBase;
+    if (!XRRQueryExtension(m_display, &m_eventBase, &errorBase)) {
+        XCloseDisplay(m_display);
+        m_display = nullptr;
+        return false;
+    }
+
+    m_stopFd = eventfd(0, EFD_CLOEXEC);
+    if (m_stopFd < 0) {
+        XCloseDisplay(m_display);
+        m_display = nullptr;
+        return false;
+    }
+
+    XRRSelectInput(m_display, DefaultRootWindow(m_display),
+                   RRScreenChangeNotifyMask | RROutputChangeNotifyMask | RRCrtcChangeNotifyMask);
+    XFlush(m_display);
+
+    m_thread = std::thread(&XRandrHotplugMonitor::run, this);
+    return true;
+}
+
+void XRandrHotplugMonitor::stop() {
+    if (m_thread.joinable()) {
+        uint64_t one = 1;
+        ssize_t written = write(m_stopFd, &one, sizeof(one));
+        (void)written;
+        m_thread.join();
+    }
+    if (m_stopFd >= 0) {
+        close(m_stopFd);
+        m_stopFd = -1;
+    }
+    if (m_display) {
+        XCloseDisplay(m_display);
+        m_display = nullptr;
+    }
+}
+
+void XRandrHotplugMonitor::run() {
+    struct pollfd fds[2];
+    fds[0].fd = ConnectionNumber(m_display);
+    fds[0].events = POLLIN;
+    fds[1].fd = m_stopFd;
+    fds[1].events = POLLIN;
+
+    while (true) {
+        // Xlib may already hold events read off the socket; poll only when it has none
+        if (XPending(m_display) == 0) {
+            fds[0].revents = 0;
+            fds[1].revents = 0;
+            if (poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+            if (fds[1].revents & POLLIN) return;
+            if (fds[0].revents & (POLLERR | POLLHUP)) return;
+        }
+
+        bool changed = false;
+        while (XPending(m_display) > 0) {
+            XEvent event;
+            XNextEvent(m_display, &event);
+
+            if (event.type == m_eventBase + RRScreenChangeNotify) {
+                XRRUpdateConfiguration(&event);
+                changed = true;
+            } else if (event.type == m_eventBase + RRNotify) {
+                const XRRNotifyEvent* notify = reinterpret_cast<const XRRNotifyEvent*>(&event);
+                if (notify->subtype == RRNotify_OutputChange || notify->subtype == RRNotify_CrtcChange) {
+                    changed = true;
+                }
+            }
+        }
+
+        if (changed) {
+            m_changes++;
+            m_callback();
+        }
+    }
+}
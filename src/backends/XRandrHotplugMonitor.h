@@ -0,0 +1,31 @@
+#pragma once
+#include "HotplugMonitor.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+struct _XDisplay;
+
+// Watches RandR screen/output/CRTC change notifications on a dedicated connection, so
+// the backend's connection never has an event queue to drain. A burst of events
+// (one hotplug is several) results in one callback.
+class XRandrHotplugMonitor : public HotplugMonitor {
+public:
+    explicit XRandrHotplugMonitor(ChangeCallback callback);
+    ~XRandrHotplugMonitor() override;
+
+    bool start(const char* displayName = nullptr);
+    void stop() override;
+    bool isRunning() const override { return m_thread.joinable(); }
+    uint64_t getChangeCount() const { return m_changes.load(); }
+
+private:
+    ChangeCallback m_callback;
+    _XDisplay* m_display = nullptr;
+    int m_eventBase = 0;
+    int m_stopFd = -1;
+    std::thread m_thread;
+    std::atomic<uint64_t> m_changes{0};
+
+    void run();
+};
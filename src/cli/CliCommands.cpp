@@ -0,0 +1,292 @@
+#include "CliCommands.h"
+#include "../core/VibranceController.h"
+#include "../core/Metrics.h"
+#include "../ipc/IpcClient.h"
+#include "../ipc/VividDaemon.h"
+#include "../SaturationController.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace {
+
+int runDaemon(int statsSeconds) {
+    // Block the stop signals before any thread exists, then wait for them here.
+    // SIGUSR1 dumps the stats to stderr, as does every statsSeconds when set.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    VividDaemon daemon;
+    if (!daemon.listen()) {
+        std::cerr << "vivid: another instance owns " << defaultSocketPath() << "\n";
+        return 1;
+    }
+    daemon.start();
+
+    timespec interval = {statsSeconds, 0};
+    while (true) {
+        int received = sigtimedwait(&signals, nullptr, statsSeconds > 0 ? &interval : nullptr);
+        if (received < 0 && errno == EINTR) continue;
+        if (received == SIGINT || received == SIGTERM) break;
+        std::cerr << Metrics::format(Metrics::collect()) << std::endl;
+    }
+    daemon.stop();
+    return 0;
+}
+
+// A whole decimal number from minimum to maximum
+bool parseWhole(const char* text, long minimum, long maximum, int& value) {
+    char* end = nullptr;
+    errno = 0;
+    long parsed = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || parsed < minimum || parsed > maximum) return false;
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+bool parseVibrance(const char* text, int& value) {
+    return parseWhole(text, -100, 100, value);
+}
+
+// Monitor saturation over DDC/CI, in percent of neutral
+bool parseSaturation(const char* text, int& value) {
+    return parseWhole(text, 0, 200, value);
+}
+
+// Commands that act on displays, through the daemon or in-process
+bool isDisplayCommand(const std::string& command) {
+    return command == "--list" || command == "--set" || command == "--reset" || command == "--stats" ||
+           command == "--ddc-list" || command == "--ddc-saturation";
+}
+
+// Commands on the daemon's profile store; there is no in-process fallback for these
+bool isProfileCommand(const std::string& command) {
+    return command == "--profiles" || command == "--profile-show" || command == "--profile-save" ||
+           command == "--profile-apply" || command == "--profile-delete";
+}
+
+// --profile-save <name> <executable> [<display>=<value>...]
+bool parseProfile(int argc, char* argv[], AppProfile& profile) {
+    if (argc < 4) return false;
+    profile.name = argv[2];
+    profile.executable = argv[3];
+    for (int i = 4; i < argc; i++) {
+        std::string assignment = argv[i];
+        size_t separator = assignment.find('=');
+        int vibrance = 0;
+        if (separator == 0 || separator == std::string::npos ||
+            !parseVibrance(assignment.c_str() + separator + 1, vibrance)) {
+            return false;
+        }
+        profile.displayVibrance[assignment.substr(0, separator)] = static_cast<float>(vibrance);
+    }
+    return !profile.name.empty();
+}
+
+void printProfile(const AppProfile& profile, bool active) {
+    std::cout << (active ? "* " : "  ") << profile.name << ": " << profile.executable;
+    if (!profile.windowTitle.empty()) std::cout << " \"" << profile.windowTitle << "\"";
+    if (!profile.enabled) std::cout << " (disabled)";
+    for (const auto& pair : profile.displayVibrance) {
+        std::cout << " " << pair.first << "=" << std::lround(pair.second);
+    }
+    std::cout << "\n";
+}
+
+// Forwards a command to the running daemon; false only when there is none. Once a daemon
+// answers it owns gamma, so a failed call is reported instead of retried in-process.
+bool runRemote(IpcClient& client, const std::string& command, char* argv[], int value,
+               const AppProfile& profile, int& status) {
+    if (!client.connect()) return false;
+
+    bool ok = false;
+    if (command == "--list") {
+        std::vector<IpcOutputState> outputs;
+        ok = client.list(outputs);
+        for (const auto& output : outputs) {
+            std::cout << output.output << " (" << output.vibrance << ")\n";
+        }
+    } else if (command == "--set") {
+        ok = client.setVibrance(argv[2], value);
+    } else if (command == "--reset") {
+        ok = client.reset();
+    } else if (command == "--stats") {
+        std::string report;
+        ok = client.stats(report);
+        std::cout << report;
+    } else if (command == "--ddc-list") {
+        std::vector<IpcOutputState> monitors;
+        ok = client.ddcList(monitors);
+        for (const auto& monitor : monitors) {
+            std::cout << monitor.output << " (" << monitor.vibrance << "%)\n";
+        }
+    } else if (command == "--ddc-saturation") {
+        ok = client.setDdcSaturation(argv[2], value);
+    } else if (command == "--profiles") {
+        std::vector<AppProfile> profiles;
+        std::string active;
+        ok = client.listProfiles(profiles, active);
+        for (const auto& entry : profiles) {
+            printProfile(entry, entry.name == active);
+        }
+    } else if (command == "--profile-show") {
+        AppProfile found;
+        ok = client.getProfile(argv[2], found);
+        if (ok) printProfile(found, false);
+    } else if (command == "--profile-save") {
+        ok = client.saveProfile(profile);
+    } else if (command == "--profile-apply") {
+        ok = client.applyProfile(argv[2]);
+    } else if (command == "--profile-delete") {
+        ok = client.deleteProfile(argv[2]);
+    }
+
+    if (!ok) {
+        std::cerr << "vivid: the daemon did not complete " << command << "\n";
+    }
+    status = ok ? 0 : 1;
+    return true;
+}
+
+} // namespace
+
+void printCliHelp(const char* program, bool withGui) {
+    auto line = [program](const std::string& arguments, const char* description) {
+        std::cout << "  " << std::left << std::setw(58) << (std::string(program) + arguments) << description << "\n";
+    };
+
+    std::cout << "Vivid - Digital Vibrance Control\n\n";
+    std::cout << "USAGE:\n";
+    if (withGui) line("", "Launch GUI");
+    line(" --list", "List displays");
+    line(" --set <display> <value>", "Set vibrance (-100 to 100)");
+    line(" --reset", "Reset all displays");
+    line(" --daemon [--stats-every <sec>]", "Run the session daemon");
+    line(" --stats", "Show the daemon's apply latency and counters");
+    line(" --ddc-list", "List DDC/CI monitors and their saturation");
+    line(" --ddc-saturation <monitor> <percent>", "Set a monitor's own saturation (0 to 200)");
+    line(" --profiles", "List profiles; * marks the active one");
+    line(" --profile-show <name>", "Show one profile");
+    line(" --profile-save <name> <exe> [<display>=<n>...]", "Add or replace a profile");
+    line(" --profile-apply <name>", "Switch to a profile now");
+    line(" --profile-delete <name>", "Delete a profile");
+    line(" --help", "Show this help");
+    std::cout << "\nEXAMPLES:\n";
+    line(" --set HDMI-A-1 50", "Set HDMI display to 50");
+    line(" --reset", "Reset all to 0");
+    line(" --profile-save game wine64 DP-1=60", "Raise DP-1 to 60 while wine64 has focus");
+}
+
+int runCliCommand(int argc, char* argv[], bool withGui) {
+    const char* program = withGui ? "vivid" : "vivid-cli";
+    if (argc < 2) {
+        printCliHelp(program, withGui);
+        return 1;
+    }
+
+    std::string command = argv[1];
+    if (command == "--help" || command == "-h") {
+        printCliHelp(program, withGui);
+        return 0;
+    }
+
+    if (command == "--daemon") {
+        int statsSeconds = 0;
+        if (argc >= 4 && std::string(argv[2]) == "--stats-every") {
+            statsSeconds = std::max(0, std::atoi(argv[3]));
+        }
+        return runDaemon(statsSeconds);
+    }
+
+    // Before anything connects to the daemon or opens a display
+    if (!isDisplayCommand(command) && !isProfileCommand(command)) {
+        std::cout << "Unknown command. Use --help for usage.\n";
+        return 1;
+    }
+
+    // Checked before either path, so a bad number is a usage error on both
+    int value = 0;
+    if (command == "--set" && (argc < 4 || !parseVibrance(argv[3], value))) {
+        std::cerr << "vivid: --set needs a display and a whole number from -100 to 100\n\n";
+        printCliHelp(program, withGui);
+        return 1;
+    }
+    if (command == "--ddc-saturation" && (argc < 4 || !parseSaturation(argv[3], value))) {
+        std::cerr << "vivid: --ddc-saturation needs a monitor and a whole percentage from 0 to 200\n\n";
+        printCliHelp(program, withGui);
+        return 1;
+    }
+
+    AppProfile profile;
+    if (command == "--profile-save" && !parseProfile(argc, argv, profile)) {
+        std::cerr << "vivid: --profile-save needs a name, an executable and <display>=<value> pairs "
+                     "with whole numbers from -100 to 100\n\n";
+        printCliHelp(program, withGui);
+        return 1;
+    }
+    if ((command == "--profile-show" || command == "--profile-apply" || command == "--profile-delete") &&
+        argc < 3) {
+        std::cerr << "vivid: " << command << " needs a profile name\n\n";
+        printCliHelp(program, withGui);
+        return 1;
+    }
+
+    // The daemon owns gamma when it runs; going through it keeps its state right
+    IpcClient client;
+    int status = 1;
+    if (runRemote(client, command, argv, value, profile, status)) {
+        return status;
+    }
+
+    // The numbers and the profiles live in the long-running process; a fresh one has neither
+    if (command == "--stats" || isProfileCommand(command)) {
+        std::cerr << "vivid: no daemon running; start one with vivid --daemon\n";
+        return 1;
+    }
+
+    // No daemon: the monitors are probed for this one command. Leaving the scope flushes
+    // the write and saves what was learned to the DDC cache.
+    if (command == "--ddc-list" || command == "--ddc-saturation") {
+        SaturationController monitors(true);
+        if (!monitors.isInitialized()) return 1;
+        std::vector<std::string> names = monitors.getDisplays();
+        if (command == "--ddc-saturation") {
+            return monitors.setSaturation(argv[2], value / 100.0f) ? 0 : 1;
+        }
+        for (const auto& name : names) {
+            std::cout << name << " (" << std::lround(monitors.getSaturation(name) * 100.0f) << "%)\n";
+        }
+        return 0;
+    }
+
+    // No daemon: resolve only what the command needs and leave the result on screen
+    ControllerOptions options;
+    options.oneShot = true;
+    if (command == "--set") {
+        options.targetOutput = argv[2];
+    }
+    VibranceController controller(options);
+
+    if (command == "--list") {
+        DisplaySnapshot displays = controller.getDisplays();
+        for (const auto& display : *displays) {
+            std::cout << display.id << " (" << display.currentVibrance << ")\n";
+        }
+        return 0;
+    }
+
+    if (command == "--set") {
+        return controller.setVibrance(argv[2], value) ? 0 : 1;
+    }
+
+    return controller.resetAllDisplays() ? 0 : 1;
+}
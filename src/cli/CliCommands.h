@@ -0,0 +1,9 @@
+#pragma once
+
+// The command-line entry points shared by vivid-cli and the GUI binary. Nothing here
+// touches GTK, so vivid-cli starts without loading it.
+
+void printCliHelp(const char* program, bool withGui);
+
+// Runs argv[1] as a command and returns the exit status
+int runCliCommand(int argc, char* argv[], bool withGui);
@@ -89,15 +89,15 @@ void CommandLineInterface::printVersion() {
 }
 
 void CommandLineInterface::listDisplays() {
-    auto displays = m_manager->getDisplays();
+    VividDisplaySnapshot displays = m_manager->getDisplays();
     
-    if (displays.empty()) {
+    if (displays->empty()) {
         std::cout << "No displays found." << std::endl;
         return;
     }
     
     std::cout << "Available displays:" << std::endl;
-    for (const auto& display : displays) {
+    for (const auto& display : *displays) {
         std::cout << "  " << display.id << " (" << display.name << ") - " 
                   << std::fixed << std::setprecision(0) 
                   << display.currentVibrance << std::endl;
@@ -109,12 +109,23 @@ void CommandLineInterface::printStatus() {
     std::cout << "  Method: " << m_manager->getMethodName() << std::endl;
     std::cout << "  Initialized: " << (m_manager->isInitialized() ? "Yes" : "No") << std::endl;
     
-    auto displays = m_manager->getDisplays();
-    std::cout << "  Displays: " << displays.size() << " found" << std::endl;
+    const auto& caps = m_manager->getCapabilities();
+    std::cout << "  Backend: " << caps.backend << " (" << caps.sessionType << " session)" << std::endl;
+    for (const auto& pair : caps.applyLatencyUs) {
+        std::cout << "  Apply latency (" << pair.first << "): " 
+                  << std::fixed << std::setprecision(0) << pair.second << " us" << std::endl;
+    }
+    
+    auto cache = m_manager->getRampCacheStats();
+    std::cout << "  Ramp cache: " << cache.ramps << " ramps, "
+              << (cache.bytes / 1024) << " / " << (cache.byteBudget / 1024) << " KiB" << std::endl;
+    
+    VividDisplaySnapshot displays = m_manager->getDisplays();
+    std::cout << "  Displays: " << displays->size() << " found" << std::endl;
     
-    if (!displays.empty()) {
+    if (!displays->empty()) {
         std::cout << "  Current vibrance settings:" << std::endl;
-        for (const auto& display : displays) {
+        for (const auto& display : *displays) {
             std::cout << "    " << display.id << ": " 
                       << std::fixed << std::setprecision(0) 
                       << display.currentVibrance << std::endl;
@@ -0,0 +1,14 @@
+#include "CliCommands.h"
+
+#ifdef HAVE_X11
+#include <X11/Xlib.h>
+#endif
+
+// vivid-cli: the commands of vivid without the GTK window, for scripts and hotkeys
+int main(int argc, char* argv[]) {
+#ifdef HAVE_X11
+    // The daemon talks to X from several threads, one connection each; must come first
+    XInitThreads();
+#endif
+    return runCliCommand(argc, argv, false);
+}
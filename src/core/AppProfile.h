@@ -0,0 +1,12 @@
+#pragma once
+#include <map>
+#include <string>
+
+struct AppProfile {
+    std::string name;
+    std::string executable;   // name or path; with pathMatching, a directory/path prefix
+    std::string windowTitle;  // substring of the window title
+    std::map<std::string, float> displayVibrance;
+    bool pathMatching = false;
+    bool enabled = true;
+};
@@ -0,0 +1,86 @@
+#include "ApplyWorker.h"
+#include "Metrics.h"
+
+ApplyWorker::ApplyWorker(ApplyFunction apply, CompletionFunction completion)
+    : m_apply(std::move(apply))
+    , m_completion(std::move(completion)) {
+    m_thread = std::thread(&ApplyWorker::run, this);
+}
+
+ApplyWorker::~ApplyWorker() {
+    stop();
+}
+
+void ApplyWorker::submit(const std::string& displayId, int vibrance) {
+    m_submitted++;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping) {
+            Metrics::count(Counter::SLIDER_DROPPED);
+            return;
+        }
+
+        Mailbox& mailbox = m_mailboxes[displayId];
+        if (mailbox.pending) {
+            // The older value was never applied; it is simply replaced
+            m_coalesced++;
+            Metrics::count(Counter::SLIDER_COALESCED);
+        } else {
+            mailbox.pending = true;
+            m_ready.push_back(displayId);
+        }
+        mailbox.value = vibrance;
+    }
+    m_wakeup.notify_one();
+}
+
+void ApplyWorker::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_stopping) {
+            // Whatever still waits in a mailbox will never reach the screen
+            Metrics::count(Counter::SLIDER_DROPPED, m_ready.size());
+        }
+        m_stopping = true;
+    }
+    m_wakeup.notify_one();
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+ApplyWorker::Stats ApplyWorker::getStats() const {
+    Stats stats;
+    stats.submitted = m_submitted.load();
+    stats.applied = m_applied.load();
+    stats.coalesced = m_coalesced.load();
+    stats.failed = m_failed.load();
+    return stats;
+}
+
+void ApplyWorker::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        m_wakeup.wait(lock, [this]() { return m_stopping || !m_ready.empty(); });
+        if (m_stopping) break;
+
+        // Round-robin over displays so one busy slider cannot starve another
+        std::string displayId = std::move(m_ready.front());
+        m_ready.pop_front();
+
+        Mailbox& mailbox = m_mailboxes[displayId];
+        int vibrance = mailbox.value;
+        mailbox.pending = false;
+
+        lock.unlock();
+        bool success = m_apply(displayId, vibrance);
+        (success ? m_applied : m_failed)++;
+        if (!success) Metrics::count(Counter::SLIDER_FAILED);
+        if (m_completion) {
+            m_completion(displayId, vibrance, success);
+        }
+        lock.lock();
+    }
+}
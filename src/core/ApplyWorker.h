@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Applies vibrance changes on a dedicated thread. Each display has a single-slot
+// mailbox: submitting overwrites any value still waiting, so only the newest
+// target is ever applied and a fast slider drag cannot build up a backlog.
+class ApplyWorker {
+public:
+    using ApplyFunction = std::function<bool(const std::string& displayId, int vibrance)>;
+    // Runs on the worker thread; GUI callers must hop back to their own main loop
+    using CompletionFunction = std::function<void(const std::string& displayId, int vibrance, bool success)>;
+
+    struct Stats {
+        uint64_t submitted = 0;
+        uint64_t applied = 0;
+        uint64_t coalesced = 0;
+        uint64_t failed = 0;
+    };
+
+    ApplyWorker(ApplyFunction apply, CompletionFunction completion);
+    ~ApplyWorker();
+
+    ApplyWorker(const ApplyWorker&) = delete;
+    ApplyWorker& operator=(const ApplyWorker&) = delete;
+
+    // Never waits for the backend; only takes the mailbox lock briefly
+    void submit(const std::string& displayId, int vibrance);
+    void stop();
+    Stats getStats() const;
+
+private:
+    struct Mailbox {
+        int value = 0;
+        bool pending = false;
+    };
+
+    ApplyFunction m_apply;
+    CompletionFunction m_completion;
+
+    std::map<std::string, Mailbox> m_mailboxes;
+    std::deque<std::string> m_ready; // displays with a pending value, oldest first
+    bool m_stopping = false;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::thread m_thread;
+
+    std::atomic<uint64_t> m_submitted{0};
+    std::atomic<uint64_t> m_applied{0};
+    std::atomic<uint64_t> m_coalesced{0};
+    std::atomic<uint64_t> m_failed{0};
+
+    void run();
+};
@@ -1,5 +1,5 @@
 #include "AutostartManager.h"
-#include <iostream>
+#include "Logger.h"
 #include <fstream>
 #include <filesystem>
 #include <cstdlib>
@@ -12,7 +12,7 @@ AutostartManager::AutostartManager()
     , m_startWithProfiles(true)
     , m_delayedStart(3) {
     
-    std::cout << "🚀 AutostartManager initialized" << std::endl;
+    LOG_DEBUG << "🚀 AutostartManager initialized";
 }
 
 AutostartManager::~AutostartManager() = default;
@@ -21,14 +21,14 @@ bool AutostartManager::isEnabled() {
     std::string filePath = getAutostartFilePath();
     bool exists = std::filesystem::exists(filePath);
     
-    std::cout << "🔍 Checking autostart status:" << std::endl;
-    std::cout << "  File path: " << filePath << std::endl;
-    std::cout << "  Exists: " << (exists ? "Yes" : "No") << std::endl;
+    LOG_DEBUG << "🔍 Checking autostart status:";
+    LOG_DEBUG << "  File path: " << filePath;
+    LOG_DEBUG << "  Exists: " << (exists ? "Yes" : "No");
     
     if (exists) {
         // Validate the file is correct
         bool valid = validateDesktopFile();
-        std::cout << "  Valid: " << (valid ? "Yes" : "No") << std::endl;
+        LOG_DEBUG << "  Valid: " << (valid ? "Yes" : "No");
         return valid;
     }
     
@@ -36,61 +36,61 @@ bool AutostartManager::isEnabled() {
 }
 
 bool AutostartManager::enable() {
-    std::cout << "🚀 Enabling autostart..." << std::endl;
+    LOG_INFO << "🚀 Enabling autostart...";
     
     // Step 1: Create autostart directory
     if (!createAutostartDirectory()) {
-        std::cerr << "❌ Failed to create autostart directory" << std::endl;
+        LOG_ERROR << "❌ Failed to create autostart directory";
         return false;
     }
     
     // Step 2: Generate desktop file content
     std::string desktopContent = getDesktopFileContent();
     if (desktopContent.empty()) {
-        std::cerr << "❌ Failed to generate desktop file content" << std::endl;
+        LOG_ERROR << "❌ Failed to generate desktop file content";
         return false;
     }
     
     // Step 3: Write desktop file
     if (!writeDesktopFile(desktopContent)) {
-        std::cerr << "❌ Failed to write desktop file" << std::endl;
+        LOG_ERROR << "❌ Failed to write desktop file";
         return false;
     }
     
     // Step 4: Validate the written file
     if (!validateDesktopFile()) {
-        std::cerr << "❌ Desktop file validation failed" << std::endl;
+        LOG_ERROR << "❌ Desktop file validation failed";
         removeDesktopFile(); // Clean up invalid file
         return false;
     }
     
     // Step 5: Test the autostart file
     if (!testAutostartFile()) {
-        std::cerr << "⚠️ Autostart file test failed (but file was created)" << std::endl;
+        LOG_WARN << "⚠️ Autostart file test failed (but file was created)";
         // Don't return false here - the file might still work
     }
     
-    std::cout << "✅ Autostart enabled successfully!" << std::endl;
-    std::cout << "  File: " << getAutostartFilePath() << std::endl;
+    LOG_INFO << "✅ Autostart enabled successfully!";
+    LOG_INFO << "  File: " << getAutostartFilePath();
     
     return true;
 }
 
 bool AutostartManager::disable() {
-    std::cout << "🛑 Disabling autostart..." << std::endl;
+    LOG_INFO << "🛑 Disabling autostart...";
     
     std::string filePath = getAutostartFilePath();
     
     if (!std::filesystem::exists(filePath)) {
-        std::cout << "ℹ️ Autostart file doesn't exist, nothing to disable" << std::endl;
+        LOG_INFO << "ℹ️ Autostart file doesn't exist, nothing to disable";
         return true;
     }
     
     if (removeDesktopFile()) {
-        std::cout << "✅ Autostart disabled successfully!" << std::endl;
+        LOG_INFO << "✅ Autostart disabled successfully!";
         return true;
     } else {
-        std::cerr << "❌ Failed to remove autostart file" << std::endl;
+        LOG_ERROR << "❌ Failed to remove autostart file";
         return false;
     }
 }
@@ -184,8 +184,8 @@ StartupNotify=false
 StartupWMClass=vivid
 )";
 
-    std::cout << "📝 Generated desktop file content:" << std::endl;
-    std::cout << content << std::endl;
+    LOG_DEBUG << "📝 Generated desktop file content:";
+    LOG_DEBUG << content;
     
     return content;
 }
@@ -193,27 +193,27 @@ StartupWMClass=vivid
 bool AutostartManager::createAutostartDirectory() {
     std::string dirPath = getAutostartDirectory();
     
-    std::cout << "📁 Creating autostart directory: " << dirPath << std::endl;
+    LOG_DEBUG << "📁 Creating autostart directory: " << dirPath;
     
     try {
         if (std::filesystem::exists(dirPath)) {
-            std::cout << "  Directory already exists" << std::endl;
+            LOG_DEBUG << "  Directory already exists";
             return true;
         }
         
         if (std::filesystem::create_directories(dirPath)) {
-            std::cout << "  ✅ Directory created successfully" << std::endl;
+            LOG_DEBUG << "  ✅ Directory created successfully";
             
             // Set proper permissions (755)
             chmod(dirPath.c_str(), S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
             
             return true;
         } else {
-            std::cerr << "  ❌ Failed to create directory" << std::endl;
+            LOG_ERROR << "  ❌ Failed to create directory";
             return false;
         }
     } catch (const std::exception& e) {
-        std::cerr << "  ❌ Exception creating directory: " << e.what() << std::endl;
+        LOG_ERROR << "  ❌ Exception creating directory: " << e.what();
         return false;
     }
 }
@@ -221,12 +221,12 @@ bool AutostartManager::createAutostartDirectory() {
 bool AutostartManager::writeDesktopFile(const std::string& content) {
     std::string filePath = getAutostartFilePath();
     
-    std::cout << "✍️ Writing desktop file: " << filePath << std::endl;
+    LOG_DEBUG << "✍️ Writing desktop file: " << filePath;
     
     try {
         std::ofstream file(filePath);
         if (!file.is_open()) {
-            std::cerr << "  ❌ Failed to open file for writing" << std::endl;
+            LOG_ERROR << "  ❌ Failed to open file for writing";
             return false;
         }
         
@@ -234,18 +234,18 @@ bool AutostartManager::writeDesktopFile(const std::string& content) {
         file.close();
         
         if (file.fail()) {
-            std::cerr << "  ❌ Failed to write file content" << std::endl;
+            LOG_ERROR << "  ❌ Failed to write file content";
             return false;
         }
         
         // Set proper permissions (644)
         chmod(filePath.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
         
-        std::cout << "  ✅ Desktop file written successfully" << std::endl;
+        LOG_DEBUG << "  ✅ Desktop file written successfully";
         return true;
         
     } catch (const std::exception& e) {
-        std::cerr << "  ❌ Exception writing file: " << e.what() << std::endl;
+        LOG_ERROR << "  ❌ Exception writing file: " << e.what();
         return false;
     }
 }
@@ -253,18 +253,18 @@ bool AutostartManager::writeDesktopFile(const std::string& content) {
 bool AutostartManager::removeDesktopFile() {
     std::string filePath = getAutostartFilePath();
     
-    std::cout << "🗑️ Removing desktop file: " << filePath << std::endl;
+    LOG_DEBUG << "🗑️ Removing desktop file: " << filePath;
     
     try {
         if (std::filesystem::remove(filePath)) {
-            std::cout << "  ✅ File removed successfully" << std::endl;
+            LOG_DEBUG << "  ✅ File removed successfully";
             return true;
         } else {
-            std::cerr << "  ❌ Failed to remove file (may not exist)" << std::endl;
+            LOG_WARN << "  ❌ Failed to remove file (may not exist)";
             return false;
         }
     } catch (const std::exception& e) {
-        std::cerr << "  ❌ Exception removing file: " << e.what() << std::endl;
+        LOG_ERROR << "  ❌ Exception removing file: " << e.what();
         return false;
     }
 }
@@ -272,10 +272,10 @@ bool AutostartManager::removeDesktopFile() {
 bool AutostartManager::validateDesktopFile() {
     std::string filePath = getAutostartFilePath();
     
-    std::cout << "🔍 Validating desktop file..." << std::endl;
+    LOG_DEBUG << "🔍 Validating desktop file...";
     
     if (!std::filesystem::exists(filePath)) {
-        std::cout << "  ❌ File doesn't exist" << std::endl;
+        LOG_WARN << "  ❌ File doesn't exist";
         return false;
     }
     
@@ -283,7 +283,7 @@ bool AutostartManager::validateDesktopFile() {
     struct stat fileStat;
     if (stat(filePath.c_str(), &fileStat) == 0) {
         if (!(fileStat.st_mode & S_IRUSR)) {
-            std::cout << "  ❌ File is not readable" << std::endl;
+            LOG_WARN << "  ❌ File is not readable";
             return false;
         }
     }
@@ -291,7 +291,7 @@ bool AutostartManager::validateDesktopFile() {
     // Read and validate content
     std::ifstream file(filePath);
     if (!file.is_open()) {
-        std::cout << "  ❌ Cannot open file for reading" << std::endl;
+        LOG_WARN << "  ❌ Cannot open file for reading";
         return false;
     }
     
@@ -309,7 +309,7 @@ bool AutostartManager::validateDesktopFile() {
     
     for (const auto& field : requiredFields) {
         if (content.find(field) == std::string::npos) {
-            std::cout << "  ❌ Missing required field: " << field << std::endl;
+            LOG_WARN << "  ❌ Missing required field: " << field;
             return false;
         }
     }
@@ -326,17 +326,17 @@ bool AutostartManager::validateDesktopFile() {
                               execLine.substr(0, spacePos) : execLine;
         
         if (!std::filesystem::exists(execPath)) {
-            std::cout << "  ⚠️ Executable doesn't exist: " << execPath << std::endl;
+            LOG_WARN << "  ⚠️ Executable doesn't exist: " << execPath;
             // Don't return false - the path might be in PATH
         }
     }
     
-    std::cout << "  ✅ Desktop file validation passed" << std::endl;
+    LOG_DEBUG << "  ✅ Desktop file validation passed";
     return true;
 }
 
 bool AutostartManager::testAutostartFile() {
-    std::cout << "🧪 Testing autostart file..." << std::endl;
+    LOG_DEBUG << "🧪 Testing autostart file...";
     
     // Test with desktop-file-validate if available
     std::string filePath = getAutostartFilePath();
@@ -352,15 +352,15 @@ bool AutostartManager::testAutostartFile() {
         int exitCode = pclose(pipe);
         
         if (exitCode == 0) {
-            std::cout << "  ✅ Desktop file validation passed" << std::endl;
+            LOG_DEBUG << "  ✅ Desktop file validation passed";
             return true;
         } else {
-            std::cout << "  ⚠️ Desktop file validation warnings:" << std::endl;
-            std::cout << "    " << result << std::endl;
+            LOG_WARN << "  ⚠️ Desktop file validation warnings:";
+            LOG_WARN << "    " << result;
             return false;
         }
     } else {
-        std::cout << "  ℹ️ desktop-file-validate not available, skipping test" << std::endl;
+        LOG_DEBUG << "  ℹ️ desktop-file-validate not available, skipping test";
         return true;
     }
 }
@@ -0,0 +1,340 @@
+#include "CapabilityProbe.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#ifdef HAVE_X11
+#include "../backends/XRandrGammaBackend.h"
+#endif
+
+#ifdef HAVE_DRM
+#include "../backends/DrmAtomicBackend.h"
+#endif
+
+namespace {
+
+const char* const kTools[] = {"xrandr", "xgamma", "xcalib", "ddcutil"};
+
+struct GpuInfo {
+    std::string vendor;
+    bool amdgpuLoaded = false;
+};
+
+struct GammaProbe {
+    std::map<std::string, int> gammaSizes;
+    double applyLatencyUs = 0.0;
+    bool available = false;
+};
+
+// Runs fn on a detached thread; a probe that misses the deadline is abandoned, not joined.
+// Its duration is recorded even then, so a slow probe still shows up in the stats.
+template <typename T, typename Fn>
+std::future<T> launchProbe(const char* name, Fn fn) {
+    auto promise = std::make_shared<std::promise<T>>();
+    std::future<T> future = promise->get_future();
+    std::thread([promise, fn, name]() {
+        LatencyTimer timer;
+        T result = fn();
+        timer.record("probe", name);
+        promise->set_value(std::move(result));
+    }).detach();
+    return future;
+}
+
+template <typename T>
+bool collect(std::future<T>& future, std::chrono::steady_clock::time_point deadline, T& out) {
+    if (future.wait_until(deadline) != std::future_status::ready) {
+        return false;
+    }
+    out = future.get();
+    return true;
+}
+
+std::string readFirstLine(const std::filesystem::path& path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+GpuInfo probeGpu() {
+    GpuInfo info;
+    std::error_code ec;
+    std::vector<std::filesystem::path> cards;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/class/drm", ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("card", 0) == 0 && name.find('-') == std::string::npos) {
+            cards.push_back(entry.path());
+        }
+    }
+    std::sort(cards.begin(), cards.end());
+
+    for (const auto& card : cards) {
+        std::string vendor = readFirstLine(card / "device" / "vendor");
+        if (!vendor.empty()) {
+            info.vendor = vendor;
+            break;
+        }
+    }
+    info.amdgpuLoaded = std::filesystem::exists("/sys/module/amdgpu", ec);
+    return info;
+}
+
+std::map<std::string, bool> probeTools() {
+    std::map<std::string, bool> tools;
+    for (const char* tool : kTools) {
+        tools[tool] = CapabilityProbe::findTool(tool);
+    }
+    return tools;
+}
+
+GammaProbe probeX11Gamma() {
+    GammaProbe result;
+#ifdef HAVE_X11
+    XRandrGammaBackend backend;
+    if (!backend.open()) return result;
+
+    for (const auto& output : backend.getOutputs()) {
+        result.gammaSizes[output] = backend.getGammaSize(output);
+    }
+
+    // Re-upload the ramps already on screen so measuring never changes the picture
+    std::vector<double> samples;
+    for (int i = 0; i < 3; i++) {
+        auto start = std::chrono::steady_clock::now();
+        if (!backend.reapplyCurrent()) break;
+        samples.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    if (!samples.empty()) {
+        std::sort(samples.begin(), samples.end());
+        result.applyLatencyUs = samples[samples.size() / 2];
+        result.available = true;
+    }
+#endif
+    return result;
+}
+
+GammaProbe probeDrmGamma() {
+    GammaProbe result;
+#ifdef HAVE_DRM
+    // Enumeration only; an atomic commit here would change the picture or fight the DRM master
+    auto backend = DrmAtomicBackend::openFirstCapable();
+    if (!backend) return result;
+
+    for (const auto& output : backend->getOutputs()) {
+        result.gammaSizes[output] = backend->getGammaSize(output);
+    }
+    result.available = true;
+#endif
+    return result;
+}
+
+std::string detectSessionType() {
+    if (std::getenv("WAYLAND_DISPLAY")) return "wayland";
+    if (std::getenv("DISPLAY")) return "x11";
+    return "tty";
+}
+
+} // namespace
+
+bool CapabilityManifest::hasTool(const std::string& name) const {
+    auto it = tools.find(name);
+    return it != tools.end() && it->second;
+}
+
+CapabilityProbe::CapabilityProbe(std::chrono::milliseconds deadline)
+    : m_deadline(deadline) {}
+
+bool CapabilityProbe::findTool(const std::string& name) {
+    // Same answer as `which`, without forking a shell
+    const char* path = std::getenv("PATH");
+    if (!path) return false;
+
+    std::stringstream dirs(path);
+    std::string dir;
+    while (std::getline(dirs, dir, ':')) {
+        if (dir.empty()) dir = ".";
+        std::string candidate = dir + "/" + name;
+        if (access(candidate.c_str(), X_OK) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string CapabilityProbe::computeKey() {
+    std::string material = "v1";
+    for (const char* var : {"XDG_SESSION_TYPE", "WAYLAND_DISPLAY", "DISPLAY", "PATH", "VIVID_DRM_DEVICE"}) {
+        const char* value = std::getenv(var);
+        material += "|";
+        material += value ? value : "";
+    }
+
+    // Connector list and state from sysfs: cheap, and changes on hotplug
+    std::error_code ec;
+    std::vector<std::string> connectors;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/class/drm", ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.find('-') != std::string::npos) {
+            connectors.push_back(name + "=" + readFirstLine(entry.path() / "status"));
+        }
+    }
+    std::sort(connectors.begin(), connectors.end());
+    for (const auto& connector : connectors) {
+        material += "|" + connector;
+    }
+
+    uint64_t hash = 1469598103934665603ULL; // FNV-1a
+    for (unsigned char c : material) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+    return buffer;
+}
+
+std::string CapabilityProbe::getManifestPath() {
+    const char* home = std::getenv("HOME");
+    return std::string(home ? home : ".") + "/.config/vivid/capabilities.conf";
+}
+
+CapabilityManifest CapabilityProbe::load() {
+    LatencyTimer timer;
+    std::string key = computeKey();
+    std::string path = getManifestPath();
+
+    CapabilityManifest cached;
+    if (readManifest(path, cached) && cached.key == key && !cached.probeTimedOut) {
+        timer.record("probe", "cached");
+        return cached;
+    }
+
+    CapabilityManifest manifest = probe();
+    writeManifest(path, manifest);
+    timer.record("probe", "full");
+    return manifest;
+}
+
+CapabilityManifest CapabilityProbe::probe() {
+    CapabilityManifest manifest;
+    manifest.key = computeKey();
+    manifest.sessionType = detectSessionType();
+
+    auto deadline = std::chrono::steady_clock::now() + m_deadline;
+
+    // Independent probes run concurrently; the slowest one bounds startup, not their sum
+    auto gpuFuture = launchProbe<GpuInfo>("gpu", probeGpu);
+    auto toolsFuture = launchProbe<std::map<std::string, bool>>("tools", probeTools);
+    std::future<GammaProbe> gammaFuture;
+    if (manifest.sessionType == "x11") {
+        gammaFuture = launchProbe<GammaProbe>("x11-gamma", probeX11Gamma);
+    } else if (manifest.sessionType == "tty") {
+        gammaFuture = launchProbe<GammaProbe>("drm-gamma", probeDrmGamma);
+    }
+
+    GpuInfo gpu;
+    if (collect(gpuFuture, deadline, gpu)) {
+        manifest.gpuVendor = gpu.vendor;
+        manifest.amdgpuLoaded = gpu.amdgpuLoaded;
+    } else {
+        manifest.probeTimedOut = true;
+    }
+
+    if (!collect(toolsFuture, deadline, manifest.tools)) {
+        manifest.probeTimedOut = true;
+    }
+
+    GammaProbe gamma;
+    if (gammaFuture.valid()) {
+        if (collect(gammaFuture, deadline, gamma)) {
+            manifest.gammaSizes = gamma.gammaSizes;
+            if (gamma.available && manifest.sessionType == "x11") {
+                manifest.applyLatencyUs["xrandr-gamma"] = gamma.applyLatencyUs;
+            }
+        } else {
+            manifest.probeTimedOut = true;
+        }
+    }
+
+    if (manifest.sessionType == "x11" && gamma.available) {
+        manifest.backend = "xrandr-gamma";
+    } else if (manifest.sessionType == "x11" && manifest.hasTool("xrandr")) {
+        manifest.backend = "xrandr-tool";
+    } else if (manifest.sessionType == "tty" && gamma.available) {
+        manifest.backend = "drm-atomic";
+    } else {
+        manifest.backend = "none";
+    }
+
+    return manifest;
+}
+
+bool CapabilityProbe::readManifest(const std::string& path, CapabilityManifest& manifest) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t eq = line.find('=');
+        if (eq == std::string::npos || line[0] == '#') continue;
+
+        std::string name = line.substr(0, eq);
+        std::string value = line.substr(eq + 1);
+
+        if (name == "key") manifest.key = value;
+        else if (name == "session") manifest.sessionType = value;
+        else if (name == "backend") manifest.backend = value;
+        else if (name == "gpu_vendor") manifest.gpuVendor = value;
+        else if (name == "amdgpu") manifest.amdgpuLoaded = (value == "1");
+        else if (name == "timed_out") manifest.probeTimedOut = (value == "1");
+        else if (name.rfind("tool.", 0) == 0) manifest.tools[name.substr(5)] = (value == "1");
+        else if (name.rfind("gamma.", 0) == 0) manifest.gammaSizes[name.substr(6)] = std::atoi(value.c_str());
+        else if (name.rfind("latency_us.", 0) == 0) manifest.applyLatencyUs[name.substr(11)] = std::atof(value.c_str());
+    }
+    return !manifest.key.empty();
+}
+
+bool CapabilityProbe::writeManifest(const std::string& path, const CapabilityManifest& manifest) {
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+    // Write then rename so a crash never leaves a truncated manifest behind
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::trunc);
+        if (!file.is_open()) return false;
+
+        file << "# Generated by vivid; deleted or stale entries are re-probed\n";
+        file << "key=" << manifest.key << "\n";
+        file << "session=" << manifest.sessionType << "\n";
+        file << "backend=" << manifest.backend << "\n";
+        file << "gpu_vendor=" << manifest.gpuVendor << "\n";
+        file << "amdgpu=" << (manifest.amdgpuLoaded ? 1 : 0) << "\n";
+        file << "timed_out=" << (manifest.probeTimedOut ? 1 : 0) << "\n";
+        for (const auto& pair : manifest.tools) {
+            file << "tool." << pair.first << "=" << (pair.second ? 1 : 0) << "\n";
+        }
+        for (const auto& pair : manifest.gammaSizes) {
+            file << "gamma." << pair.first << "=" << pair.second << "\n";
+        }
+        for (const auto& pair : manifest.applyLatencyUs) {
+            file << "latency_us." << pair.first << "=" << pair.second << "\n";
+        }
+        if (!file) return false;
+    }
+
+    std::filesystem::rename(tempPath, path, ec);
+    return !ec;
+}
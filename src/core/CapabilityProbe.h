@@ -0,0 +1,38 @@
+#pragma once
+#include <chrono>
+#include <map>
+#include <string>
+
+// Result of probing the session once; persisted and reused while the key matches
+struct CapabilityManifest {
+    std::string key;
+    std::string sessionType;                     // x11, wayland or tty
+    std::string backend;                         // xrandr-gamma, xrandr-tool, drm-atomic or none
+    std::string gpuVendor;                       // PCI vendor of the first DRM card with one
+    bool amdgpuLoaded = false;
+    bool probeTimedOut = false;
+    std::map<std::string, bool> tools;           // helper tool -> found in PATH
+    std::map<std::string, int> gammaSizes;       // output -> CRTC gamma size
+    std::map<std::string, double> applyLatencyUs; // backend -> measured apply latency
+
+    bool hasTool(const std::string& name) const;
+};
+
+class CapabilityProbe {
+public:
+    explicit CapabilityProbe(std::chrono::milliseconds deadline = std::chrono::milliseconds(2000));
+
+    // Cached manifest when the session/topology key is unchanged, fresh probe otherwise
+    CapabilityManifest load();
+    CapabilityManifest probe();
+
+    static std::string computeKey();
+    static bool findTool(const std::string& name);
+    static std::string getManifestPath();
+
+private:
+    std::chrono::milliseconds m_deadline;
+
+    bool readManifest(const std::string& path, CapabilityManifest& manifest);
+    bool writeManifest(const std::string& path, const CapabilityManifest& manifest);
+};
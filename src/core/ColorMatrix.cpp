@@ -0,0 +1,28 @@
+#include "ColorMatrix.h"
+#include <algorithm>
+
+namespace {
+
+struct CtmTable {
+    Ctm levels[201];
+};
+
+constexpr CtmTable buildCtmTable() {
+    CtmTable table{};
+    for (int level = -100; level <= 100; level++) {
+        table.levels[level + 100] = toCtm(vibranceToColorMatrix(level));
+    }
+    return table;
+}
+
+constexpr CtmTable kVibranceCtms = buildCtmTable();
+
+static_assert(kVibranceCtms.levels[100].isIdentity(), "level 0 must be identity");
+static_assert(kVibranceCtms.levels[0].m[1] == toS31_32(0.7152), "level -100 must be greyscale");
+
+} // namespace
+
+const Ctm& vibranceToCtm(int vibrance) {
+    vibrance = std::max(-100, std::min(100, vibrance));
+    return kVibranceCtms.levels[vibrance + 100];
+}
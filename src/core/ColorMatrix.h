@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+
+// Row-major 3x3 transform on linear RGB: out = m * in
+struct ColorMatrix {
+    double m[9] = {1.0, 0.0, 0.0,
+                   0.0, 1.0, 0.0,
+                   0.0, 0.0, 1.0};
+};
+
+// Kernel CTM layout (struct drm_color_ctm and the RandR "CTM" property): sign-magnitude S31.32
+struct Ctm {
+    uint64_t m[9] = {1ULL << 32, 0, 0,
+                     0, 1ULL << 32, 0,
+                     0, 0, 1ULL << 32};
+
+    constexpr bool isIdentity() const { return *this == Ctm(); }
+    constexpr bool operator==(const Ctm& other) const {
+        for (int i = 0; i < 9; i++) {
+            if (m[i] != other.m[i]) return false;
+        }
+        return true;
+    }
+    constexpr bool operator!=(const Ctm& other) const { return !(*this == other); }
+};
+
+// Luminance-preserving saturation with Rec.709 weights; 1.0 is identity, 0.0 is greyscale.
+// Rows sum to 1, so greys stay grey.
+constexpr ColorMatrix saturationMatrix(double saturation) {
+    const double lr = 0.2126, lg = 0.7152, lb = 0.0722;
+    const double s = saturation;
+
+    ColorMatrix matrix;
+    matrix.m[0] = lr + (1.0 - lr) * s;
+    matrix.m[1] = lg * (1.0 - s);
+    matrix.m[2] = lb * (1.0 - s);
+    matrix.m[3] = lr * (1.0 - s);
+    matrix.m[4] = lg + (1.0 - lg) * s;
+    matrix.m[5] = lb * (1.0 - s);
+    matrix.m[6] = lr * (1.0 - s);
+    matrix.m[7] = lg * (1.0 - s);
+    matrix.m[8] = lb + (1.0 - lb) * s;
+    return matrix;
+}
+
+// Magnitude rounds to nearest and saturates past the 31-bit integer range
+constexpr uint64_t toS31_32(double value) {
+    uint64_t sign = 0;
+    if (value < 0.0) {
+        sign = 1ULL << 63;
+        value = -value;
+    }
+    if (value > 2147483647.0) value = 2147483647.0;
+    return sign | static_cast<uint64_t>(value * 4294967296.0 + 0.5);
+}
+
+constexpr Ctm toCtm(const ColorMatrix& matrix) {
+    Ctm ctm;
+    for (int i = 0; i < 9; i++) {
+        ctm.m[i] = toS31_32(matrix.m[i]);
+    }
+    return ctm;
+}
+
+// Vibrance -100..100 as a saturation matrix (0 is identity, 100 doubles saturation)
+constexpr ColorMatrix vibranceToColorMatrix(int vibrance) {
+    vibrance = vibrance < -100 ? -100 : (vibrance > 100 ? 100 : vibrance);
+    return saturationMatrix(1.0 + vibrance / 100.0);
+}
+
+// Table lookup into the 201 levels computed at compile time; an apply only uploads
+const Ctm& vibranceToCtm(int vibrance);
@@ -0,0 +1,125 @@
+#include "ConfigWatcher.h"
+#include <cerrno>
+#include <filesystem>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace {
+
+// Quiet period that ends a burst, and the longest a burst may delay the callback
+const int kSettleMs = 50;
+const int kMaxDelayMs = 500;
+
+} // namespace
+
+ConfigWatcher::ConfigWatcher(std::string directory, std::set<std::string> files, ChangeCallback callback)
+    : m_directory(std::move(directory))
+    , m_files(std::move(files))
+    , m_callback(std::move(callback)) {}
+
+ConfigWatcher::~ConfigWatcher() {
+    stop();
+}
+
+bool ConfigWatcher::start() {
+    if (isRunning()) return true;
+
+    // The directory may not exist before the first save; watching needs it now
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd < 0) return false;
+
+    // IN_CLOSE_WRITE and IN_MOVED_TO cover whole-file writes and write-rename saves;
+    // IN_MODIFY catches appends from writers that keep the file open
+    uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MODIFY | IN_DELETE | IN_MOVED_FROM | IN_ONLYDIR;
+    m_stopFd = eventfd(0, EFD_CLOEXEC);
+    if (m_stopFd < 0 || inotify_add_watch(m_inotifyFd, m_directory.c_str(), mask) < 0) {
+        stop();
+        return false;
+    }
+
+    m_thread = std::thread(&ConfigWatcher::run, this);
+    return true;
+}
+
+void ConfigWatcher::stop() {
+    if (m_thread.joinable()) {
+        uint64_t one = 1;
+        ssize_t written = write(m_stopFd, &one, sizeof(one));
+        (void)written;
+        m_thread.join();
+    }
+    if (m_inotifyFd >= 0) {
+        close(m_inotifyFd);
+        m_inotifyFd = -1;
+    }
+    if (m_stopFd >= 0) {
+        close(m_stopFd);
+        m_stopFd = -1;
+    }
+}
+
+bool ConfigWatcher::drain(std::set<std::string>& changed) {
+    alignas(inotify_event) char buffer[4096];
+    bool overflow = false;
+
+    while (true) {
+        ssize_t length = read(m_inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            if (length < 0 && errno == EINTR) continue;
+            return !overflow;  // EAGAIN: drained
+        }
+
+        for (char* cursor = buffer; cursor < buffer + length;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(cursor);
+            cursor += sizeof(inotify_event) + event->len;
+            m_events++;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                overflow = true;
+            } else if (event->len > 0 && m_files.count(event->name) != 0) {
+                changed.insert(event->name);
+            }
+        }
+    }
+}
+
+void ConfigWatcher::run() {
+    struct pollfd fds[2];
+    fds[0].fd = m_inotifyFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = m_stopFd;
+    fds[1].events = POLLIN;
+
+    std::set<std::string> changed;
+    int waitedMs = 0;
+    while (true) {
+        // Block until something happens; once a burst has started, wait only for it to settle
+        int timeout = changed.empty() ? -1 : kSettleMs;
+        int ready = poll(fds, 2, timeout);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (fds[1].revents & POLLIN) return;
+
+        if (ready > 0 && (fds[0].revents & POLLIN)) {
+            // Lost events could have touched anything we watch
+            if (!drain(changed)) changed = m_files;
+            if (changed.empty()) continue;
+
+            waitedMs += kSettleMs;
+            if (waitedMs < kMaxDelayMs) continue;
+        }
+
+        if (!changed.empty()) {
+            m_callback(changed);
+            changed.clear();
+        }
+        waitedMs = 0;
+    }
+}
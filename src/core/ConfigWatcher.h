@@ -0,0 +1,41 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <string>
+#include <thread>
+
+// inotify on the config directory rather than on the files themselves: editors and sync
+// tools replace files by writing a temporary and renaming it over the original, which
+// would silently orphan a per-file watch. Events for files outside the watched set
+// (editor swap files, sync temporaries) are dropped. A burst, such as a rename followed
+// by a metadata update, is debounced into one callback naming every file that changed.
+class ConfigWatcher {
+public:
+    using ChangeCallback = std::function<void(const std::set<std::string>& files)>;
+
+    ConfigWatcher(std::string directory, std::set<std::string> files, ChangeCallback callback);
+    ~ConfigWatcher();
+
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+    bool start();
+    void stop();
+    bool isRunning() const { return m_thread.joinable(); }
+    uint64_t getEventCount() const { return m_events.load(); }
+
+private:
+    std::string m_directory;
+    std::set<std::string> m_files;
+    ChangeCallback m_callback;
+    int m_inotifyFd = -1;
+    int m_stopFd = -1;
+    std::thread m_thread;
+    std::atomic<uint64_t> m_events{0};
+
+    void run();
+    // Adds watched names from pending events to changed; false on queue overflow
+    bool drain(std::set<std::string>& changed);
+};
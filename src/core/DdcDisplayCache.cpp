@@ -0,0 +1,169 @@
+#include "DdcDisplayCache.h"
+#include "Logger.h"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+// monitor.<hash>.<field>
+bool splitMonitorKey(const std::string& name, std::string& hash, std::string& field) {
+    const std::string prefix = "monitor.";
+    if (name.rfind(prefix, 0) != 0) return false;
+    size_t dot = name.find('.', prefix.size());
+    if (dot == std::string::npos) return false;
+    hash = name.substr(prefix.size(), dot - prefix.size());
+    field = name.substr(dot + 1);
+    return true;
+}
+
+std::string hexByte(uint8_t value) {
+    char buffer[3];
+    std::snprintf(buffer, sizeof(buffer), "%02X", value);
+    return buffer;
+}
+
+} // namespace
+
+DdcDisplayCache::DdcDisplayCache(const std::string& path) : m_path(path) {}
+
+std::string DdcDisplayCache::getCachePath() {
+    const char* home = std::getenv("HOME");
+    return std::string(home ? home : ".") + "/.config/vivid/ddc-cache.conf";
+}
+
+std::string DdcDisplayCache::hashEdid(const std::vector<uint8_t>& edid) {
+    uint64_t hash = 1469598103934665603ULL; // FNV-1a
+    for (uint8_t byte : edid) {
+        hash ^= byte;
+        hash *= 1099511628211ULL;
+    }
+
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+    return buffer;
+}
+
+bool DdcDisplayCache::load() {
+    std::ifstream file(m_path);
+    if (!file.is_open()) return false;
+
+    m_buses.clear();
+    m_monitors.clear();
+
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t eq = line.find('=');
+        if (eq == std::string::npos || line[0] == '#') continue;
+
+        std::string name = line.substr(0, eq);
+        std::string value = line.substr(eq + 1);
+        std::string hash, field;
+
+        if (name.rfind("bus.", 0) == 0) {
+            m_buses[name.substr(4)] = value;
+        } else if (splitMonitorKey(name, hash, field)) {
+            DdcMonitorRecord& record = m_monitors[hash];
+            if (field == "capabilities") {
+                record.capabilities = value;
+                parseCapabilities(value, record.parsed);
+            } else if (field.rfind("vcp.", 0) == 0) {
+                // vcp.8A=current/maximum
+                VcpValue vcp;
+                size_t slash = value.find('/');
+                if (slash == std::string::npos) continue;
+                vcp.current = static_cast<uint16_t>(std::atoi(value.c_str()));
+                vcp.maximum = static_cast<uint16_t>(std::atoi(value.c_str() + slash + 1));
+                record.values[static_cast<uint8_t>(std::strtoul(field.c_str() + 4, nullptr, 16))] = vcp;
+            }
+        }
+    }
+    m_dirty = false;
+    return true;
+}
+
+bool DdcDisplayCache::save() {
+    if (!m_dirty) return true;
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(m_path).parent_path(), ec);
+
+    // Write then rename so a crash never leaves a truncated cache behind
+    std::string tempPath = m_path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::trunc);
+        if (!file.is_open()) return false;
+
+        file << "# Generated by vivid; a monitor whose EDID is not listed here is detected again\n";
+        for (const auto& bus : m_buses) {
+            file << "bus." << bus.first << "=" << bus.second << "\n";
+        }
+        for (const auto& monitor : m_monitors) {
+            const std::string prefix = "monitor." + monitor.first + ".";
+            file << prefix << "capabilities=" << monitor.second.capabilities << "\n";
+            for (const auto& value : monitor.second.values) {
+                file << prefix << "vcp." << hexByte(value.first) << "="
+                     << value.second.current << "/" << value.second.maximum << "\n";
+            }
+        }
+        if (!file) return false;
+    }
+
+    std::filesystem::rename(tempPath, m_path, ec);
+    if (ec) return false;
+    m_dirty = false;
+    return true;
+}
+
+DdcMonitorRecord* DdcDisplayCache::resolve(const std::string& devicePath, const std::vector<uint8_t>& edid, DdcCi& ddc) {
+    std::string hash = hashEdid(edid);
+    if (m_buses[devicePath] != hash) {
+        m_buses[devicePath] = hash;
+        m_dirty = true;
+    }
+
+    auto known = m_monitors.find(hash);
+    if (known != m_monitors.end()) {
+        return &known->second;
+    }
+
+    // New EDID: the probe ddcutil detect uses, then the capabilities string. A monitor
+    // that does not answer is not remembered, so a transient failure is retried next time.
+    m_detections++;
+    DdcMonitorRecord record;
+    VcpValue brightness;
+    if (!ddc.getVcp(VcpCode::BRIGHTNESS, brightness)) {
+        return nullptr;
+    }
+    record.values[static_cast<uint8_t>(VcpCode::BRIGHTNESS)] = brightness;
+    if (ddc.getCapabilities(record.capabilities)) {
+        parseCapabilities(record.capabilities, record.parsed);
+    }
+    LOG_INFO << "  Detected DDC/CI monitor " << (record.parsed.model.empty() ? hash : record.parsed.model)
+             << " on " << devicePath << " (" << record.parsed.features.size() << " features)";
+
+    m_dirty = true;
+    return &m_monitors.emplace(hash, std::move(record)).first->second;
+}
+
+DdcMonitorRecord* DdcDisplayCache::findMonitor(const std::string& edidHash) {
+    auto it = m_monitors.find(edidHash);
+    return (it != m_monitors.end()) ? &it->second : nullptr;
+}
+
+std::string DdcDisplayCache::getBusEdid(const std::string& devicePath) const {
+    auto it = m_buses.find(devicePath);
+    return (it != m_buses.end()) ? it->second : "";
+}
+
+void DdcDisplayCache::recordValue(const std::string& edidHash, VcpCode code, const VcpValue& value) {
+    DdcMonitorRecord* record = findMonitor(edidHash);
+    if (!record) return;
+
+    VcpValue& stored = record->values[static_cast<uint8_t>(code)];
+    if (stored.current != value.current || stored.maximum != value.maximum) {
+        stored = value;
+        m_dirty = true;
+    }
+}
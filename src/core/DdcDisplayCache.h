@@ -0,0 +1,54 @@
+#pragma once
+#include "../backends/DdcCi.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// What vivid knows about one DDC/CI monitor
+struct DdcMonitorRecord {
+    std::string capabilities;            // as the monitor sent it; empty if it would not
+    DdcCapabilities parsed;              // rebuilt from capabilities on load
+    std::map<uint8_t, VcpValue> values;  // last-known VCP values
+
+    // Unknown capabilities allow anything; a parsed list is taken at its word
+    bool allows(VcpCode code) const { return parsed.features.empty() || parsed.supports(code); }
+    // Zero maximum when never read
+    VcpValue getValue(VcpCode code) const {
+        auto it = values.find(static_cast<uint8_t>(code));
+        return (it != values.end()) ? it->second : VcpValue();
+    }
+};
+
+// Monitors keyed by EDID hash, and which bus each was last seen on, persisted so a
+// start only re-reads EDIDs. The DDC/CI probe and the capabilities read, seconds of bus
+// time, run only for an EDID the cache has never seen.
+class DdcDisplayCache {
+public:
+    explicit DdcDisplayCache(const std::string& path = getCachePath());
+
+    bool load();
+    // Writes only when something changed since load or the last save
+    bool save();
+
+    // The record for the monitor with this EDID on devicePath, detecting it first when
+    // the EDID is new; nullptr when the monitor does not answer DDC/CI
+    DdcMonitorRecord* resolve(const std::string& devicePath, const std::vector<uint8_t>& edid, DdcCi& ddc);
+
+    DdcMonitorRecord* findMonitor(const std::string& edidHash);
+    std::string getBusEdid(const std::string& devicePath) const;
+    void recordValue(const std::string& edidHash, VcpCode code, const VcpValue& value);
+
+    size_t getMonitorCount() const { return m_monitors.size(); }
+    uint64_t getDetectionCount() const { return m_detections; }
+
+    static std::string hashEdid(const std::vector<uint8_t>& edid);
+    static std::string getCachePath();
+
+private:
+    std::string m_path;
+    std::map<std::string, std::string> m_buses;          // device path -> EDID hash
+    std::map<std::string, DdcMonitorRecord> m_monitors;  // EDID hash -> record
+    bool m_dirty = false;
+    uint64_t m_detections = 0;
+};
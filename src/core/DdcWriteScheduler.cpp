@@ -0,0 +1,166 @@
+#include "DdcWriteScheduler.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include <cstdlib>
+
+DdcWriteScheduler::DdcWriteScheduler(std::chrono::milliseconds minInterval) : m_minInterval(minInterval) {}
+
+DdcWriteScheduler::~DdcWriteScheduler() {
+    stop();
+}
+
+std::chrono::milliseconds DdcWriteScheduler::getConfiguredInterval() {
+    const char* value = std::getenv("VIVID_DDC_WRITE_INTERVAL");
+    if (value) {
+        char* end = nullptr;
+        long ms = std::strtol(value, &end, 10);
+        if (end != value && *end == '\0' && ms >= 0) return std::chrono::milliseconds(ms);
+    }
+    return std::chrono::milliseconds(200);
+}
+
+void DdcWriteScheduler::addMonitor(const std::string& monitor, DdcCi* ddc) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stopped) return;
+
+    std::unique_ptr<Bus>& bus = m_buses[ddc->path()];
+    if (!bus) {
+        bus = std::make_unique<Bus>();
+        bus->ddc = ddc;
+        bus->thread = std::thread(&DdcWriteScheduler::run, this, bus.get());
+    }
+
+    // One monitor answers at 0x37 on a bus; a new name for the bus replaces the old one
+    for (auto it = m_monitors.begin(); it != m_monitors.end();) {
+        it = (it->second == bus.get() && it->first != monitor) ? m_monitors.erase(it) : std::next(it);
+    }
+    {
+        std::lock_guard<std::mutex> busLock(bus->mutex);
+        bus->monitor = monitor;
+    }
+    m_monitors[monitor] = bus.get();
+}
+
+DdcWriteScheduler::Bus* DdcWriteScheduler::findBus(const std::string& monitor) const {
+    auto it = m_monitors.find(monitor);
+    return (it != m_monitors.end()) ? it->second : nullptr;
+}
+
+bool DdcWriteScheduler::submit(const std::string& monitor, VcpCode code, uint16_t value) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Bus* bus = findBus(monitor);
+    if (m_stopped || !bus) return false;
+
+    {
+        std::lock_guard<std::mutex> busLock(bus->mutex);
+        bus->stats.submitted++;
+
+        Mailbox& mailbox = bus->mailboxes[static_cast<uint8_t>(code)];
+        mailbox.submittedAt = std::chrono::steady_clock::now();
+        if (mailbox.pending) {
+            // The older value was never written; it is simply replaced
+            mailbox.value = value;
+            bus->stats.coalesced++;
+            Metrics::count(Counter::DDC_COALESCED);
+            return true;
+        }
+        if (mailbox.written && mailbox.lastWritten == value) {
+            // Already on the monitor, or on its way there; another write would only wear it
+            bus->stats.coalesced++;
+            Metrics::count(Counter::DDC_COALESCED);
+            return true;
+        }
+        mailbox.value = value;
+        mailbox.pending = true;
+        bus->pending++;
+    }
+    bus->wakeup.notify_one();
+    return true;
+}
+
+void DdcWriteScheduler::flush() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& entry : m_buses) {
+        Bus& bus = *entry.second;
+        std::unique_lock<std::mutex> busLock(bus.mutex);
+        bus.idle.wait(busLock, [&bus]() { return bus.pending == 0 && !bus.busy; });
+    }
+}
+
+void DdcWriteScheduler::stop() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopped = true;
+    for (auto& entry : m_buses) {
+        {
+            std::lock_guard<std::mutex> busLock(entry.second->mutex);
+            entry.second->stopping = true;
+        }
+        entry.second->wakeup.notify_one();
+    }
+    // The threads never take m_mutex, so joining under it cannot deadlock
+    for (auto& entry : m_buses) {
+        if (entry.second->thread.joinable()) {
+            entry.second->thread.join();
+        }
+    }
+}
+
+DdcWriteScheduler::Stats DdcWriteScheduler::getStats(const std::string& monitor) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Bus* bus = findBus(monitor);
+    if (!bus) return Stats();
+    std::lock_guard<std::mutex> busLock(bus->mutex);
+    return bus->stats;
+}
+
+void DdcWriteScheduler::run(Bus* bus) {
+    std::unique_lock<std::mutex> lock(bus->mutex);
+
+    while (true) {
+        if (bus->pending == 0) {
+            bus->idle.notify_all();
+            if (bus->stopping) break;
+            bus->wakeup.wait(lock, [bus]() { return bus->stopping || bus->pending > 0; });
+            continue;
+        }
+
+        // The waiting code whose interval ends first; on stop, everything goes out now
+        uint8_t code = 0;
+        Mailbox* due = nullptr;
+        for (auto& entry : bus->mailboxes) {
+            if (entry.second.pending && (!due || entry.second.nextWrite < due->nextWrite)) {
+                code = entry.first;
+                due = &entry.second;
+            }
+        }
+        if (!bus->stopping && due->nextWrite > std::chrono::steady_clock::now()) {
+            // Woken early by a submit, which may have made another code due sooner
+            bus->wakeup.wait_until(lock, due->nextWrite);
+            continue;
+        }
+
+        uint16_t value = due->value;
+        std::chrono::steady_clock::time_point submittedAt = due->submittedAt;
+        due->pending = false;
+        due->written = true;
+        due->lastWritten = value;
+        bus->pending--;
+        bus->busy = true;
+        std::string monitor = bus->monitor;
+
+        lock.unlock();
+        bool success = bus->ddc->setVcp(static_cast<VcpCode>(code), value);
+        if (success) {
+            Metrics::recordLatency("ddc.settle", monitor, std::chrono::steady_clock::now() - submittedAt);
+        } else {
+            LOG_WARN << "DDC/CI write of VCP " << static_cast<int>(code) << " failed on " << monitor;
+        }
+        lock.lock();
+
+        bus->busy = false;
+        (success ? bus->stats.issued : bus->stats.failed)++;
+        // A failed write leaves the monitor's value unknown, so the same value is not skipped next time
+        if (!success) due->written = false;
+        due->nextWrite = std::chrono::steady_clock::now() + m_minInterval;
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "../backends/DdcCi.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Writes VCP values from one thread per I2C bus, so monitors on different buses are set
+// in parallel while each bus still sees one command at a time. Each VCP code has a
+// single-slot mailbox: a newer value replaces one still waiting. A code is written at
+// most once per minInterval, since many monitors commit every Set VCP to NVRAM; the
+// value that is waiting when the interval ends is always written, so the settled value
+// of a drag lands even though the ones in between never do.
+class DdcWriteScheduler {
+public:
+    struct Stats {
+        uint64_t submitted = 0;
+        uint64_t issued = 0;     // Set VCP commands sent
+        uint64_t coalesced = 0;  // values replaced while waiting, or equal to what the monitor has
+        uint64_t failed = 0;
+    };
+
+    explicit DdcWriteScheduler(std::chrono::milliseconds minInterval = std::chrono::milliseconds(200));
+    ~DdcWriteScheduler();
+
+    DdcWriteScheduler(const DdcWriteScheduler&) = delete;
+    DdcWriteScheduler& operator=(const DdcWriteScheduler&) = delete;
+
+    // ddc must outlive the scheduler; re-adding a bus under a new name keeps its thread
+    void addMonitor(const std::string& monitor, DdcCi* ddc);
+    // Never waits for the bus; false for an unknown monitor or after stop()
+    bool submit(const std::string& monitor, VcpCode code, uint16_t value);
+    // Returns once every waiting value is written, intervals included. While nothing is
+    // submitted afterwards, the buses are idle and their DdcCi can be used directly.
+    void flush();
+    // Writes whatever is still waiting, without the interval, then ends the threads
+    void stop();
+
+    Stats getStats(const std::string& monitor) const;
+    std::chrono::milliseconds getMinInterval() const { return m_minInterval; }
+
+    // $VIVID_DDC_WRITE_INTERVAL in milliseconds, else the default
+    static std::chrono::milliseconds getConfiguredInterval();
+
+private:
+    struct Mailbox {
+        uint16_t value = 0;
+        bool pending = false;
+        bool written = false;  // lastWritten holds what the monitor was last set to
+        uint16_t lastWritten = 0;
+        std::chrono::steady_clock::time_point submittedAt;
+        std::chrono::steady_clock::time_point nextWrite;
+    };
+
+    struct Bus {
+        std::string monitor;
+        DdcCi* ddc = nullptr;
+        std::map<uint8_t, Mailbox> mailboxes;
+        size_t pending = 0;
+        bool busy = false;  // a write is on the wire
+        bool stopping = false;
+        Stats stats;
+        mutable std::mutex mutex;
+        std::condition_variable wakeup;
+        std::condition_variable idle;
+        std::thread thread;
+    };
+
+    std::chrono::milliseconds m_minInterval;
+    std::map<std::string, std::unique_ptr<Bus>> m_buses;  // by device path
+    std::map<std::string, Bus*> m_monitors;
+    bool m_stopped = false;
+    mutable std::mutex m_mutex;
+
+    Bus* findBus(const std::string& monitor) const;
+    void run(Bus* bus);
+};
@@ -0,0 +1,74 @@
+#include "GammaRamp.h"
+#include "RampKernel.h"
+#include <algorithm>
+#include <cmath>
+
+ChannelGamma vibranceToChannelGamma(int vibrance) {
+    vibrance = std::max(-100, std::min(100, vibrance));
+
+    float factor = 1.0f + (vibrance / 100.0f);
+    factor = std::max(0.1f, std::min(3.0f, factor));
+
+    // Different gamma values for RGB to simulate saturation
+    ChannelGamma gamma;
+    gamma.red = std::max(0.1f, std::min(3.0f, std::pow(factor, 0.8f)));
+    gamma.green = std::max(0.1f, std::min(3.0f, factor));
+    gamma.blue = std::max(0.1f, std::min(3.0f, std::pow(factor, 1.2f)));
+    return gamma;
+}
+
+ChannelGamma safeVibranceToChannelGamma(int vibrance) {
+    float saturation = 1.0f + (vibrance / 100.0f);
+    saturation = std::max(0.3f, std::min(1.7f, saturation));
+
+    float gamma = 1.0f / saturation;
+    gamma = std::max(0.6f, std::min(1.6f, gamma));
+    return uniformChannelGamma(gamma);
+}
+
+ChannelGamma uniformChannelGamma(float gamma) {
+    ChannelGamma result;
+    result.red = gamma;
+    result.green = gamma;
+    result.blue = gamma;
+    return result;
+}
+
+WhitePoint temperatureToWhitePoint(int kelvin) {
+    WhitePoint point;
+    if (kelvin == 6500) return point;
+
+    auto blackbody = [](double temp, double& r, double& g, double& b) {
+        // Tanner Helland's fit of the Planckian locus, in 0..255 units
+        double t = temp / 100.0;
+        r = (t <= 66.0) ? 255.0 : 329.698727446 * std::pow(t - 60.0, -0.1332047592);
+        g = (t <= 66.0) ? 99.4708025861 * std::log(t) - 161.1195681661
+                        : 288.1221695283 * std::pow(t - 60.0, -0.0755148492);
+        b = (t >= 66.0) ? 255.0 : (t <= 19.0) ? 0.0 : 138.5177312231 * std::log(t - 10.0) - 305.0447927307;
+        r = std::max(0.0, std::min(255.0, r));
+        g = std::max(0.0, std::min(255.0, g));
+        b = std::max(0.0, std::min(255.0, b));
+    };
+
+    double clamped = std::max(1000, std::min(25000, kelvin));
+    double r, g, b, r0, g0, b0;
+    blackbody(clamped, r, g, b);
+    blackbody(6500.0, r0, g0, b0);
+
+    r /= r0;
+    g /= g0;
+    b /= b0;
+    double peak = std::max(r, std::max(g, b));
+    point.red = static_cast<float>(r / peak);
+    point.green = static_cast<float>(g / peak);
+    point.blue = static_cast<float>(b / peak);
+    return point;
+}
+
+void fillGammaRamp(uint16_t* red, uint16_t* green, uint16_t* blue, int size, const ChannelGamma& gamma) {
+    generateRamp(gamma, WhitePoint(), red, green, blue, size);
+}
+
+void fillGammaRamp(GammaRamp& ramp, const ChannelGamma& gamma) {
+    fillGammaRamp(ramp.red.data(), ramp.green.data(), ramp.blue.data(), ramp.size(), gamma);
+}
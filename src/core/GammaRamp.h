@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Per-channel gamma exponents in xgamma/xrandr convention (ramp = x^(1/gamma))
+struct ChannelGamma {
+    float red = 1.0f;
+    float green = 1.0f;
+    float blue = 1.0f;
+};
+
+// 16-bit R/G/B lookup tables sized to a CRTC's gamma size
+struct GammaRamp {
+    std::vector<uint16_t> red;
+    std::vector<uint16_t> green;
+    std::vector<uint16_t> blue;
+
+    GammaRamp() = default;
+    explicit GammaRamp(int size) : red(size), green(size), blue(size) {}
+    int size() const { return static_cast<int>(red.size()); }
+};
+
+using VibranceCurve = ChannelGamma (*)(int vibrance);
+
+// Relative R/G/B output scale; 1.0 on every channel is neutral
+struct WhitePoint {
+    float red = 1.0f;
+    float green = 1.0f;
+    float blue = 1.0f;
+};
+
+// Vibrance -100..100 mapped to the per-channel curve the xgamma path used
+ChannelGamma vibranceToChannelGamma(int vibrance);
+
+// Conservative uniform curve used by VividManager's safe gamma path
+ChannelGamma safeVibranceToChannelGamma(int vibrance);
+
+// Uniform gamma on all three channels, e.g. for "xrandr --gamma g:g:g"
+ChannelGamma uniformChannelGamma(float gamma);
+
+// Blackbody approximation normalised so 6500K is neutral and the brightest channel is 1.0
+WhitePoint temperatureToWhitePoint(int kelvin);
+
+void fillGammaRamp(uint16_t* red, uint16_t* green, uint16_t* blue, int size, const ChannelGamma& gamma);
+void fillGammaRamp(GammaRamp& ramp, const ChannelGamma& gamma);
@@ -0,0 +1,180 @@
+#include "GammaRampCache.h"
+#include "RampKernel.h"
+#include <algorithm>
+
+GammaRampCache::GammaRampCache(VibranceCurve curve, size_t byteBudget)
+    : m_curve(curve)
+    , m_byteBudget(byteBudget) {}
+
+bool GammaRampCache::isCommonSize(int gammaSize) {
+    return gammaSize == 256 || gammaSize == 1024 || gammaSize == 4096;
+}
+
+std::shared_ptr<const GammaRamp> GammaRampCache::get(int gammaSize, int level) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return lookupLocked(gammaSize, level);
+}
+
+void GammaRampCache::prewarm(int gammaSize, int level) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    lookupLocked(gammaSize, level);
+}
+
+std::shared_ptr<const GammaRamp> GammaRampCache::build(int gammaSize, int level) const {
+    auto ramp = std::make_shared<GammaRamp>(gammaSize);
+    generateRamp(m_curve(level), temperatureToWhitePoint(m_temperature),
+                 ramp->red.data(), ramp->green.data(), ramp->blue.data(), gammaSize);
+    return ramp;
+}
+
+std::shared_ptr<const GammaRamp> GammaRampCache::lookupLocked(int gammaSize, int level) {
+    if (gammaSize <= 0) return nullptr;
+    level = std::max(kMinLevel, std::min(kMaxLevel, level));
+
+    auto table = m_fullTables.find(gammaSize);
+    if (table != m_fullTables.end()) {
+        m_hits++;
+        return table->second[level - kMinLevel];
+    }
+
+    Key key(gammaSize, level, m_temperature);
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        m_hits++;
+        m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+        return it->second.ramp;
+    }
+
+    m_misses++;
+    if (wantsFullTableLocked(gammaSize) && buildFullTableLocked(gammaSize)) {
+        return m_fullTables[gammaSize][level - kMinLevel];
+    }
+
+    size_t bytes = rampBytes(gammaSize);
+    evictLocked(bytes);
+
+    Entry entry;
+    entry.ramp = build(gammaSize, level);
+    m_lru.push_front(key);
+    entry.lru = m_lru.begin();
+    m_entries.emplace(key, entry);
+    m_bytes += bytes;
+    return entry.ramp;
+}
+
+bool GammaRampCache::wantsFullTableLocked(int gammaSize) const {
+    if (!isCommonSize(gammaSize)) return false;
+    if (!m_temperatureChanged) return true;
+
+    // A night-light step asks for one level per output; a slider drag asks for many.
+    // This miss is one more level.
+    int levels = 1;
+    for (const auto& pair : m_entries) {
+        if (std::get<0>(pair.first) == gammaSize && std::get<2>(pair.first) == m_temperature) levels++;
+    }
+    return levels >= kLevelsBeforeTable;
+}
+
+bool GammaRampCache::buildFullTableLocked(int gammaSize) {
+    size_t tableBytes = rampBytes(gammaSize) * kLevelCount;
+
+    // Per-level entries of this size and white point become redundant once the table exists
+    auto redundantEntry = [this, gammaSize](const Key& key) {
+        return std::get<0>(key) == gammaSize && std::get<2>(key) == m_temperature;
+    };
+    size_t redundant = 0;
+    for (const auto& pair : m_entries) {
+        if (redundantEntry(pair.first)) redundant += rampBytes(gammaSize);
+    }
+    if (m_bytes - redundant + tableBytes > m_byteBudget) {
+        return false;
+    }
+
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (redundantEntry(it->first)) {
+            m_lru.erase(it->second.lru);
+            m_bytes -= rampBytes(gammaSize);
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    std::vector<std::shared_ptr<const GammaRamp>> table;
+    table.reserve(kLevelCount);
+    for (int level = kMinLevel; level <= kMaxLevel; level++) {
+        table.push_back(build(gammaSize, level));
+    }
+    m_fullTables[gammaSize] = std::move(table);
+    m_bytes += tableBytes;
+    return true;
+}
+
+void GammaRampCache::evictLocked(size_t incoming) {
+    while (!m_lru.empty() && m_bytes + incoming > m_byteBudget) {
+        Key victim = m_lru.back();
+        m_lru.pop_back();
+        m_entries.erase(victim);
+        m_bytes -= rampBytes(std::get<0>(victim));
+        m_evictions++;
+    }
+}
+
+void GammaRampCache::setByteBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_byteBudget = bytes;
+
+    // Full tables are dropped largest first before touching per-level entries
+    while (m_bytes > m_byteBudget && !m_fullTables.empty()) {
+        auto largest = std::prev(m_fullTables.end());
+        m_bytes -= rampBytes(largest->first) * kLevelCount;
+        m_fullTables.erase(largest);
+        m_evictions++;
+    }
+    evictLocked(0);
+}
+
+GammaRampCache::Stats GammaRampCache::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    stats.bytes = m_bytes;
+    stats.byteBudget = m_byteBudget;
+    stats.ramps = m_entries.size() + m_fullTables.size() * kLevelCount;
+    stats.fullTables = m_fullTables.size();
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.evictions = m_evictions;
+    return stats;
+}
+
+void GammaRampCache::setTemperature(int kelvin) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (kelvin == m_temperature) return;
+    m_temperature = kelvin;
+    m_temperatureChanged = true;
+    dropFullTablesLocked();
+}
+
+int GammaRampCache::getTemperature() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_temperature;
+}
+
+void GammaRampCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    clearLocked();
+}
+
+void GammaRampCache::dropFullTablesLocked() {
+    for (const auto& table : m_fullTables) {
+        m_bytes -= rampBytes(table.first) * kLevelCount;
+    }
+    m_fullTables.clear();
+}
+
+void GammaRampCache::clearLocked() {
+    m_fullTables.clear();
+    m_entries.clear();
+    m_lru.clear();
+    m_bytes = 0;
+}
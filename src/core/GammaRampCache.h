@@ -0,0 +1,82 @@
+#pragma once
+#include "GammaRamp.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+// Ramps for the fixed -100..100 vibrance scale, shared by every CRTC of the same gamma size.
+// Common sizes get all 201 levels built on first use; other sizes are cached per level in LRU
+// order. Everything counts against a byte budget.
+//
+// Per-level ramps are keyed by white point too, so a night-light step only builds the levels
+// it uploads and stepping back finds them still cached. After a white point change a common
+// size only gets its full table again once a slider has asked for kLevelsBeforeTable levels.
+class GammaRampCache {
+public:
+    static constexpr int kMinLevel = -100;
+    static constexpr int kMaxLevel = 100;
+    static constexpr int kLevelCount = kMaxLevel - kMinLevel + 1;
+    static constexpr size_t kDefaultByteBudget = 8 * 1024 * 1024;
+    static constexpr int kLevelsBeforeTable = 8;
+
+    struct Stats {
+        size_t bytes = 0;
+        size_t byteBudget = 0;
+        size_t ramps = 0;
+        size_t fullTables = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
+    explicit GammaRampCache(VibranceCurve curve = vibranceToChannelGamma,
+                            size_t byteBudget = kDefaultByteBudget);
+
+    std::shared_ptr<const GammaRamp> get(int gammaSize, int level);
+    void prewarm(int gammaSize, int level);
+
+    // Ramps bake in the white point; changing it drops the full tables, not the per-level ramps
+    void setTemperature(int kelvin);
+    int getTemperature() const;
+
+    void setByteBudget(size_t bytes);
+    Stats getStats() const;
+    void clear();
+
+    static bool isCommonSize(int gammaSize);
+    static size_t rampBytes(int gammaSize) { return static_cast<size_t>(gammaSize) * 3 * sizeof(uint16_t); }
+
+private:
+    using Key = std::tuple<int, int, int>; // gamma size, level, kelvin
+
+    struct Entry {
+        std::shared_ptr<const GammaRamp> ramp;
+        std::list<Key>::iterator lru;
+    };
+
+    VibranceCurve m_curve;
+    int m_temperature = 6500;
+    bool m_temperatureChanged = false;  // full tables wait for a slider, see kLevelsBeforeTable
+    size_t m_byteBudget;
+    size_t m_bytes = 0;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+    uint64_t m_evictions = 0;
+
+    std::map<int, std::vector<std::shared_ptr<const GammaRamp>>> m_fullTables;
+    std::map<Key, Entry> m_entries;
+    std::list<Key> m_lru; // front = most recently used
+    mutable std::mutex m_mutex;
+
+    std::shared_ptr<const GammaRamp> build(int gammaSize, int level) const;
+    std::shared_ptr<const GammaRamp> lookupLocked(int gammaSize, int level);
+    bool wantsFullTableLocked(int gammaSize) const;
+    bool buildFullTableLocked(int gammaSize);
+    void dropFullTablesLocked();
+    void evictLocked(size_t incoming);
+    void clearLocked();
+};
@@ -0,0 +1,273 @@
+#include "Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t kSlots = 512;
+const size_t kSlotText = 240;  // longer messages are cut short with "..."
+
+struct Slot {
+    std::atomic<bool> full{false};  // set by the owner on commit, cleared by the drainer
+    LogLevel level = LogLevel::INFO;
+    uint16_t length = 0;
+    int64_t timestampNs = 0;
+    char text[kSlotText];
+};
+
+struct Ring {
+    Slot slots[kSlots];
+    uint64_t head = 0;      // next slot to fill; owner only
+    uint64_t tail = 0;      // next slot to drain; drainer only
+    bool retired = false;   // owner thread exited; guarded by the registry mutex
+};
+
+struct Entry {
+    int64_t timestampNs;
+    LogLevel level;
+    std::string text;
+};
+
+LogLevel thresholdFromEnvironment() {
+    const char* value = std::getenv("VIVID_LOG");
+    if (!value) return LogLevel::INFO;
+    std::string name(value);
+    if (name == "debug") return LogLevel::DEBUG;
+    if (name == "warn") return LogLevel::WARN;
+    if (name == "error") return LogLevel::ERROR;
+    if (name == "quiet") return LogLevel::QUIET;
+    return LogLevel::INFO;
+}
+
+// journald sets JOURNAL_STREAM to the device:inode of the stream it hands us
+bool stderrIsJournal() {
+    const char* stream = std::getenv("JOURNAL_STREAM");
+    struct stat info;
+    if (!stream || fstat(STDERR_FILENO, &info) != 0) return false;
+    std::string expected = std::to_string(info.st_dev) + ":" + std::to_string(info.st_ino);
+    return expected == stream;
+}
+
+int syslogPriority(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return 7;
+        case LogLevel::INFO: return 6;
+        case LogLevel::WARN: return 4;
+        default: return 3;
+    }
+}
+
+class Drainer {
+public:
+    Drainer() : m_journal(stderrIsJournal()) {
+        std::atexit([]() { Logger::flush(); });
+        std::thread(&Drainer::run, this).detach();
+    }
+
+    Ring* acquireRing() {
+        std::lock_guard<std::mutex> lock(m_registryMutex);
+        for (auto& ring : m_rings) {
+            if (ring->retired) {
+                ring->retired = false;
+                return ring.get();
+            }
+        }
+        m_rings.push_back(std::make_unique<Ring>());
+        return m_rings.back().get();
+    }
+
+    void retireRing(Ring* ring) {
+        std::lock_guard<std::mutex> lock(m_registryMutex);
+        ring->retired = true;
+    }
+
+    // After a slot was published with a seq_cst store. Pairs with run(): either the
+    // drainer sees that slot before sleeping, or we see it asleep and wake it.
+    void committed() {
+        if (m_sleeping.load() && m_sleeping.exchange(false)) {
+            wake();
+        }
+    }
+
+    void drain() {
+        std::lock_guard<std::mutex> lock(m_drainMutex);
+        std::vector<Ring*> rings;
+        {
+            std::lock_guard<std::mutex> registryLock(m_registryMutex);
+            for (auto& ring : m_rings) rings.push_back(ring.get());
+        }
+
+        m_entries.clear();
+        for (Ring* ring : rings) {
+            while (true) {
+                Slot& slot = ring->slots[ring->tail % kSlots];
+                if (!slot.full.load(std::memory_order_acquire)) break;
+                m_entries.push_back({slot.timestampNs, slot.level, std::string(slot.text, slot.length)});
+                slot.full.store(false, std::memory_order_release);
+                ring->tail++;
+            }
+        }
+        if (m_entries.empty()) return;
+
+        // Each ring is in order already; interleave threads by time
+        std::stable_sort(m_entries.begin(), m_entries.end(),
+                         [](const Entry& a, const Entry& b) { return a.timestampNs < b.timestampNs; });
+
+        m_output.clear();
+        for (const auto& entry : m_entries) {
+            if (m_journal) {
+                m_output += '<';
+                m_output += static_cast<char>('0' + syslogPriority(entry.level));
+                m_output += '>';
+            }
+            m_output += entry.text;
+            m_output += '\n';
+        }
+
+        size_t written = 0;
+        while (written < m_output.size()) {
+            ssize_t result = write(STDERR_FILENO, m_output.data() + written, m_output.size() - written);
+            if (result < 0 && errno == EINTR) continue;
+            if (result <= 0) break;
+            written += result;
+        }
+    }
+
+    std::atomic<uint64_t> dropped{0};
+
+private:
+    std::mutex m_registryMutex;
+    std::vector<std::unique_ptr<Ring>> m_rings;  // never freed; exited threads' rings are reused
+    std::mutex m_drainMutex;                     // one consumer at a time
+    std::vector<Entry> m_entries;
+    std::string m_output;
+    bool m_journal;
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeup;
+    bool m_wakeRequested = false;
+    std::atomic<bool> m_sleeping{false};
+
+    void wake() {
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            m_wakeRequested = true;
+        }
+        m_wakeup.notify_one();
+    }
+
+    // Polls while messages keep coming, then sleeps until a producer wakes it, so an
+    // idle process has no periodic wakeups and a busy one pays no syscall per message
+    void run() {
+        while (true) {
+            drain();
+
+            m_sleeping.store(true);
+            if (hasPending()) {
+                m_sleeping.store(false);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wakeup.wait(lock, [this]() { return m_wakeRequested; });
+            m_wakeRequested = false;
+            lock.unlock();
+
+            // Let a burst collect before writing it out
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+
+    bool hasPending() {
+        std::lock_guard<std::mutex> lock(m_registryMutex);
+        for (auto& ring : m_rings) {
+            if (ring->slots[ring->tail % kSlots].full.load()) return true;
+        }
+        return false;
+    }
+};
+
+// Never destroyed: other threads may still log while the process exits
+Drainer& drainer() {
+    static Drainer* instance = new Drainer();
+    return *instance;
+}
+
+struct RingLease {
+    Ring* ring = nullptr;
+
+    ~RingLease() {
+        if (ring) drainer().retireRing(ring);
+    }
+};
+
+Ring& localRing() {
+    thread_local RingLease lease;
+    if (!lease.ring) lease.ring = drainer().acquireRing();
+    return *lease.ring;
+}
+
+} // namespace
+
+std::atomic<LogLevel> Logger::s_threshold{thresholdFromEnvironment()};
+
+void Logger::flush() {
+    drainer().drain();
+}
+
+uint64_t Logger::getDroppedCount() {
+    return drainer().dropped.load();
+}
+
+LogLine::LogLine(LogLevel level) : m_capacity(kSlotText) {
+    Ring& ring = localRing();
+    Slot& slot = ring.slots[ring.head % kSlots];
+
+    if (slot.full.load(std::memory_order_acquire)) {
+        // Ring full: format into scratch and throw it away rather than wait
+        thread_local char scratch[kSlotText];
+        drainer().dropped++;
+        m_text = scratch;
+        m_slot = nullptr;
+        return;
+    }
+
+    slot.level = level;
+    slot.timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    m_text = slot.text;
+    m_slot = &slot;
+}
+
+LogLine::~LogLine() {
+    if (!m_slot) return;
+
+    Slot& slot = *static_cast<Slot*>(m_slot);
+    slot.length = static_cast<uint16_t>(m_length);
+    slot.full.store(true);
+    localRing().head++;
+    drainer().committed();
+}
+
+void LogLine::append(const char* text, size_t length) {
+    size_t room = m_capacity - m_length;
+    if (length <= room) {
+        std::memcpy(m_text + m_length, text, length);
+        m_length += length;
+        return;
+    }
+
+    std::memcpy(m_text + m_length, text, room);
+    m_length = m_capacity;
+    std::memcpy(m_text + m_capacity - 3, "...", 3);
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+enum class LogLevel : uint8_t {
+    DEBUG,
+    INFO,
+    WARN,
+    ERROR,
+    QUIET   // as a threshold: log nothing
+};
+
+// Levels below this are compiled out, e.g. -DVIVID_LOG_MIN_LEVEL=2 keeps WARN and ERROR
+#ifndef VIVID_LOG_MIN_LEVEL
+#define VIVID_LOG_MIN_LEVEL 0
+#endif
+
+// Leveled logging off the calling thread. A message is formatted straight into a
+// per-thread ring of fixed slots, with no lock and no syscall; a background thread drains
+// every ring to stderr, or with syslog priority prefixes when stderr is the journal.
+// A full ring drops the message rather than blocking. A disabled level costs one relaxed
+// load and a branch, and nothing at all below VIVID_LOG_MIN_LEVEL.
+//
+// Threshold from $VIVID_LOG (debug, info, warn, error, quiet); INFO by default.
+class Logger {
+public:
+    static bool enabled(LogLevel level) {
+        return level >= static_cast<LogLevel>(VIVID_LOG_MIN_LEVEL) && level >= s_threshold.load(std::memory_order_relaxed);
+    }
+
+    static void setThreshold(LogLevel level) { s_threshold.store(level, std::memory_order_relaxed); }
+    static LogLevel getThreshold() { return s_threshold.load(std::memory_order_relaxed); }
+
+    // Writes out everything logged so far before returning; also runs at exit
+    static void flush();
+    static uint64_t getDroppedCount();
+
+private:
+    static std::atomic<LogLevel> s_threshold;
+};
+
+// One message; committed to the ring when it goes out of scope. Use through the macros.
+class LogLine {
+public:
+    explicit LogLine(LogLevel level);
+    ~LogLine();
+
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+
+    LogLine& operator<<(std::string_view text) {
+        append(text.data(), text.size());
+        return *this;
+    }
+    LogLine& operator<<(const char* text) { return *this << std::string_view(text ? text : "(null)"); }
+    LogLine& operator<<(const std::string& text) { return *this << std::string_view(text); }
+    LogLine& operator<<(char c) {
+        append(&c, 1);
+        return *this;
+    }
+    LogLine& operator<<(bool value) { return *this << (value ? '1' : '0'); }
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type = 0>
+    LogLine& operator<<(T value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        append(digits, result.ptr - digits);
+        return *this;
+    }
+
+    // Same digits as an ostream's default (%g)
+    template <typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+    LogLine& operator<<(T value) {
+        char digits[32];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::general, 6);
+        append(digits, result.ptr - digits);
+        return *this;
+    }
+
+private:
+    char* m_text;       // the slot's buffer, or a scratch buffer when the ring is full
+    size_t m_length = 0;
+    size_t m_capacity;
+    void* m_slot;
+
+    void append(const char* text, size_t length);
+};
+
+#define VIVID_LOG(level) \
+    if (!Logger::enabled(LogLevel::level)) {} else LogLine(LogLevel::level)
+
+#define LOG_DEBUG VIVID_LOG(DEBUG)
+#define LOG_INFO VIVID_LOG(INFO)
+#define LOG_WARN VIVID_LOG(WARN)
+#define LOG_ERROR VIVID_LOG(ERROR)
@@ -0,0 +1,233 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+namespace {
+
+const int kCounterCount = static_cast<int>(Counter::COUNT);
+
+struct Shard {
+    std::atomic<uint64_t> counters[kCounterCount] = {};
+    // Taken by the owner only to add a series, and by collect() to walk the map
+    std::mutex mutex;
+    // Series names are literals, so their address is key enough; collect() merges by text
+    std::unordered_map<const char*, std::unordered_map<std::string, std::unique_ptr<LatencyHistogram>>> histograms;
+    bool retired = false;  // guarded by the registry mutex
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+};
+
+// Never destroyed: detached threads may still record while the process exits
+Registry& registry() {
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+struct ShardLease {
+    Shard* shard = nullptr;
+
+    ~ShardLease() {
+        if (!shard) return;
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        shard->retired = true;
+    }
+};
+
+Shard* acquireShard() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (auto& shard : reg.shards) {
+        if (shard->retired) {
+            shard->retired = false;
+            return shard.get();
+        }
+    }
+    reg.shards.push_back(std::make_unique<Shard>());
+    return reg.shards.back().get();
+}
+
+Shard& localShard() {
+    thread_local ShardLease lease;
+    if (!lease.shard) lease.shard = acquireShard();
+    return *lease.shard;
+}
+
+// Single writer per shard, so an increment needs no read-modify-write
+void bump(std::atomic<uint64_t>& value, uint64_t amount) {
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+uint64_t valueAtPercentile(const std::vector<uint64_t>& counts, uint64_t total, double percentile, uint64_t max) {
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * total + 0.5);
+    rank = std::max<uint64_t>(1, std::min(rank, total));
+
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < LatencyHistogram::kBuckets; bucket++) {
+        seen += counts[bucket];
+        if (seen >= rank) return std::min(LatencyHistogram::bucketHigh(bucket), max);
+    }
+    return max;
+}
+
+std::string formatDuration(uint64_t ns) {
+    std::ostringstream out;
+    out << std::fixed;
+    if (ns < 1000) {
+        out << ns << "ns";
+    } else if (ns < 1000000) {
+        out << std::setprecision(1) << ns / 1e3 << "us";
+    } else if (ns < 1000000000) {
+        out << std::setprecision(2) << ns / 1e6 << "ms";
+    } else {
+        out << std::setprecision(2) << ns / 1e9 << "s";
+    }
+    return out.str();
+}
+
+} // namespace
+
+int LatencyHistogram::bucketOf(uint64_t value) {
+    const uint64_t limit = (uint64_t(1) << kMaxBits) - 1;
+    const uint64_t subBuckets = uint64_t(1) << kSubBucketBits;
+    value = std::min(value, limit);
+    if (value < subBuckets) return static_cast<int>(value);
+
+    // The top kSubBucketBits + 1 significant bits pick the bucket
+    int exponent = 63 - __builtin_clzll(value);
+    int shift = exponent - kSubBucketBits;
+    return ((shift + 1) << kSubBucketBits) + static_cast<int>((value >> shift) & (subBuckets - 1));
+}
+
+uint64_t LatencyHistogram::bucketHigh(int bucket) {
+    const int subBuckets = 1 << kSubBucketBits;
+    if (bucket < subBuckets) return static_cast<uint64_t>(bucket);
+
+    int shift = (bucket >> kSubBucketBits) - 1;
+    uint64_t low = static_cast<uint64_t>(subBuckets + (bucket & (subBuckets - 1))) << shift;
+    return low + (uint64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    bump(m_counts[bucketOf(value)], 1);
+    if (value > m_max.load(std::memory_order_relaxed)) {
+        m_max.store(value, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::mergeInto(std::vector<uint64_t>& counts, uint64_t& max) const {
+    for (int bucket = 0; bucket < kBuckets; bucket++) {
+        counts[bucket] += m_counts[bucket].load(std::memory_order_relaxed);
+    }
+    max = std::max(max, m_max.load(std::memory_order_relaxed));
+}
+
+void Metrics::count(Counter counter, uint64_t amount) {
+    bump(localShard().counters[static_cast<int>(counter)], amount);
+}
+
+void Metrics::recordLatency(const char* series, const std::string& label, std::chrono::nanoseconds elapsed) {
+    Shard& shard = localShard();
+
+    // Only this thread inserts into its shard, so finding needs no lock
+    LatencyHistogram* histogram = nullptr;
+    auto found = shard.histograms.find(series);
+    if (found != shard.histograms.end()) {
+        auto it = found->second.find(label);
+        if (it != found->second.end()) histogram = it->second.get();
+    }
+    if (!histogram) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto& slot = shard.histograms[series][label];
+        slot = std::make_unique<LatencyHistogram>();
+        histogram = slot.get();
+    }
+    histogram->record(static_cast<uint64_t>(std::max<int64_t>(0, elapsed.count())));
+}
+
+MetricsReport Metrics::collect() {
+    MetricsReport report;
+    std::map<std::pair<std::string, std::string>, std::pair<std::vector<uint64_t>, uint64_t>> merged;
+
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> registryLock(reg.mutex);
+    report.uptimeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - reg.started).count();
+
+    for (const auto& shard : reg.shards) {
+        for (int i = 0; i < kCounterCount; i++) {
+            report.counters[i] += shard->counters[i].load(std::memory_order_relaxed);
+        }
+
+        std::lock_guard<std::mutex> shardLock(shard->mutex);
+        for (const auto& series : shard->histograms) {
+            for (const auto& label : series.second) {
+                auto& entry = merged[{series.first, label.first}];
+                if (entry.first.empty()) entry.first.assign(LatencyHistogram::kBuckets, 0);
+                label.second->mergeInto(entry.first, entry.second);
+            }
+        }
+    }
+
+    for (const auto& pair : merged) {
+        const std::vector<uint64_t>& counts = pair.second.first;
+        LatencySummary summary;
+        summary.series = pair.first.first;
+        summary.label = pair.first.second;
+        for (uint64_t count : counts) summary.count += count;
+        if (summary.count == 0) continue;
+
+        summary.maxNs = pair.second.second;
+        summary.p50Ns = valueAtPercentile(counts, summary.count, 50.0, summary.maxNs);
+        summary.p99Ns = valueAtPercentile(counts, summary.count, 99.0, summary.maxNs);
+        report.latencies.push_back(summary);
+    }
+    return report;
+}
+
+const char* Metrics::counterName(Counter counter) {
+    switch (counter) {
+        case Counter::X_ROUND_TRIPS: return "x_round_trips";
+        case Counter::PROCESS_SPAWNS: return "process_spawns";
+        case Counter::SLIDER_COALESCED: return "slider_coalesced";
+        case Counter::SLIDER_DROPPED: return "slider_dropped";
+        case Counter::SLIDER_FAILED: return "slider_failed";
+        case Counter::PROFILE_SWITCHES: return "profile_switches";
+        case Counter::APPLY_FAILURES: return "apply_failures";
+        case Counter::DDC_COMMANDS: return "ddc_commands";
+        case Counter::DDC_RETRIES: return "ddc_retries";
+        case Counter::DDC_COALESCED: return "ddc_coalesced";
+        case Counter::COUNT: break;
+    }
+    return "unknown";
+}
+
+std::string Metrics::format(const MetricsReport& report) {
+    std::ostringstream out;
+    out << "uptime " << std::fixed << std::setprecision(0) << report.uptimeSeconds << "s\n\n";
+
+    out << "counters\n";
+    for (int i = 0; i < kCounterCount; i++) {
+        out << "  " << std::left << std::setw(20) << counterName(static_cast<Counter>(i))
+            << report.counters[i] << "\n";
+    }
+
+    out << "\nlatency" << std::string(30, ' ') << std::right
+        << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "max" << std::setw(9) << "count" << "\n";
+    for (const auto& latency : report.latencies) {
+        out << "  " << std::left << std::setw(16) << latency.series << std::setw(19) << latency.label << std::right
+            << std::setw(10) << formatDuration(latency.p50Ns)
+            << std::setw(10) << formatDuration(latency.p99Ns)
+            << std::setw(10) << formatDuration(latency.maxNs)
+            << std::setw(9) << latency.count << "\n";
+    }
+    if (report.latencies.empty()) out << "  (nothing recorded)\n";
+    return out.str();
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class Counter {
+    X_ROUND_TRIPS,      // requests that waited for the X server's reply
+    PROCESS_SPAWNS,     // system()/popen() of a helper tool
+    SLIDER_COALESCED,   // slider values replaced before they reached the backend
+    SLIDER_DROPPED,     // slider values never tried: the worker was stopping
+    SLIDER_FAILED,      // slider values tried and rejected by the backend or the daemon
+    PROFILE_SWITCHES,
+    APPLY_FAILURES,     // applyVibranceImmediate calls where every fallback failed
+    DDC_COMMANDS,       // DDC/CI requests written to an I2C bus, retries included
+    DDC_RETRIES,        // DDC/CI requests repeated after a NAK, null reply or bad checksum
+    DDC_COALESCED,      // VCP writes never sent: replaced while waiting, or already on the monitor
+    COUNT
+};
+
+// Log-linear buckets in the HDR histogram layout: 32 linear sub-buckets per power of
+// two, so every value is reported within 3% of itself, from 1 ns to 18 minutes in 9 KB.
+// Only the owning thread records, with plain loads and stores; any thread may read.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 5;
+    static constexpr int kMaxBits = 40;
+    static constexpr int kBuckets = (kMaxBits - kSubBucketBits + 1) << kSubBucketBits;
+
+    static int bucketOf(uint64_t value);
+    static uint64_t bucketHigh(int bucket);  // largest value that lands in bucket
+
+    void record(uint64_t value);
+    // Adds this histogram's counts to counts (kBuckets long)
+    void mergeInto(std::vector<uint64_t>& counts, uint64_t& max) const;
+
+private:
+    std::atomic<uint64_t> m_counts[kBuckets] = {};
+    std::atomic<uint64_t> m_max{0};
+};
+
+struct LatencySummary {
+    std::string series;  // code path, e.g. apply.native
+    std::string label;   // display or probe name
+    uint64_t count = 0;
+    uint64_t p50Ns = 0;
+    uint64_t p99Ns = 0;
+    uint64_t maxNs = 0;
+};
+
+struct MetricsReport {
+    uint64_t counters[static_cast<int>(Counter::COUNT)] = {};
+    std::vector<LatencySummary> latencies;  // sorted by series, then label
+    double uptimeSeconds = 0.0;
+};
+
+// Process-wide instrumentation. Every thread records into its own shard, so the hot path
+// is a hash lookup plus a few uncontended stores; a mutex is only taken the first time
+// a thread records a series, and by collect(). Shards of exited threads keep their
+// counts and are handed to the next new thread.
+class Metrics {
+public:
+    static void count(Counter counter, uint64_t amount = 1);
+    static void recordLatency(const char* series, const std::string& label, std::chrono::nanoseconds elapsed);
+
+    static MetricsReport collect();
+    static std::string format(const MetricsReport& report);
+    static const char* counterName(Counter counter);
+};
+
+// Measures from construction; the series is picked at the end, once the outcome is known
+class LatencyTimer {
+public:
+    LatencyTimer() : m_start(std::chrono::steady_clock::now()) {}
+
+    std::chrono::nanoseconds elapsed() const { return std::chrono::steady_clock::now() - m_start; }
+    void record(const char* series, const std::string& label) const {
+        Metrics::recordLatency(series, label, elapsed());
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+};
@@ -0,0 +1,230 @@
+#include "NightLight.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int kTemperatureStep = 50;
+constexpr double kDayElevation = 3.0;     // degrees; full day temperature above this
+constexpr double kNightElevation = -6.0;  // civil dusk; full night temperature below this
+constexpr time_t kScanStep = 60;
+constexpr time_t kScanHorizon = 2 * 24 * 3600;
+
+constexpr double kPi = 3.14159265358979323846;
+double toRadians(double degrees) { return degrees * kPi / 180.0; }
+double toDegrees(double radians) { return radians * 180.0 / kPi; }
+
+int parseClock(const std::string& value, int fallback) {
+    int hours = 0, minutes = 0;
+    if (std::sscanf(value.c_str(), "%d:%d", &hours, &minutes) != 2) return fallback;
+    return std::max(0, std::min(24 * 60 - 1, hours * 60 + minutes));
+}
+
+int minutesSinceMidnight(time_t when, double& fraction) {
+    struct tm local;
+    localtime_r(&when, &local);
+    fraction = local.tm_sec / 60.0;
+    return local.tm_hour * 60 + local.tm_min;
+}
+
+int quantize(double kelvin) {
+    return static_cast<int>(std::lround(kelvin / kTemperatureStep)) * kTemperatureStep;
+}
+
+} // namespace
+
+NightLightConfig NightLightConfig::load(const std::string& path) {
+    NightLightConfig config;
+    std::ifstream file(path);
+    if (!file.is_open()) return config;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t eq = line.find('=');
+        if (eq == std::string::npos || line[0] == '#') continue;
+
+        std::string name = line.substr(0, eq);
+        std::string value = line.substr(eq + 1);
+
+        if (name == "enabled") config.enabled = (value == "1" || value == "true");
+        else if (name == "mode") config.mode = (value == "solar") ? Mode::SOLAR : Mode::FIXED;
+        else if (name == "latitude") config.latitude = std::atof(value.c_str());
+        else if (name == "longitude") config.longitude = std::atof(value.c_str());
+        else if (name == "day_start") config.dayStartMinutes = parseClock(value, config.dayStartMinutes);
+        else if (name == "night_start") config.nightStartMinutes = parseClock(value, config.nightStartMinutes);
+        else if (name == "transition_minutes") config.transitionMinutes = std::max(0, std::atoi(value.c_str()));
+        else if (name == "day_temperature") config.dayTemperature = std::atoi(value.c_str());
+        else if (name == "night_temperature") config.nightTemperature = std::atoi(value.c_str());
+    }
+
+    config.dayTemperature = std::max(1000, std::min(25000, config.dayTemperature));
+    config.nightTemperature = std::max(1000, std::min(25000, config.nightTemperature));
+    return config;
+}
+
+std::string NightLightConfig::getConfigPath() {
+    const char* home = std::getenv("HOME");
+    return std::string(home ? home : ".") + "/.config/vivid/nightlight.conf";
+}
+
+NightLight::NightLight(TemperatureCallback callback)
+    : m_callback(std::move(callback)) {}
+
+NightLight::~NightLight() {
+    stop();
+}
+
+double NightLight::solarElevation(time_t when, double latitude, double longitude) {
+    // NOAA low-precision solar position, good to a fraction of a degree
+    double n = when / 86400.0 + 2440587.5 - 2451545.0;
+    double meanLongitude = std::fmod(280.460 + 0.9856474 * n, 360.0);
+    double meanAnomaly = toRadians(std::fmod(357.528 + 0.9856003 * n, 360.0));
+    double eclipticLongitude = toRadians(meanLongitude + 1.915 * std::sin(meanAnomaly)
+                                         + 0.020 * std::sin(2 * meanAnomaly));
+    double obliquity = toRadians(23.439 - 0.0000004 * n);
+
+    double declination = std::asin(std::sin(obliquity) * std::sin(eclipticLongitude));
+    double rightAscension = std::atan2(std::cos(obliquity) * std::sin(eclipticLongitude),
+                                       std::cos(eclipticLongitude));
+
+    double siderealHours = std::fmod(18.697374558 + 24.06570982441908 * n, 24.0);
+    double hourAngle = toRadians(siderealHours * 15.0 + longitude) - rightAscension;
+
+    double lat = toRadians(latitude);
+    return toDegrees(std::asin(std::sin(lat) * std::sin(declination)
+                               + std::cos(lat) * std::cos(declination) * std::cos(hourAngle)));
+}
+
+int NightLight::temperatureAt(const NightLightConfig& config, time_t when) {
+    double day = config.dayTemperature;
+    double night = config.nightTemperature;
+    double dayness = 1.0;
+
+    if (config.mode == NightLightConfig::Mode::SOLAR) {
+        double elevation = solarElevation(when, config.latitude, config.longitude);
+        dayness = (elevation - kNightElevation) / (kDayElevation - kNightElevation);
+    } else {
+        double seconds;
+        double now = minutesSinceMidnight(when, seconds) + seconds;
+        double fade = std::max(1, config.transitionMinutes);
+        auto since = [](double now, int start) {
+            double delta = now - start;
+            return delta < 0 ? delta + 24 * 60 : delta;
+        };
+
+        double sinceDay = since(now, config.dayStartMinutes);
+        double sinceNight = since(now, config.nightStartMinutes);
+        if (sinceDay < sinceNight) {
+            // Day period, fading in from night
+            dayness = config.transitionMinutes > 0 ? sinceDay / fade : 1.0;
+        } else {
+            dayness = config.transitionMinutes > 0 ? 1.0 - sinceNight / fade : 0.0;
+        }
+    }
+
+    dayness = std::max(0.0, std::min(1.0, dayness));
+    return quantize(night + (day - night) * dayness);
+}
+
+time_t NightLight::nextChange(const NightLightConfig& config, time_t when) {
+    int current = temperatureAt(config, when);
+
+    // Coarse forward scan, then bisect down to the second
+    time_t low = when;
+    time_t high = when;
+    bool found = false;
+    for (time_t t = when + kScanStep; t <= when + kScanHorizon; t += kScanStep) {
+        if (temperatureAt(config, t) != current) {
+            high = t;
+            found = true;
+            break;
+        }
+        low = t;
+    }
+    if (!found) return when + kScanHorizon;
+
+    while (high - low > 1) {
+        time_t mid = low + (high - low) / 2;
+        if (temperatureAt(config, mid) != current) {
+            high = mid;
+        } else {
+            low = mid;
+        }
+    }
+    return high;
+}
+
+bool NightLight::start(const NightLightConfig& config) {
+    stop();
+    m_config = config;
+
+    m_timerFd = timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC);
+    m_stopFd = eventfd(0, EFD_CLOEXEC);
+    if (m_timerFd < 0 || m_stopFd < 0) {
+        stop();
+        return false;
+    }
+
+    m_thread = std::thread(&NightLight::run, this);
+    return true;
+}
+
+void NightLight::stop() {
+    if (m_thread.joinable()) {
+        uint64_t one = 1;
+        ssize_t written = write(m_stopFd, &one, sizeof(one));
+        (void)written;
+        m_thread.join();
+    }
+    if (m_timerFd >= 0) close(m_timerFd);
+    if (m_stopFd >= 0) close(m_stopFd);
+    m_timerFd = -1;
+    m_stopFd = -1;
+}
+
+bool NightLight::armTimer(time_t when) {
+    struct itimerspec spec = {};
+    spec.it_value.tv_sec = when;
+    // Cancel-on-set wakes us if the wall clock jumps (resume, NTP step, manual change)
+    return timerfd_settime(m_timerFd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &spec, nullptr) == 0;
+}
+
+void NightLight::run() {
+    int applied = 0;
+
+    while (true) {
+        time_t now = time(nullptr);
+        int temperature = temperatureAt(m_config, now);
+        if (temperature != applied) {
+            applied = temperature;
+            m_currentTemperature = temperature;
+            if (m_callback) m_callback(temperature);
+        }
+
+        if (!armTimer(nextChange(m_config, now))) break;
+
+        struct pollfd fds[2] = {
+            {m_timerFd, POLLIN, 0},
+            {m_stopFd, POLLIN, 0}
+        };
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents & POLLIN) break;
+
+        uint64_t expirations;
+        if (read(m_timerFd, &expirations, sizeof(expirations)) < 0 && errno != ECANCELED) {
+            break;
+        }
+    }
+}
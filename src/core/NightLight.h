@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <thread>
+
+struct NightLightConfig {
+    enum class Mode {
+        SOLAR,  // follow the sun at latitude/longitude
+        FIXED   // switch at fixed local times
+    };
+
+    bool enabled = false;
+    Mode mode = Mode::FIXED;
+    double latitude = 0.0;
+    double longitude = 0.0;
+    int dayStartMinutes = 7 * 60;     // local time, minutes after midnight
+    int nightStartMinutes = 20 * 60;
+    int transitionMinutes = 30;       // fixed mode fade length
+    int dayTemperature = 6500;
+    int nightTemperature = 4000;
+
+    static NightLightConfig load(const std::string& path);
+    static std::string getConfigPath();
+};
+
+// Colour temperature schedule. A single timerfd sleeps until the moment the
+// (50K-quantised) temperature next changes, so nothing wakes up in between.
+class NightLight {
+public:
+    using TemperatureCallback = std::function<void(int kelvin)>;
+
+    explicit NightLight(TemperatureCallback callback);
+    ~NightLight();
+
+    bool start(const NightLightConfig& config);
+    void stop();
+    bool isRunning() const { return m_thread.joinable(); }
+    int getCurrentTemperature() const { return m_currentTemperature.load(); }
+
+    static int temperatureAt(const NightLightConfig& config, time_t when);
+    static time_t nextChange(const NightLightConfig& config, time_t when);
+    static double solarElevation(time_t when, double latitude, double longitude);
+
+private:
+    TemperatureCallback m_callback;
+    NightLightConfig m_config;
+    std::thread m_thread;
+    std::atomic<int> m_currentTemperature{6500};
+    int m_timerFd = -1;
+    int m_stopFd = -1;
+
+    void run();
+    bool armTimer(time_t when);
+};
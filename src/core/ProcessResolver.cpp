@@ -0,0 +1,315 @@
+#include "ProcessResolver.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <limits.h>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unordered_set>
+
+namespace {
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// Value of name in a NUL-separated environ block
+std::string environValue(const std::string& environment, const char* name) {
+    size_t length = std::strlen(name);
+    size_t start = 0;
+    while (start < environment.size()) {
+        size_t end = environment.find('\0', start);
+        if (end == std::string::npos) end = environment.size();
+        if (end - start > length && environment.compare(start, length, name) == 0 && environment[start + length] == '=') {
+            return environment.substr(start + length + 1, end - start - length - 1);
+        }
+        start = end + 1;
+    }
+    return "";
+}
+
+bool endsWithExe(const std::string& value) {
+    if (value.size() < 4) return false;
+    std::string suffix = value.substr(value.size() - 4);
+    std::transform(suffix.begin(), suffix.end(), suffix.begin(), [](unsigned char c) { return std::tolower(c); });
+    return suffix == ".exe";
+}
+
+} // namespace
+
+std::string ProcessIdentity::appId() const {
+    if (!steamAppId.empty()) return "steam:" + steamAppId;
+    return flatpakAppId;
+}
+
+ProcessResolver::~ProcessResolver() {
+    stop();
+}
+
+bool ProcessResolver::start() {
+    if (m_thread.joinable()) return true;
+
+    m_socket = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (m_socket < 0) return false;
+
+    sockaddr_nl address = {};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = CN_IDX_PROC;
+    address.nl_pid = 0;  // let the kernel pick a port id
+
+    m_stopFd = eventfd(0, EFD_CLOEXEC);
+    if (m_stopFd < 0 || bind(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        !subscribe(true)) {
+        stop();
+        return false;
+    }
+
+    m_connector = true;
+    m_thread = std::thread(&ProcessResolver::run, this);
+    return true;
+}
+
+void ProcessResolver::stop() {
+    m_connector = false;
+    if (m_thread.joinable()) {
+        uint64_t one = 1;
+        ssize_t written = write(m_stopFd, &one, sizeof(one));
+        (void)written;
+        m_thread.join();
+        subscribe(false);
+    }
+    if (m_socket >= 0) {
+        close(m_socket);
+        m_socket = -1;
+    }
+    if (m_stopFd >= 0) {
+        close(m_stopFd);
+        m_stopFd = -1;
+    }
+}
+
+bool ProcessResolver::subscribe(bool enable) {
+    // nlmsghdr | cn_msg | op, packed back to back (cn_msg ends in a flexible array)
+    alignas(nlmsghdr) char request[NLMSG_LENGTH(sizeof(cn_msg) + sizeof(proc_cn_mcast_op))] = {};
+
+    nlmsghdr* header = reinterpret_cast<nlmsghdr*>(request);
+    header->nlmsg_len = sizeof(request);
+    header->nlmsg_type = NLMSG_DONE;
+    header->nlmsg_pid = getpid();
+
+    cn_msg* message = static_cast<cn_msg*>(NLMSG_DATA(header));
+    message->id.idx = CN_IDX_PROC;
+    message->id.val = CN_VAL_PROC;
+    message->len = sizeof(proc_cn_mcast_op);
+
+    proc_cn_mcast_op op = enable ? PROC_CN_MCAST_LISTEN : PROC_CN_MCAST_IGNORE;
+    std::memcpy(message->data, &op, sizeof(op));
+
+    return send(m_socket, request, sizeof(request), 0) == static_cast<ssize_t>(sizeof(request));
+}
+
+void ProcessResolver::run() {
+    struct pollfd fds[2];
+    fds[0].fd = m_socket;
+    fds[0].events = POLLIN;
+    fds[1].fd = m_stopFd;
+    fds[1].events = POLLIN;
+
+    alignas(nlmsghdr) char buffer[4096];
+    while (true) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (fds[1].revents & POLLIN) return;
+
+        ssize_t length = recv(m_socket, buffer, sizeof(buffer), 0);
+        if (length < 0) {
+            if (errno == EINTR) continue;
+            if (errno == ENOBUFS) {
+                // Events were dropped; nothing cached can be trusted any more
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_table.clear();
+                continue;
+            }
+            return;
+        }
+
+        for (nlmsghdr* header = reinterpret_cast<nlmsghdr*>(buffer); NLMSG_OK(header, length);
+             header = NLMSG_NEXT(header, length)) {
+            if (header->nlmsg_type != NLMSG_DONE) continue;
+
+            const cn_msg* message = static_cast<const cn_msg*>(NLMSG_DATA(header));
+            if (message->id.idx != CN_IDX_PROC || message->id.val != CN_VAL_PROC) continue;
+            const proc_event* event = reinterpret_cast<const proc_event*>(message->data);
+
+            // Only the thread group leader carries the identity; thread events are noise
+            int pid = -1;
+            if (event->what == proc_event::PROC_EVENT_EXEC) {
+                pid = event->event_data.exec.process_tgid;
+                m_execEvents++;
+            } else if (event->what == proc_event::PROC_EVENT_EXIT &&
+                       event->event_data.exit.process_pid == event->event_data.exit.process_tgid) {
+                pid = event->event_data.exit.process_tgid;
+                m_exitEvents++;
+            }
+
+            if (pid > 0) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_table.erase(pid);
+            }
+        }
+    }
+}
+
+ProcessIdentity ProcessResolver::resolve(int pid) {
+    if (pid <= 0) return ProcessIdentity();
+    bool connector = m_connector.load();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_table.find(pid);
+        if (it != m_table.end()) {
+            // Events keep the table exact; without them a reused pid shows up as a new start time
+            if (connector || readStartTime(pid) == it->second.startTime) {
+                m_hits++;
+                return it->second.identity;
+            }
+            m_table.erase(it);
+        }
+    }
+
+    m_misses++;
+    Entry entry;
+    entry.startTime = readStartTime(pid);
+    if (entry.startTime == 0 || !readIdentity(pid, entry.identity)) {
+        return ProcessIdentity();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!connector && m_table.size() >= m_pruneThreshold) {
+        pruneLocked();
+    }
+    m_table[pid] = entry;
+    return entry.identity;
+}
+
+ProcessResolver::Stats ProcessResolver::getStats() const {
+    Stats stats;
+    stats.hits = m_hits.load();
+    stats.misses = m_misses.load();
+    stats.execEvents = m_execEvents.load();
+    stats.exitEvents = m_exitEvents.load();
+    stats.pruned = m_pruned.load();
+    stats.connector = m_connector.load();
+    return stats;
+}
+
+void ProcessResolver::pruneLocked() {
+    // One readdir of /proc instead of a stat per cached pid
+    std::unordered_set<int> alive;
+    if (DIR* dir = opendir("/proc")) {
+        while (dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] >= '1' && entry->d_name[0] <= '9') {
+                alive.insert(std::atoi(entry->d_name));
+            }
+        }
+        closedir(dir);
+    }
+
+    for (auto it = m_table.begin(); it != m_table.end();) {
+        if (alive.count(it->first) == 0) {
+            it = m_table.erase(it);
+            m_pruned++;
+        } else {
+            ++it;
+        }
+    }
+
+    // Still full of live processes: let it grow rather than prune on every miss
+    m_pruneThreshold = std::max<size_t>(256, m_table.size() * 2);
+}
+
+uint64_t ProcessResolver::readStartTime(int pid) {
+    std::string stat = readFile("/proc/" + std::to_string(pid) + "/stat");
+
+    // comm may contain spaces and parentheses; fields resume after the last ')'
+    size_t commEnd = stat.rfind(')');
+    if (commEnd == std::string::npos) return 0;
+
+    // starttime is field 22; the text after ") " starts at field 3
+    const char* cursor = stat.c_str() + commEnd + 2;
+    for (int field = 3; field < 22 && *cursor; field++) {
+        cursor = std::strchr(cursor, ' ');
+        if (!cursor) return 0;
+        cursor++;
+    }
+    return std::strtoull(cursor, nullptr, 10);
+}
+
+bool ProcessResolver::readIdentity(int pid, ProcessIdentity& identity) {
+    std::string base = "/proc/" + std::to_string(pid);
+    identity.pid = pid;
+
+    char target[PATH_MAX];
+    ssize_t length = readlink((base + "/exe").c_str(), target, sizeof(target) - 1);
+    if (length <= 0) return false;
+    identity.executable.assign(target, length);
+
+    if (isWineLoader(identity.executable)) {
+        identity.windowsExe = windowsExeFromCmdline(readFile(base + "/cmdline"));
+    }
+
+    std::string environment = readFile(base + "/environ");
+    identity.steamAppId = environValue(environment, "SteamAppId");
+    if (identity.steamAppId.empty() || identity.steamAppId == "0") {
+        identity.steamAppId = environValue(environment, "SteamGameId");
+    }
+    if (identity.steamAppId == "0") identity.steamAppId.clear();
+
+    identity.flatpakAppId = environValue(environment, "FLATPAK_ID");
+    if (identity.flatpakAppId.empty()) {
+        // Sandboxed processes always have this file, even with a scrubbed environment
+        std::string info = readFile(base + "/root/.flatpak-info");
+        size_t name = info.find("\nname=");
+        if (name != std::string::npos) {
+            size_t end = info.find('\n', name + 6);
+            identity.flatpakAppId = info.substr(name + 6, end == std::string::npos ? std::string::npos : end - name - 6);
+        }
+    }
+    return true;
+}
+
+bool ProcessResolver::isWineLoader(const std::string& executable) {
+    size_t slash = executable.find_last_of('/');
+    std::string name = (slash == std::string::npos) ? executable : executable.substr(slash + 1);
+    return name == "wine64-preloader" || name == "wine-preloader" || name == "wine64" || name == "wine";
+}
+
+std::string ProcessResolver::windowsExeFromCmdline(const std::string& cmdline) {
+    // The first argument naming a .exe is the program; later ones are its own arguments
+    size_t start = 0;
+    while (start < cmdline.size()) {
+        size_t end = cmdline.find('\0', start);
+        if (end == std::string::npos) end = cmdline.size();
+        std::string argument = cmdline.substr(start, end - start);
+
+        if (endsWithExe(argument)) {
+            size_t separator = argument.find_last_of("\\/");
+            return (separator == std::string::npos) ? argument : argument.substr(separator + 1);
+        }
+        start = end + 1;
+    }
+    return "";
+}
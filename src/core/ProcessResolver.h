@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+struct ProcessIdentity {
+    int pid = -1;
+    std::string executable;    // /proc/<pid>/exe target
+    std::string windowsExe;    // Wine/Proton: the .exe being run, e.g. "witcher3.exe"
+    std::string steamAppId;    // SteamAppId / SteamGameId from the environment
+    std::string flatpakAppId;  // FLATPAK_ID or the sandbox's .flatpak-info
+
+    // What profiles match on: the Windows .exe under Wine, otherwise the real executable
+    const std::string& matchName() const { return windowsExe.empty() ? executable : windowsExe; }
+    // "steam:<id>" or the flatpak app-id; empty when neither applies
+    std::string appId() const;
+};
+
+// pid -> identity table. exe, cmdline and environ are read once per process image.
+// With the netlink proc connector (needs CAP_NET_ADMIN) exec and exit events evict
+// entries as they happen. Without it, each hit is checked against the process start
+// time (one small read of /proc/<pid>/stat), and dead pids are pruned with a /proc
+// directory diff once the table has grown.
+class ProcessResolver {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t execEvents = 0;
+        uint64_t exitEvents = 0;
+        uint64_t pruned = 0;
+        bool connector = false;
+    };
+
+    ProcessResolver() = default;
+    ~ProcessResolver();
+
+    ProcessResolver(const ProcessResolver&) = delete;
+    ProcessResolver& operator=(const ProcessResolver&) = delete;
+
+    // Subscribes to proc connector events; false means the /proc fallback is in use
+    bool start();
+    void stop();
+
+    // Empty identity (pid -1) when the process is gone or unreadable
+    ProcessIdentity resolve(int pid);
+    Stats getStats() const;
+
+    // Pure parsing helpers
+    static std::string windowsExeFromCmdline(const std::string& cmdline);
+    static bool isWineLoader(const std::string& executable);
+
+private:
+    struct Entry {
+        ProcessIdentity identity;
+        uint64_t startTime = 0;
+    };
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<int, Entry> m_table;
+    size_t m_pruneThreshold = 256;
+
+    int m_socket = -1;
+    int m_stopFd = -1;
+    std::thread m_thread;
+    std::atomic<bool> m_connector{false};
+
+    std::atomic<uint64_t> m_hits{0};
+    std::atomic<uint64_t> m_misses{0};
+    std::atomic<uint64_t> m_execEvents{0};
+    std::atomic<uint64_t> m_exitEvents{0};
+    std::atomic<uint64_t> m_pruned{0};
+
+    void run();
+    bool subscribe(bool enable);
+    void pruneLocked();
+    static bool readIdentity(int pid, ProcessIdentity& identity);
+    static uint64_t readStartTime(int pid);
+};
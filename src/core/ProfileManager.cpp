@@ -0,0 +1,321 @@
+#include "ProfileManager.h"
+#include "ConfigWatcher.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "../backends/ActiveWindowTracker.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <set>
+
+ProfileManager::ProfileManager(const std::string& configDirectory, ApplyFunction apply,
+                               RestoreFunction restore, PrewarmFunction prewarm)
+    : m_configDirectory(configDirectory)
+    , m_apply(std::move(apply))
+    , m_restore(std::move(restore))
+    , m_prewarm(std::move(prewarm))
+    , m_store(configDirectory) {}
+
+ProfileManager::~ProfileManager() {
+    m_configWatcher.reset();
+    stopMonitoring();
+}
+
+std::string ProfileManager::getConfigDirectory() {
+    const char* home = std::getenv("HOME");
+    return std::string(home ? home : "") + "/.config/vivid";
+}
+
+void ProfileManager::load() {
+    ProfileSnapshot profiles;
+    {
+        std::lock_guard<std::mutex> storeLock(m_storeMutex);
+        ProfileSet set;
+        if (!m_store.load(set.profiles)) {
+            LOG_ERROR << "Profile store " << m_store.getSnapshotPath()
+                      << " is corrupt; starting with no profiles";
+        } else if (set.profiles.empty() && readLegacyProfiles(set.profiles)) {
+            m_store.compact(set.profiles);
+        }
+        set.matcher.build(set.profiles);
+        m_profiles.publish(std::move(set));
+        profiles = m_profiles.load();
+    }
+
+    if (m_prewarm) {
+        for (const auto& profile : profiles->profiles) {
+            m_prewarm(profile);
+        }
+    }
+
+    // Another instance or a sync tool may change the store while we run, and profiles.conf
+    // is still edited by hand
+    if (!m_configWatcher) {
+        m_configWatcher = std::make_unique<ConfigWatcher>(
+            m_configDirectory, std::set<std::string>{"profiles.db", "profiles.journal", "profiles.conf"},
+            [this](const std::set<std::string>& files) {
+                if (files.count("profiles.db") || files.count("profiles.journal")) reload();
+                if (files.count("profiles.conf")) importLegacyProfiles();
+            });
+        if (!m_configWatcher->start()) {
+            LOG_WARN << "Profile changes made outside this instance will not be picked up";
+        }
+    }
+}
+
+bool ProfileManager::saveProfile(const AppProfile& profile) {
+    std::lock_guard<std::mutex> storeLock(m_storeMutex);
+
+    // One journal record per save. Readers only see the profile once it is on disk, so
+    // memory never holds one that a restart would lose.
+    if (!m_store.put(profile)) return false;
+
+    ProfileSnapshot profiles = m_profiles.update([&](ProfileSet& set) {
+        auto it = std::find_if(set.profiles.begin(), set.profiles.end(),
+                               [&](const AppProfile& p) { return p.name == profile.name; });
+
+        if (it != set.profiles.end()) {
+            *it = profile;
+        } else {
+            set.profiles.push_back(profile);
+        }
+        set.matcher.build(set.profiles);
+    });
+    if (m_prewarm) m_prewarm(profile);
+
+    // The snapshot is rewritten only once the journal outgrows it
+    if (m_store.needsCompaction()) {
+        m_store.compact(profiles->profiles);
+    }
+    return true;
+}
+
+bool ProfileManager::deleteProfile(const std::string& name) {
+    std::lock_guard<std::mutex> storeLock(m_storeMutex);
+    if (m_profiles.load()->matcher.findByName(name) == ProfileMatcher::kNoMatch) {
+        return false;
+    }
+    if (!m_store.remove(name)) return false;
+
+    ProfileSnapshot profiles = m_profiles.update([&](ProfileSet& set) {
+        set.profiles.erase(std::remove_if(set.profiles.begin(), set.profiles.end(),
+                                          [&](const AppProfile& p) { return p.name == name; }),
+                           set.profiles.end());
+        set.matcher.build(set.profiles);
+    });
+
+    if (m_store.needsCompaction()) {
+        m_store.compact(profiles->profiles);
+    }
+    return true;
+}
+
+ProfileSnapshot ProfileManager::getProfiles() {
+    return m_profiles.load();
+}
+
+bool ProfileManager::findProfile(const std::string& name, AppProfile& profile) {
+    ProfileSnapshot profiles = m_profiles.load();
+    int index = profiles->matcher.findByName(name);
+    if (index == ProfileMatcher::kNoMatch) return false;
+    profile = profiles->profiles[index];
+    return true;
+}
+
+bool ProfileManager::applyProfile(const std::string& name) {
+    AppProfile profile;
+    if (!findProfile(name, profile)) return false;
+
+    std::lock_guard<std::mutex> lock(m_activeMutex);
+    return switchToLocked(profile.name, profile.displayVibrance);
+}
+
+std::string ProfileManager::getActiveProfile() {
+    std::lock_guard<std::mutex> lock(m_activeMutex);
+    return m_activeProfile;
+}
+
+void ProfileManager::reload() {
+    auto start = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> storeLock(m_storeMutex);
+
+    // Our own saves land here too; they are already published
+    if (!m_store.hasExternalChanges()) return;
+
+    // Build the next version beside the live one (no writer can run: we hold m_storeMutex);
+    // readers see the old set until it is published whole
+    ProfileSet next;
+    next.profiles = m_profiles.load()->profiles;
+    ProfileStore::Refresh result = m_store.refresh(next.profiles);
+    if (result == ProfileStore::Refresh::UNCHANGED) return;
+    if (result == ProfileStore::Refresh::FAILED) {
+        m_reloadStats.failed++;
+        return;
+    }
+
+    next.matcher.build(next.profiles);
+    size_t count = next.profiles.size();
+    m_profiles.publish(std::move(next));
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    m_reloadStats.reloads++;
+    if (result == ProfileStore::Refresh::INCREMENTAL) {
+        m_reloadStats.incremental++;
+    } else {
+        m_reloadStats.full++;
+    }
+    m_reloadStats.recordsParsed += m_store.getLastRecordCount();
+    m_reloadStats.lastMs = ms;
+    m_reloadStats.maxMs = std::max(m_reloadStats.maxMs, ms);
+    m_reloadStats.totalMs += ms;
+
+    LOG_INFO << "Reloaded " << count << " profiles (" << m_store.getLastRecordCount()
+             << " records read, " << ms << " ms)";
+}
+
+ProfileReloadStats ProfileManager::getReloadStats() {
+    std::lock_guard<std::mutex> storeLock(m_storeMutex);
+    return m_reloadStats;
+}
+
+bool ProfileManager::readLegacyProfiles(std::vector<AppProfile>& profiles) {
+    // profiles.conf only ever held "profile:<name>:<executable>" lines
+    std::ifstream file(m_configDirectory + "/profiles.conf");
+    if (!file.is_open()) return false;
+
+    size_t before = profiles.size();
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.rfind("profile:", 0) != 0) continue;
+        size_t separator = line.find(':', 8);
+        if (separator == std::string::npos) continue;
+
+        AppProfile profile;
+        profile.name = line.substr(8, separator - 8);
+        profile.executable = line.substr(separator + 1);
+        profile.pathMatching = false;
+        profile.enabled = true;
+        profiles.push_back(profile);
+    }
+    return profiles.size() > before;
+}
+
+void ProfileManager::importLegacyProfiles() {
+    std::vector<AppProfile> legacy;
+    if (!readLegacyProfiles(legacy)) return;
+
+    std::lock_guard<std::mutex> storeLock(m_storeMutex);
+
+    // The file names an executable per profile and nothing else: a line adds the profile
+    // or retargets it, keeping its display values. Profiles the file does not mention
+    // were saved some other way and stay.
+    ProfileSet next;
+    next.profiles = m_profiles.load()->profiles;
+    size_t imported = 0;
+    for (const auto& entry : legacy) {
+        auto it = std::find_if(next.profiles.begin(), next.profiles.end(),
+                               [&](const AppProfile& p) { return p.name == entry.name; });
+        AppProfile profile = (it != next.profiles.end()) ? *it : entry;
+        if (it != next.profiles.end() && it->executable == entry.executable) continue;
+        profile.executable = entry.executable;
+
+        // Each one is on disk before readers can see it, as with saveProfile
+        if (!m_store.put(profile)) break;
+        if (it != next.profiles.end()) {
+            *it = profile;
+        } else {
+            next.profiles.push_back(profile);
+        }
+        imported++;
+    }
+    if (imported == 0) return;
+
+    next.matcher.build(next.profiles);
+    m_profiles.publish(std::move(next));
+    if (m_store.needsCompaction()) {
+        m_store.compact(m_profiles.load()->profiles);
+    }
+    LOG_INFO << "Imported " << imported << " profiles from profiles.conf";
+}
+
+void ProfileManager::startMonitoring() {
+    m_monitoring = true;
+
+#ifdef HAVE_X11
+    // Focus changes arrive as PropertyNotify; nothing runs while focus stays put
+    if (!m_windowTracker) {
+        // Exec/exit events keep the pid table exact when we may listen to them
+        m_processResolver.start();
+
+        auto tracker = std::make_unique<ActiveWindowTracker>([this](const ActiveWindow& window) {
+            // WM_CLASS says "wine64-preloader" for every Wine game; the process knows better
+            ProcessIdentity identity = m_processResolver.resolve(window.pid);
+            if (identity.pid > 0) {
+                applyProfileForApp(identity.matchName(), window.title, identity.appId());
+            } else {
+                applyProfileForApp(window.instance, window.title);
+            }
+        });
+        if (tracker->start()) {
+            m_windowTracker = std::move(tracker);
+        } else {
+            LOG_WARN << "No focus tracking: profiles only switch when applied by name";
+        }
+    }
+#endif
+}
+
+void ProfileManager::stopMonitoring() {
+    m_monitoring = false;
+    m_windowTracker.reset();
+    m_processResolver.stop();
+}
+
+std::string ProfileManager::getActiveWindowTitle() {
+    return m_windowTracker ? m_windowTracker->getActiveWindow().title : "";
+}
+
+void ProfileManager::applyProfileForApp(const std::string& appName, const std::string& windowTitle,
+                                        const std::string& appId) {
+    std::string matched;
+    std::map<std::string, float> targets;
+    {
+        ProfileSnapshot profiles = m_profiles.load();
+        int index = profiles->matcher.match({appName, windowTitle, appId});
+        if (index != ProfileMatcher::kNoMatch) {
+            matched = profiles->profiles[index].name;
+            targets = profiles->profiles[index].displayVibrance;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_activeMutex);
+    // Focus moving between windows of the same profile changes nothing on screen
+    if (matched == m_activeProfile) return;
+    if (!matched.empty()) {
+        LOG_DEBUG << "  Profile " << matched << " for " << appName;
+    }
+    switchToLocked(matched, targets);
+}
+
+bool ProfileManager::switchToLocked(const std::string& matched, const std::map<std::string, float>& targets) {
+    if (m_activeProfile.empty() && !matched.empty()) {
+        m_restoreVibrance = m_restore();
+    }
+    m_activeProfile = matched;
+    Metrics::count(Counter::PROFILE_SWITCHES);
+
+    bool ok = true;
+    if (matched.empty()) {
+        for (const auto& pair : m_restoreVibrance) {
+            ok &= m_apply(pair.first, pair.second);
+        }
+        m_restoreVibrance.clear();
+        return ok;
+    }
+
+    for (const auto& pair : targets) {
+        ok &= m_apply(pair.first, pair.second);
+    }
+    return ok;
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "AppProfile.h"
+#include "ProcessResolver.h"
+#include "ProfileMatcher.h"
+#include "ProfileStore.h"
+#include "SnapshotCell.h"
+
+class ActiveWindowTracker;
+class ConfigWatcher;
+
+// Profiles and the matcher compiled from them, published together so a lookup never
+// pairs an index with a different list
+struct ProfileSet {
+    std::vector<AppProfile> profiles;
+    ProfileMatcher matcher;
+};
+
+using ProfileSnapshot = SnapshotCell<ProfileSet>::Snapshot;
+
+// Live reloads of the profile store after another writer changed it
+struct ProfileReloadStats {
+    uint64_t reloads = 0;
+    uint64_t incremental = 0;    // only appended journal records were parsed
+    uint64_t full = 0;
+    uint64_t failed = 0;
+    uint64_t recordsParsed = 0;
+    double lastMs = 0.0;
+    double maxMs = 0.0;
+    double totalMs = 0.0;
+};
+
+// The per-application half of vivid: the profile store, the matcher, live reload and
+// focus-driven switching. It owns no display; whoever owns gamma (the daemon, or
+// VividManager) hands it the calls that set and read vibrance.
+class ProfileManager {
+public:
+    // Sets one display; called from the tracker thread as well as the caller's
+    using ApplyFunction = std::function<bool(const std::string& displayId, float vibrance)>;
+    // What to put back once no profile matches, read when a profile takes over
+    using RestoreFunction = std::function<std::map<std::string, float>()>;
+    // Optional: builds whatever a switch to this profile will need, ahead of time
+    using PrewarmFunction = std::function<void(const AppProfile& profile)>;
+
+    ProfileManager(const std::string& configDirectory, ApplyFunction apply, RestoreFunction restore,
+                   PrewarmFunction prewarm = PrewarmFunction());
+    ~ProfileManager();
+
+    ProfileManager(const ProfileManager&) = delete;
+    ProfileManager& operator=(const ProfileManager&) = delete;
+
+    // Reads the store and starts watching it for changes made by other writers
+    void load();
+
+    bool saveProfile(const AppProfile& profile);
+    bool deleteProfile(const std::string& name);
+    ProfileSnapshot getProfiles();  // lock-free; hold the snapshot while iterating
+    bool findProfile(const std::string& name, AppProfile& profile);
+    // Switches to the named profile now; focus moving to a window that matches
+    // differently switches again. False when it is unknown or a display refused it.
+    bool applyProfile(const std::string& name);
+    std::string getActiveProfile();
+    ProfileReloadStats getReloadStats();
+
+    // Focus tracking; does nothing without X11
+    void startMonitoring();
+    void stopMonitoring();
+    bool isMonitoring() const { return m_monitoring; }
+    std::string getActiveWindowTitle();
+
+    static std::string getConfigDirectory();
+
+private:
+    std::string m_configDirectory;
+    ApplyFunction m_apply;
+    RestoreFunction m_restore;
+    PrewarmFunction m_prewarm;
+
+    ProfileStore m_store;
+    SnapshotCell<ProfileSet> m_profiles;  // written under m_storeMutex
+
+    // Profile writers (save, delete, reload) hold this for the whole edit; matching
+    // never takes it, so it never waits on disk
+    std::mutex m_storeMutex;
+    std::unique_ptr<ConfigWatcher> m_configWatcher;
+    ProfileReloadStats m_reloadStats;
+
+    // Held across a switch, so the tracker and an explicit apply never interleave
+    std::mutex m_activeMutex;
+    std::string m_activeProfile;
+    std::map<std::string, float> m_restoreVibrance;  // captured when a profile took over
+
+    std::atomic<bool> m_monitoring{false};
+    ProcessResolver m_processResolver;
+    std::unique_ptr<ActiveWindowTracker> m_windowTracker;
+
+    void reload();
+    // Appends what profiles.conf holds; false when it has nothing
+    bool readLegacyProfiles(std::vector<AppProfile>& profiles);
+    // Merges profiles.conf into the store after it was edited
+    void importLegacyProfiles();
+    void applyProfileForApp(const std::string& appName, const std::string& windowTitle,
+                            const std::string& appId = "");
+    // matched empty restores what was on screen before any profile; false if a display failed
+    bool switchToLocked(const std::string& matched, const std::map<std::string, float>& targets);
+};
@@ -0,0 +1,185 @@
+#include "ProfileMatcher.h"
+#include <algorithm>
+#include <deque>
+
+namespace {
+
+std::string basename(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return (slash == std::string::npos) ? path : path.substr(slash + 1);
+}
+
+// Calls visit for each non-empty component, so "/opt//games/" is {"opt", "games"}
+template <typename Visit>
+void forEachComponent(const std::string& path, Visit visit) {
+    size_t start = 0;
+    while (start < path.size()) {
+        size_t end = path.find('/', start);
+        if (end == std::string::npos) end = path.size();
+        if (end > start && !visit(path.substr(start, end - start))) return;
+        start = end + 1;
+    }
+}
+
+int better(int a, int b) {
+    if (a == ProfileMatcher::kNoMatch) return b;
+    if (b == ProfileMatcher::kNoMatch) return a;
+    return std::min(a, b);
+}
+
+} // namespace
+
+void ProfileMatcher::build(const std::vector<AppProfile>& profiles) {
+    m_byName.clear();
+    m_byExecutable.clear();
+    m_pathNodes.assign(1, PathNode());
+    m_states.assign(1, TitleState());
+
+    for (size_t i = 0; i < profiles.size(); i++) {
+        const AppProfile& profile = profiles[i];
+        int index = static_cast<int>(i);
+        m_byName.emplace(profile.name, index);
+        if (!profile.enabled) continue;
+
+        if (!profile.executable.empty()) {
+            if (profile.pathMatching) {
+                addPath(profile.executable, index);
+            } else {
+                // emplace keeps the first profile for a key, which is the one that wins
+                m_byExecutable.emplace(profile.executable, index);
+                m_byExecutable.emplace(basename(profile.executable), index);
+            }
+        }
+        if (!profile.windowTitle.empty()) {
+            addTitle(profile.windowTitle, index);
+        }
+    }
+    linkTitles();
+}
+
+int ProfileMatcher::match(const MatchQuery& query) const {
+    if (!query.appId.empty()) {
+        auto it = m_byExecutable.find(query.appId);
+        if (it != m_byExecutable.end()) return it->second;
+    }
+
+    if (!query.executable.empty()) {
+        auto it = m_byExecutable.find(query.executable);
+        if (it == m_byExecutable.end()) {
+            it = m_byExecutable.find(basename(query.executable));
+        }
+        if (it != m_byExecutable.end()) return it->second;
+
+        int byPath = matchPath(query.executable);
+        if (byPath != kNoMatch) return byPath;
+    }
+    return query.title.empty() ? kNoMatch : matchTitle(query.title);
+}
+
+int ProfileMatcher::findByName(const std::string& name) const {
+    auto it = m_byName.find(name);
+    return (it != m_byName.end()) ? it->second : kNoMatch;
+}
+
+void ProfileMatcher::addPath(const std::string& path, int profile) {
+    int node = 0;
+    forEachComponent(path, [&](const std::string& component) {
+        auto it = m_pathNodes[node].children.find(component);
+        if (it != m_pathNodes[node].children.end()) {
+            node = it->second;
+        } else {
+            int child = static_cast<int>(m_pathNodes.size());
+            m_pathNodes[node].children.emplace(component, child);
+            m_pathNodes.emplace_back();
+            node = child;
+        }
+        return true;
+    });
+    if (node != 0 && m_pathNodes[node].profile == kNoMatch) {
+        m_pathNodes[node].profile = profile;
+    }
+}
+
+int ProfileMatcher::matchPath(const std::string& path) const {
+    if (path.empty() || path[0] != '/' || m_pathNodes.size() <= 1) return kNoMatch;
+
+    // Deepest prefix wins: /opt/games/foo/ is more specific than /opt/games/
+    int node = 0;
+    int found = kNoMatch;
+    forEachComponent(path, [&](const std::string& component) {
+        auto it = m_pathNodes[node].children.find(component);
+        if (it == m_pathNodes[node].children.end()) return false;
+        node = it->second;
+        if (m_pathNodes[node].profile != kNoMatch) found = m_pathNodes[node].profile;
+        return true;
+    });
+    return found;
+}
+
+void ProfileMatcher::addTitle(const std::string& pattern, int profile) {
+    int state = 0;
+    for (unsigned char byte : pattern) {
+        auto& edges = m_states[state].edges;
+        auto it = std::lower_bound(edges.begin(), edges.end(), std::make_pair(byte, 0));
+        if (it != edges.end() && it->first == byte) {
+            state = it->second;
+        } else {
+            int next = static_cast<int>(m_states.size());
+            edges.insert(it, {byte, next});
+            m_states.emplace_back();
+            state = next;
+        }
+    }
+    m_states[state].best = better(m_states[state].best, profile);
+}
+
+void ProfileMatcher::linkTitles() {
+    // Breadth-first, so every fail target is final before its dependants are linked
+    std::deque<int> queue;
+    for (const auto& edge : m_states[0].edges) {
+        m_states[edge.second].fail = 0;
+        queue.push_back(edge.second);
+    }
+
+    while (!queue.empty()) {
+        int state = queue.front();
+        queue.pop_front();
+
+        for (const auto& edge : m_states[state].edges) {
+            int child = edge.second;
+            int fail = m_states[state].fail;
+            while (fail != 0 && step(fail, edge.first) == kNoMatch) {
+                fail = m_states[fail].fail;
+            }
+            int target = step(fail, edge.first);
+            m_states[child].fail = (target != kNoMatch && target != child) ? target : 0;
+
+            // Fold the fail chain's outputs in now so matching never walks it
+            m_states[child].best = better(m_states[child].best, m_states[m_states[child].fail].best);
+            queue.push_back(child);
+        }
+    }
+}
+
+int ProfileMatcher::step(int state, unsigned char byte) const {
+    const auto& edges = m_states[state].edges;
+    auto it = std::lower_bound(edges.begin(), edges.end(), std::make_pair(byte, 0));
+    return (it != edges.end() && it->first == byte) ? it->second : kNoMatch;
+}
+
+int ProfileMatcher::matchTitle(const std::string& title) const {
+    if (m_states.size() <= 1) return kNoMatch;
+
+    int state = 0;
+    int found = kNoMatch;
+    for (unsigned char byte : title) {
+        int next;
+        while ((next = step(state, byte)) == kNoMatch && state != 0) {
+            state = m_states[state].fail;
+        }
+        state = (next == kNoMatch) ? 0 : next;
+        found = better(found, m_states[state].best);
+        if (found == 0) break;  // nothing can beat the first profile
+    }
+    return found;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "AppProfile.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct MatchQuery {
+    std::string executable;  // full path when known, otherwise the bare name
+    std::string title;
+    std::string appId;       // "steam:<id>" or a flatpak app-id; matched like an executable
+};
+
+// Profiles compiled for focus-change lookups. Built once per profile change; a match
+// then costs one hash lookup, one walk down the path trie and one pass over the title,
+// however many profiles there are.
+//
+// Priority: app id, then exact executable (full string, then basename), then the
+// longest path prefix, then a title substring. Ties go to the profile listed first.
+class ProfileMatcher {
+public:
+    static constexpr int kNoMatch = -1;
+
+    void build(const std::vector<AppProfile>& profiles);
+
+    // Index into the profiles passed to build(), or kNoMatch
+    int match(const MatchQuery& query) const;
+    int findByName(const std::string& name) const;
+
+    size_t getTitleStateCount() const { return m_states.size(); }
+
+private:
+    struct PathNode {
+        std::unordered_map<std::string, int> children;  // keyed by path component
+        int profile = kNoMatch;
+    };
+
+    // Aho-Corasick state; edges sorted by byte
+    struct TitleState {
+        std::vector<std::pair<unsigned char, int>> edges;
+        int fail = 0;
+        int best = kNoMatch;  // lowest profile index ending here or on the fail chain
+    };
+
+    std::unordered_map<std::string, int> m_byName;
+    std::unordered_map<std::string, int> m_byExecutable;
+    std::vector<PathNode> m_pathNodes;
+    std::vector<TitleState> m_states;
+
+    void addPath(const std::string& path, int profile);
+    int matchPath(const std::string& path) const;
+    void addTitle(const std::string& pattern, int profile);
+    void linkTitles();
+    int matchTitle(const std::string& title) const;
+    int step(int state, unsigned char byte) const;
+};
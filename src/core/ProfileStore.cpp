@@ -0,0 +1,575 @@
+#include "ProfileStore.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace {
+
+constexpr char kMagic[4] = {'V', 'V', 'P', 'S'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kMinCompactBytes = 64 * 1024;
+
+constexpr uint32_t kFlagPathMatching = 1u << 0;
+constexpr uint32_t kFlagEnabled = 1u << 1;
+
+enum JournalOp : uint8_t {
+    JOURNAL_PUT = 1,
+    JOURNAL_REMOVE = 2
+};
+
+// Every record is a multiple of 4 bytes, so a page-aligned mapping can be read in place
+struct StringRef {
+    uint32_t offset;  // into the string bytes
+    uint32_t length;
+};
+
+struct SnapshotHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t profileCount;
+    uint32_t vibranceCount;
+    uint32_t stringBytes;
+    uint32_t checksum;  // over everything after the header
+};
+
+struct ProfileRecord {
+    StringRef name;
+    StringRef executable;
+    StringRef windowTitle;
+    uint32_t firstVibrance;
+    uint32_t vibranceCount;
+    uint32_t flags;
+};
+
+struct VibranceRecord {
+    StringRef display;
+    float value;
+};
+
+struct JournalHeader {
+    uint32_t size;      // payload bytes
+    uint32_t checksum;  // over the payload
+};
+
+uint32_t fnv1a(const char* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+int64_t modifiedNs(const struct stat& info) {
+    return static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+}
+
+uint32_t profileFlags(const AppProfile& profile) {
+    return (profile.pathMatching ? kFlagPathMatching : 0) | (profile.enabled ? kFlagEnabled : 0);
+}
+
+template <typename T>
+void appendValue(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendString(std::string& out, const std::string& value) {
+    appendValue(out, static_cast<uint32_t>(value.size()));
+    out += value;
+}
+
+// Bounds-checked cursor over a journal payload
+struct Reader {
+    const char* data;
+    size_t size;
+    size_t offset = 0;
+    bool ok = true;
+
+    template <typename T>
+    T value() {
+        T result{};
+        if (size - offset < sizeof(T)) {
+            ok = false;
+            return result;
+        }
+        std::memcpy(&result, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return result;
+    }
+
+    std::string string() {
+        uint32_t length = value<uint32_t>();
+        if (!ok || size - offset < length) {
+            ok = false;
+            return "";
+        }
+        std::string result(data + offset, length);
+        offset += length;
+        return result;
+    }
+};
+
+// Name -> position during a replay. A live reload usually applies one or two records,
+// so the first few lookups scan; hashing every profile only pays off after that.
+struct NameIndex {
+    static constexpr int kScanLimit = 8;
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    const std::vector<AppProfile>& profiles;
+    const std::vector<bool>& removed;
+    std::unordered_map<std::string, size_t> positions;
+    bool built = false;
+    int scans = 0;
+
+    NameIndex(const std::vector<AppProfile>& profiles, const std::vector<bool>& removed)
+        : profiles(profiles), removed(removed) {}
+
+    size_t find(const std::string& name) {
+        if (!built && ++scans > kScanLimit) {
+            for (size_t i = 0; i < profiles.size(); i++) {
+                if (!removed[i]) positions.emplace(profiles[i].name, i);
+            }
+            built = true;
+        }
+        if (built) {
+            auto it = positions.find(name);
+            return (it != positions.end()) ? it->second : npos;
+        }
+        for (size_t i = 0; i < profiles.size(); i++) {
+            if (!removed[i] && profiles[i].name == name) return i;
+        }
+        return npos;
+    }
+
+    void added(const std::string& name, size_t position) {
+        if (built) positions.emplace(name, position);
+    }
+
+    void erased(const std::string& name) {
+        if (built) positions.erase(name);
+    }
+};
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+std::string readAll(int fd) {
+    std::string contents;
+    char buffer[65536];
+    ssize_t length;
+    while ((length = read(fd, buffer, sizeof(buffer))) != 0) {
+        if (length < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        contents.append(buffer, static_cast<size_t>(length));
+    }
+    return contents;
+}
+
+} // namespace
+
+ProfileStore::ProfileStore(const std::string& directory)
+    : m_directory(directory)
+    , m_snapshotPath(directory + "/profiles.db")
+    , m_journalPath(directory + "/profiles.journal") {
+}
+
+ProfileStore::~ProfileStore() {
+    if (m_journalFd >= 0) close(m_journalFd);
+}
+
+bool ProfileStore::load(std::vector<AppProfile>& profiles) {
+    profiles.clear();
+    m_snapshotBytes = 0;
+    m_journalBytes = 0;
+    m_lastRecords = 0;
+    m_snapshotId = FileId();
+    m_journalId = FileId();
+
+    int fd = open(m_snapshotPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        struct stat info;
+        bool ok = fstat(fd, &info) == 0;
+        if (ok && info.st_size > 0) {
+            size_t size = static_cast<size_t>(info.st_size);
+            void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ok = mapping != MAP_FAILED && decodeSnapshot(static_cast<const char*>(mapping), size, profiles);
+            if (mapping != MAP_FAILED) munmap(mapping, size);
+            m_snapshotBytes = size;
+        }
+        if (ok) {
+            m_snapshotId = fileId(info);
+        }
+        close(fd);
+        if (!ok) {
+            profiles.clear();
+            return false;
+        }
+    }
+    m_lastRecords = profiles.size();
+
+    // The journal may have been replaced underneath us; appends must go to the current file
+    if (m_journalFd >= 0) {
+        close(m_journalFd);
+        m_journalFd = -1;
+    }
+    if (access(m_journalPath.c_str(), F_OK) != 0 || !openJournal()) return true;
+
+    lseek(m_journalFd, 0, SEEK_SET);
+    std::string journal = readAll(m_journalFd);
+    size_t records = 0;
+    m_journalBytes = replayJournal(journal, profiles, records);
+    m_lastRecords += records;
+
+    // Drop a torn tail so the next append starts on a record boundary
+    if (m_journalBytes < journal.size()) {
+        int truncated = ftruncate(m_journalFd, static_cast<off_t>(m_journalBytes));
+        (void)truncated;
+    }
+    return true;
+}
+
+bool ProfileStore::hasExternalChanges() const {
+    FileId snapshot = statFile(m_snapshotPath);
+    if (!sameFile(snapshot, m_snapshotId) || snapshot.size != m_snapshotId.size ||
+        snapshot.modifiedNs != m_snapshotId.modifiedNs) {
+        return true;
+    }
+
+    // The journal's mtime moves with our own appends; its length is what we track
+    FileId journal = statFile(m_journalPath);
+    return !sameFile(journal, m_journalId) || (journal.exists && journal.size != m_journalBytes);
+}
+
+ProfileStore::Refresh ProfileStore::refresh(std::vector<AppProfile>& profiles) {
+    if (!hasExternalChanges()) {
+        m_lastRecords = 0;
+        return Refresh::UNCHANGED;
+    }
+
+    // A new snapshot or a journal that was replaced or compacted: the records we applied
+    // are no longer a prefix of what is on disk
+    FileId snapshot = statFile(m_snapshotPath);
+    FileId journal = statFile(m_journalPath);
+    bool sameSnapshot = sameFile(snapshot, m_snapshotId) && snapshot.size == m_snapshotId.size &&
+                        snapshot.modifiedNs == m_snapshotId.modifiedNs;
+    bool appended = journal.exists && sameFile(journal, m_journalId) && journal.size >= m_journalBytes;
+    if (!sameSnapshot || !appended) {
+        return load(profiles) ? Refresh::FULL : Refresh::FAILED;
+    }
+
+    // Only the records appended since our last read
+    std::string tail(journal.size - m_journalBytes, '\0');
+    ssize_t length = pread(m_journalFd, &tail[0], tail.size(), static_cast<off_t>(m_journalBytes));
+    if (length < 0) return Refresh::FAILED;
+    tail.resize(static_cast<size_t>(length));
+
+    // A record still being written stays unread until the next change event
+    size_t records = 0;
+    m_journalBytes += replayJournal(tail, profiles, records);
+    m_lastRecords = records;
+    return Refresh::INCREMENTAL;
+}
+
+bool ProfileStore::put(const AppProfile& profile) {
+    std::string payload;
+    appendValue(payload, static_cast<uint8_t>(JOURNAL_PUT));
+    appendString(payload, profile.name);
+    appendString(payload, profile.executable);
+    appendString(payload, profile.windowTitle);
+    appendValue(payload, profileFlags(profile));
+    appendValue(payload, static_cast<uint32_t>(profile.displayVibrance.size()));
+    for (const auto& pair : profile.displayVibrance) {
+        appendString(payload, pair.first);
+        appendValue(payload, pair.second);
+    }
+    return append(payload);
+}
+
+bool ProfileStore::remove(const std::string& name) {
+    std::string payload;
+    appendValue(payload, static_cast<uint8_t>(JOURNAL_REMOVE));
+    appendString(payload, name);
+    return append(payload);
+}
+
+bool ProfileStore::needsCompaction() const {
+    return m_journalBytes > std::max(kMinCompactBytes, m_snapshotBytes);
+}
+
+bool ProfileStore::compact(const std::vector<AppProfile>& profiles) {
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+
+    std::string snapshot = encodeSnapshot(profiles);
+    std::string tempPath = m_snapshotPath + ".tmp";
+
+    int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    struct stat info;
+    bool ok = writeAll(fd, snapshot.data(), snapshot.size()) && fsync(fd) == 0 && fstat(fd, &info) == 0;
+    close(fd);
+
+    // The new snapshot must be durable under its final name before the journal goes;
+    // a crash in between only replays edits the snapshot already holds
+    if (!ok || rename(tempPath.c_str(), m_snapshotPath.c_str()) != 0) {
+        unlink(tempPath.c_str());
+        return false;
+    }
+    int dirFd = open(m_directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd >= 0) {
+        fsync(dirFd);
+        close(dirFd);
+    }
+    m_snapshotBytes = snapshot.size();
+    m_snapshotId = fileId(info);
+
+    if (openJournal() && ftruncate(m_journalFd, 0) == 0) {
+        fdatasync(m_journalFd);
+        m_journalBytes = 0;
+    }
+    return true;
+}
+
+bool ProfileStore::openJournal() {
+    if (m_journalFd >= 0) return true;
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+    m_journalFd = open(m_journalPath.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (m_journalFd < 0) return false;
+
+    struct stat info;
+    if (fstat(m_journalFd, &info) == 0) {
+        m_journalId = fileId(info);
+    }
+    return true;
+}
+
+bool ProfileStore::append(const std::string& payload) {
+    if (!openJournal()) return false;
+
+    JournalHeader header;
+    header.size = static_cast<uint32_t>(payload.size());
+    header.checksum = fnv1a(payload.data(), payload.size());
+
+    // One write per record, so a crash leaves at most one torn record at the tail
+    std::string record;
+    record.reserve(sizeof(header) + payload.size());
+    appendValue(record, header);
+    record += payload;
+
+    if (!writeAll(m_journalFd, record.data(), record.size()) || fdatasync(m_journalFd) != 0) {
+        return false;
+    }
+
+    // If another writer appended since our last read, leave the offset alone: refresh()
+    // then replays their records and ours in file order
+    off_t end = lseek(m_journalFd, 0, SEEK_CUR);
+    if (end >= 0 && static_cast<size_t>(end) == m_journalBytes + record.size()) {
+        m_journalBytes = static_cast<size_t>(end);
+    }
+    return true;
+}
+
+size_t ProfileStore::replayJournal(const std::string& journal, std::vector<AppProfile>& profiles,
+                                   size_t& records) {
+    std::vector<bool> removed(profiles.size(), false);
+    NameIndex index(profiles, removed);
+
+    size_t offset = 0;
+    while (journal.size() - offset >= sizeof(JournalHeader)) {
+        JournalHeader header;
+        std::memcpy(&header, journal.data() + offset, sizeof(header));
+        const char* payload = journal.data() + offset + sizeof(header);
+        if (journal.size() - offset - sizeof(header) < header.size ||
+            fnv1a(payload, header.size) != header.checksum) {
+            break;
+        }
+
+        Reader reader{payload, header.size};
+        uint8_t op = reader.value<uint8_t>();
+        if (op == JOURNAL_PUT) {
+            AppProfile profile;
+            profile.name = reader.string();
+            profile.executable = reader.string();
+            profile.windowTitle = reader.string();
+            uint32_t flags = reader.value<uint32_t>();
+            profile.pathMatching = (flags & kFlagPathMatching) != 0;
+            profile.enabled = (flags & kFlagEnabled) != 0;
+            uint32_t count = reader.value<uint32_t>();
+            for (uint32_t i = 0; i < count && reader.ok; i++) {
+                std::string display = reader.string();
+                float value = reader.value<float>();
+                profile.displayVibrance[display] = value;
+            }
+            if (!reader.ok) break;
+
+            // Same rule as ProfileManager::saveProfile: replace in place, otherwise append
+            size_t position = index.find(profile.name);
+            if (position != NameIndex::npos) {
+                profiles[position] = std::move(profile);
+            } else {
+                index.added(profile.name, profiles.size());
+                profiles.push_back(std::move(profile));
+                removed.push_back(false);
+            }
+        } else if (op == JOURNAL_REMOVE) {
+            std::string name = reader.string();
+            if (!reader.ok) break;
+
+            size_t position = index.find(name);
+            if (position != NameIndex::npos) {
+                removed[position] = true;
+                index.erased(name);
+            }
+        } else {
+            break;
+        }
+        offset += sizeof(header) + header.size;
+        records++;
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < profiles.size(); i++) {
+        if (removed[i]) continue;
+        if (kept != i) profiles[kept] = std::move(profiles[i]);
+        kept++;
+    }
+    profiles.resize(kept);
+    return offset;
+}
+
+ProfileStore::FileId ProfileStore::fileId(const struct stat& info) {
+    FileId id;
+    id.exists = true;
+    id.device = static_cast<uint64_t>(info.st_dev);
+    id.inode = static_cast<uint64_t>(info.st_ino);
+    id.size = static_cast<uint64_t>(info.st_size);
+    id.modifiedNs = modifiedNs(info);
+    return id;
+}
+
+ProfileStore::FileId ProfileStore::statFile(const std::string& path) {
+    struct stat info;
+    return (stat(path.c_str(), &info) == 0) ? fileId(info) : FileId();
+}
+
+bool ProfileStore::sameFile(const FileId& a, const FileId& b) {
+    return a.exists == b.exists && a.device == b.device && a.inode == b.inode;
+}
+
+std::string ProfileStore::encodeSnapshot(const std::vector<AppProfile>& profiles) {
+    std::vector<ProfileRecord> records;
+    std::vector<VibranceRecord> vibrance;
+    std::string strings;
+    records.reserve(profiles.size());
+
+    auto addString = [&strings](const std::string& value) {
+        StringRef ref = {static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(value.size())};
+        strings += value;
+        return ref;
+    };
+
+    for (const AppProfile& profile : profiles) {
+        ProfileRecord record;
+        record.name = addString(profile.name);
+        record.executable = addString(profile.executable);
+        record.windowTitle = addString(profile.windowTitle);
+        record.firstVibrance = static_cast<uint32_t>(vibrance.size());
+        record.vibranceCount = static_cast<uint32_t>(profile.displayVibrance.size());
+        record.flags = profileFlags(profile);
+        records.push_back(record);
+
+        for (const auto& pair : profile.displayVibrance) {
+            vibrance.push_back({addString(pair.first), pair.second});
+        }
+    }
+    strings.resize((strings.size() + 3) & ~size_t(3), '\0');
+
+    SnapshotHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.profileCount = static_cast<uint32_t>(records.size());
+    header.vibranceCount = static_cast<uint32_t>(vibrance.size());
+    header.stringBytes = static_cast<uint32_t>(strings.size());
+    header.checksum = 0;
+
+    std::string out;
+    out.reserve(sizeof(header) + records.size() * sizeof(ProfileRecord) +
+                vibrance.size() * sizeof(VibranceRecord) + strings.size());
+    appendValue(out, header);
+    out.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(ProfileRecord));
+    out.append(reinterpret_cast<const char*>(vibrance.data()), vibrance.size() * sizeof(VibranceRecord));
+    out += strings;
+
+    header.checksum = fnv1a(out.data() + sizeof(header), out.size() - sizeof(header));
+    std::memcpy(&out[0], &header, sizeof(header));
+    return out;
+}
+
+bool ProfileStore::decodeSnapshot(const char* data, size_t size, std::vector<AppProfile>& profiles) {
+    if (size < sizeof(SnapshotHeader)) return false;
+    const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(data);
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion) {
+        return false;
+    }
+
+    uint64_t expected = sizeof(SnapshotHeader) + uint64_t(header->profileCount) * sizeof(ProfileRecord) +
+                        uint64_t(header->vibranceCount) * sizeof(VibranceRecord) + header->stringBytes;
+    if (expected != size || fnv1a(data + sizeof(SnapshotHeader), size - sizeof(SnapshotHeader)) != header->checksum) {
+        return false;
+    }
+
+    const ProfileRecord* records = reinterpret_cast<const ProfileRecord*>(data + sizeof(SnapshotHeader));
+    const VibranceRecord* vibrance = reinterpret_cast<const VibranceRecord*>(records + header->profileCount);
+    const char* strings = reinterpret_cast<const char*>(vibrance + header->vibranceCount);
+
+    bool ok = true;
+    auto view = [&](const StringRef& ref) {
+        if (uint64_t(ref.offset) + ref.length > header->stringBytes) {
+            ok = false;
+            return std::string();
+        }
+        return std::string(strings + ref.offset, ref.length);
+    };
+
+    profiles.clear();
+    profiles.reserve(header->profileCount);
+    for (uint32_t i = 0; i < header->profileCount && ok; i++) {
+        const ProfileRecord& record = records[i];
+        if (uint64_t(record.firstVibrance) + record.vibranceCount > header->vibranceCount) return false;
+
+        AppProfile profile;
+        profile.name = view(record.name);
+        profile.executable = view(record.executable);
+        profile.windowTitle = view(record.windowTitle);
+        profile.pathMatching = (record.flags & kFlagPathMatching) != 0;
+        profile.enabled = (record.flags & kFlagEnabled) != 0;
+
+        // Records were written from a std::map, so keys arrive sorted: hint at the end
+        for (uint32_t j = 0; j < record.vibranceCount; j++) {
+            const VibranceRecord& entry = vibrance[record.firstVibrance + j];
+            profile.displayVibrance.emplace_hint(profile.displayVibrance.end(), view(entry.display), entry.value);
+        }
+        profiles.push_back(std::move(profile));
+    }
+    return ok;
+}
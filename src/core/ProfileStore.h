@@ -0,0 +1,88 @@
+#pragma once
+#include "AppProfile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct stat;
+
+// On-disk profile store: a memory-mapped snapshot plus an append-only journal of edits.
+//
+//   profiles.db       header | ProfileRecord[] | VibranceRecord[] | string bytes
+//   profiles.journal  { size, checksum, op, payload }...
+//
+// Loading maps the snapshot and builds profiles straight from the records; nothing is
+// parsed field by field. Each put/remove appends one journal record, so a save costs
+// one small write however many profiles exist. Once the journal outgrows the snapshot,
+// compact() writes a new snapshot beside the old one, renames it into place and empties
+// the journal. A torn journal tail (crash mid-append) is dropped on the next load.
+//
+// Not thread-safe; VividManager serialises every call.
+class ProfileStore {
+public:
+    enum class Refresh {
+        UNCHANGED,
+        INCREMENTAL,  // only records appended to the journal were read
+        FULL,         // the snapshot was replaced or the journal rewritten
+        FAILED
+    };
+
+    explicit ProfileStore(const std::string& directory);
+    ~ProfileStore();
+
+    ProfileStore(const ProfileStore&) = delete;
+    ProfileStore& operator=(const ProfileStore&) = delete;
+
+    // Snapshot, then journal replayed on top, in saved order. False only on a corrupt
+    // snapshot; missing files are an empty store.
+    bool load(std::vector<AppProfile>& profiles);
+
+    // Picks up what other writers (another instance, a sync tool) did since the last
+    // load or refresh. Our own writes are already accounted for and read as UNCHANGED.
+    bool hasExternalChanges() const;
+    Refresh refresh(std::vector<AppProfile>& profiles);
+
+    bool put(const AppProfile& profile);
+    bool remove(const std::string& name);
+
+    bool needsCompaction() const;
+    bool compact(const std::vector<AppProfile>& profiles);
+
+    size_t getSnapshotBytes() const { return m_snapshotBytes; }
+    size_t getJournalBytes() const { return m_journalBytes; }
+    size_t getLastRecordCount() const { return m_lastRecords; }  // records read by the last load/refresh
+    const std::string& getSnapshotPath() const { return m_snapshotPath; }
+    const std::string& getJournalPath() const { return m_journalPath; }
+
+    // Serialisation, exposed for the benchmark
+    static std::string encodeSnapshot(const std::vector<AppProfile>& profiles);
+    static bool decodeSnapshot(const char* data, size_t size, std::vector<AppProfile>& profiles);
+
+private:
+    std::string m_directory;
+    std::string m_snapshotPath;
+    std::string m_journalPath;
+    int m_journalFd = -1;
+    size_t m_snapshotBytes = 0;
+    size_t m_journalBytes = 0;  // end of the last journal record we have applied
+    size_t m_lastRecords = 0;
+
+    // Identity of the files as last read, to tell a replaced file from an appended one
+    struct FileId {
+        bool exists = false;
+        uint64_t device = 0;
+        uint64_t inode = 0;
+        uint64_t size = 0;
+        int64_t modifiedNs = 0;
+    };
+    FileId m_snapshotId;
+    FileId m_journalId;
+
+    bool openJournal();
+    bool append(const std::string& record);
+    size_t replayJournal(const std::string& journal, std::vector<AppProfile>& profiles, size_t& records);
+    static FileId fileId(const struct stat& info);
+    static FileId statFile(const std::string& path);
+    static bool sameFile(const FileId& a, const FileId& b);
+};
@@ -0,0 +1,280 @@
+// Keep a*b+c as two roundings so the scalar reference matches the SIMD paths
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#include "RampKernel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VIVID_RAMP_X86 1
+#endif
+
+namespace {
+
+// Inputs below 2^-30 round to 0 in 16 bits; clamping keeps exp2 in the normal float range
+constexpr float kMinExponent = -30.0f;
+constexpr float kExponentBias = 32.0f;
+
+// Minimax fit of 2^f on [0, 1)
+constexpr float kExp2C0 = 1.0f;
+constexpr float kExp2C1 = 0.693147180f;
+constexpr float kExp2C2 = 0.240226507f;
+constexpr float kExp2C3 = 0.0555041087f;
+constexpr float kExp2C4 = 0.00961812911f;
+constexpr float kExp2C5 = 0.00133335581f;
+constexpr float kExp2C6 = 0.000154035304f;
+
+const float* log2Table(int size) {
+    static std::mutex mutex;
+    static std::map<int, std::unique_ptr<float[]>> tables;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = tables.find(size);
+    if (it != tables.end()) return it->second.get();
+
+    auto table = std::make_unique<float[]>(size);
+    table[0] = -1.0e6f;
+    for (int i = 1; i < size; i++) {
+        table[i] = static_cast<float>(std::log2(static_cast<double>(i) / (size - 1)));
+    }
+    return tables.emplace(size, std::move(table)).first->second.get();
+}
+
+inline uint16_t rampEntryScalar(float log2x, float exponent, float scale) {
+    float a = log2x * exponent;
+    a = std::max(a, kMinExponent);
+    a = a + kExponentBias;
+
+    int32_t n = static_cast<int32_t>(a);
+    float f = a - static_cast<float>(n);
+
+    float p = kExp2C6;
+    p = p * f; p = p + kExp2C5;
+    p = p * f; p = p + kExp2C4;
+    p = p * f; p = p + kExp2C3;
+    p = p * f; p = p + kExp2C2;
+    p = p * f; p = p + kExp2C1;
+    p = p * f; p = p + kExp2C0;
+
+    uint32_t bits = static_cast<uint32_t>(n + 127 - 32) << 23;
+    float pow2;
+    std::memcpy(&pow2, &bits, sizeof(pow2));
+
+    float v = p * pow2;
+    v = v * scale;
+    v = v + 0.5f;
+    v = std::min(v, 65535.0f);
+    return static_cast<uint16_t>(static_cast<int32_t>(v));
+}
+
+void rampChannelScalar(const float* log2x, int begin, int size, float exponent, float scale, uint16_t* out) {
+    for (int i = begin; i < size; i++) {
+        out[i] = rampEntryScalar(log2x[i], exponent, scale);
+    }
+}
+
+#ifdef VIVID_RAMP_X86
+inline __m128i rampQuadSSE2(__m128 log2x, __m128 exponent, __m128 scale) {
+    __m128 a = _mm_mul_ps(log2x, exponent);
+    a = _mm_max_ps(a, _mm_set1_ps(kMinExponent));
+    a = _mm_add_ps(a, _mm_set1_ps(kExponentBias));
+
+    __m128i n = _mm_cvttps_epi32(a);
+    __m128 f = _mm_sub_ps(a, _mm_cvtepi32_ps(n));
+
+    __m128 p = _mm_set1_ps(kExp2C6);
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kExp2C5));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kExp2C4));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kExp2C3));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kExp2C2));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kExp2C1));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kExp2C0));
+
+    __m128 pow2 = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127 - 32)), 23));
+
+    __m128 v = _mm_mul_ps(p, pow2);
+    v = _mm_mul_ps(v, scale);
+    v = _mm_add_ps(v, _mm_set1_ps(0.5f));
+    v = _mm_min_ps(v, _mm_set1_ps(65535.0f));
+
+    // SSE2 has no unsigned 32->16 pack; bias into signed range and back
+    return _mm_sub_epi32(_mm_cvttps_epi32(v), _mm_set1_epi32(32768));
+}
+
+void rampChannelSSE2(const float* log2x, int size, float exponent, float scale, uint16_t* out) {
+    const __m128 vexponent = _mm_set1_ps(exponent);
+    const __m128 vscale = _mm_set1_ps(scale);
+    const __m128i bias = _mm_set1_epi16(static_cast<short>(0x8000));
+
+    int i = 0;
+    for (; i + 8 <= size; i += 8) {
+        __m128i lo = rampQuadSSE2(_mm_loadu_ps(log2x + i), vexponent, vscale);
+        __m128i hi = rampQuadSSE2(_mm_loadu_ps(log2x + i + 4), vexponent, vscale);
+        __m128i packed = _mm_xor_si128(_mm_packs_epi32(lo, hi), bias);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+    rampChannelScalar(log2x, i, size, exponent, scale, out);
+}
+
+__attribute__((target("avx2")))
+inline __m256i rampOctAVX2(__m256 log2x, __m256 exponent, __m256 scale) {
+    __m256 a = _mm256_mul_ps(log2x, exponent);
+    a = _mm256_max_ps(a, _mm256_set1_ps(kMinExponent));
+    a = _mm256_add_ps(a, _mm256_set1_ps(kExponentBias));
+
+    __m256i n = _mm256_cvttps_epi32(a);
+    __m256 f = _mm256_sub_ps(a, _mm256_cvtepi32_ps(n));
+
+    __m256 p = _mm256_set1_ps(kExp2C6);
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(kExp2C5));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(kExp2C4));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(kExp2C3));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(kExp2C2));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(kExp2C1));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(kExp2C0));
+
+    __m256 pow2 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(n, _mm256_set1_epi32(127 - 32)), 23));
+
+    __m256 v = _mm256_mul_ps(p, pow2);
+    v = _mm256_mul_ps(v, scale);
+    v = _mm256_add_ps(v, _mm256_set1_ps(0.5f));
+    v = _mm256_min_ps(v, _mm256_set1_ps(65535.0f));
+    return _mm256_cvttps_epi32(v);
+}
+
+__attribute__((target("avx2")))
+void rampChannelAVX2(const float* log2x, int size, float exponent, float scale, uint16_t* out) {
+    const __m256 vexponent = _mm256_set1_ps(exponent);
+    const __m256 vscale = _mm256_set1_ps(scale);
+
+    int i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m256i lo = rampOctAVX2(_mm256_loadu_ps(log2x + i), vexponent, vscale);
+        __m256i hi = rampOctAVX2(_mm256_loadu_ps(log2x + i + 8), vexponent, vscale);
+        // packus works per 128-bit lane; restore element order afterwards
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+    }
+    rampChannelScalar(log2x, i, size, exponent, scale, out);
+}
+#endif
+
+RampIsa detectRampIsa() {
+    const char* forced = std::getenv("VIVID_RAMP_ISA");
+    if (forced) {
+        std::string name = forced;
+        if (name == "scalar") return RampIsa::SCALAR;
+        if (name == "sse2" && isRampIsaSupported(RampIsa::SSE2)) return RampIsa::SSE2;
+        if (name == "avx2" && isRampIsaSupported(RampIsa::AVX2)) return RampIsa::AVX2;
+    }
+
+    if (isRampIsaSupported(RampIsa::AVX2)) return RampIsa::AVX2;
+    if (isRampIsaSupported(RampIsa::SSE2)) return RampIsa::SSE2;
+    return RampIsa::SCALAR;
+}
+
+} // namespace
+
+bool isRampIsaSupported(RampIsa isa) {
+    switch (isa) {
+        case RampIsa::AUTO:
+        case RampIsa::SCALAR:
+            return true;
+#ifdef VIVID_RAMP_X86
+        case RampIsa::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case RampIsa::AVX2:
+            return __builtin_cpu_supports("avx2");
+#else
+        case RampIsa::SSE2:
+        case RampIsa::AVX2:
+            return false;
+#endif
+    }
+    return false;
+}
+
+RampIsa getRampIsa() {
+    static const RampIsa isa = detectRampIsa();
+    return isa;
+}
+
+const char* getRampIsaName(RampIsa isa) {
+    switch (isa) {
+        case RampIsa::AUTO:
+            return getRampIsaName(getRampIsa());
+        case RampIsa::SCALAR:
+            return "scalar";
+        case RampIsa::SSE2:
+            return "sse2";
+        case RampIsa::AVX2:
+            return "avx2";
+    }
+    return "unknown";
+}
+
+void generateRamp(const ChannelGamma& gamma, const WhitePoint& whitePoint,
+                  uint16_t* red, uint16_t* green, uint16_t* blue, int size,
+                  RampIsa isa) {
+    if (size <= 0) return;
+    if (size == 1) {
+        red[0] = static_cast<uint16_t>(whitePoint.red * 65535.0f + 0.5f);
+        green[0] = static_cast<uint16_t>(whitePoint.green * 65535.0f + 0.5f);
+        blue[0] = static_cast<uint16_t>(whitePoint.blue * 65535.0f + 0.5f);
+        return;
+    }
+
+    if (isa == RampIsa::AUTO || !isRampIsaSupported(isa)) {
+        isa = getRampIsa();
+    }
+
+    const float* log2x = log2Table(size);
+    const float exponents[3] = {
+        1.0f / std::max(0.1f, gamma.red),
+        1.0f / std::max(0.1f, gamma.green),
+        1.0f / std::max(0.1f, gamma.blue)
+    };
+    const float scales[3] = {
+        std::max(0.0f, std::min(1.0f, whitePoint.red)) * 65535.0f,
+        std::max(0.0f, std::min(1.0f, whitePoint.green)) * 65535.0f,
+        std::max(0.0f, std::min(1.0f, whitePoint.blue)) * 65535.0f
+    };
+    uint16_t* outputs[3] = {red, green, blue};
+
+    for (int c = 0; c < 3; c++) {
+        switch (isa) {
+#ifdef VIVID_RAMP_X86
+            case RampIsa::AVX2:
+                rampChannelAVX2(log2x, size, exponents[c], scales[c], outputs[c]);
+                break;
+            case RampIsa::SSE2:
+                rampChannelSSE2(log2x, size, exponents[c], scales[c], outputs[c]);
+                break;
+#endif
+            default:
+                rampChannelScalar(log2x, 0, size, exponents[c], scales[c], outputs[c]);
+                break;
+        }
+    }
+}
+
+void generateRamp(const RampParams& params, GammaRamp& ramp, VibranceCurve curve) {
+    ChannelGamma gamma = curve(params.vibrance);
+    float uniform = std::max(0.1f, params.gamma);
+    gamma.red *= uniform;
+    gamma.green *= uniform;
+    gamma.blue *= uniform;
+
+    generateRamp(gamma, temperatureToWhitePoint(params.temperature),
+                 ramp.red.data(), ramp.green.data(), ramp.blue.data(), ramp.size());
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "GammaRamp.h"
+#include <cstdint>
+
+struct RampParams {
+    int vibrance = 0;       // -100..100
+    float gamma = 1.0f;     // uniform gamma applied on top of the vibrance curve
+    int temperature = 6500; // Kelvin, 6500 is neutral
+};
+
+enum class RampIsa {
+    AUTO,
+    SCALAR,
+    SSE2,
+    AVX2
+};
+
+// Ramp generation works as y = exp2(e * log2(x)) on a per-size log2 table with a
+// fixed-order float polynomial, so every ISA produces bit-identical output.
+void generateRamp(const RampParams& params, GammaRamp& ramp, VibranceCurve curve = vibranceToChannelGamma);
+void generateRamp(const ChannelGamma& gamma, const WhitePoint& whitePoint,
+                  uint16_t* red, uint16_t* green, uint16_t* blue, int size,
+                  RampIsa isa = RampIsa::AUTO);
+
+RampIsa getRampIsa();
+bool isRampIsaSupported(RampIsa isa);
+const char* getRampIsaName(RampIsa isa);
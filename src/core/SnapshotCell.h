@@ -0,0 +1,135 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+// Holds the current immutable version of some state. Readers take a reference-counted
+// snapshot without locks and without copying T; writers build the next version and
+// publish it, and the old one is freed when its last reader lets go.
+//
+// load() is lock-free: the cell word packs the current node pointer with a count of
+// readers that are between reading the pointer and taking their own reference (split
+// reference counting). publish() swaps the word and hands that in-flight count over to
+// the old node, so a node is never freed under a reader that has seen its pointer.
+// Writers are serialised on a mutex that readers never touch.
+template <typename T>
+class SnapshotCell {
+    struct Node {
+        template <typename... Args>
+        explicit Node(Args&&... args) : value(std::forward<Args>(args)...) {}
+
+        T value;
+        std::atomic<int64_t> refs{1};
+    };
+
+public:
+    // Shared read-only handle to one version
+    class Snapshot {
+    public:
+        Snapshot() = default;
+        Snapshot(const Snapshot& other) : m_node(other.m_node) {
+            if (m_node) m_node->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+        Snapshot(Snapshot&& other) noexcept : m_node(other.m_node) { other.m_node = nullptr; }
+        Snapshot& operator=(Snapshot other) noexcept {
+            std::swap(m_node, other.m_node);
+            return *this;
+        }
+        ~Snapshot() { release(m_node); }
+
+        // A version that was never published, e.g. a list received over IPC
+        template <typename... Args>
+        static Snapshot make(Args&&... args) { return Snapshot(new Node(std::forward<Args>(args)...)); }
+
+        const T& operator*() const { return m_node->value; }
+        const T* operator->() const { return &m_node->value; }
+        const T* get() const { return m_node ? &m_node->value : nullptr; }
+        explicit operator bool() const { return m_node != nullptr; }
+
+    private:
+        friend class SnapshotCell;
+        explicit Snapshot(Node* node) : m_node(node) {}
+        Node* m_node = nullptr;
+    };
+
+    template <typename... Args>
+    explicit SnapshotCell(Args&&... args) : m_word(pack(new Node(std::forward<Args>(args)...), 0)) {}
+
+    ~SnapshotCell() { release(pointer(m_word.load(std::memory_order_acquire))); }
+
+    SnapshotCell(const SnapshotCell&) = delete;
+    SnapshotCell& operator=(const SnapshotCell&) = delete;
+
+    Snapshot load() const {
+        // Announce ourselves in the word, so the node cannot be freed before we hold it
+        uint64_t word = m_word.fetch_add(kReaderOne, std::memory_order_acquire) + kReaderOne;
+        Node* node = pointer(word);
+        node->refs.fetch_add(1, std::memory_order_relaxed);
+
+        // Withdraw the announcement. If a writer swapped the node out meanwhile, it has
+        // moved our announcement into refs, so we pay it back there instead; the reference
+        // we just took keeps that from ever being the last one.
+        while (true) {
+            if (pointer(word) != node) {
+                node->refs.fetch_sub(1, std::memory_order_release);
+                break;
+            }
+            if (m_word.compare_exchange_weak(word, word - kReaderOne, std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        return Snapshot(node);
+    }
+
+    void publish(T value) {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        swapIn(new Node(std::move(value)));
+    }
+
+    // Copies the current version, lets edit change the copy, then publishes it. Returns
+    // the published version.
+    template <typename Edit>
+    Snapshot update(Edit edit) {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        Node* node = new Node(pointer(m_word.load(std::memory_order_acquire))->value);
+        edit(node->value);
+        node->refs.fetch_add(1, std::memory_order_relaxed);  // the reference returned below
+        swapIn(node);
+        return Snapshot(node);
+    }
+
+private:
+    static constexpr int kPointerBits = 48;
+    static constexpr uint64_t kPointerMask = (uint64_t(1) << kPointerBits) - 1;
+    static constexpr uint64_t kReaderOne = uint64_t(1) << kPointerBits;
+
+    mutable std::atomic<uint64_t> m_word;
+    std::mutex m_writeMutex;
+
+    static uint64_t pack(Node* node, uint64_t readers) {
+        uint64_t address = reinterpret_cast<uintptr_t>(node);
+        assert((address & ~kPointerMask) == 0);  // user-space addresses fit in 48 bits
+        return address | (readers << kPointerBits);
+    }
+
+    static Node* pointer(uint64_t word) { return reinterpret_cast<Node*>(static_cast<uintptr_t>(word & kPointerMask)); }
+
+    static void release(Node* node) {
+        if (node && node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete node;
+    }
+
+    void swapIn(Node* node) {
+        uint64_t old = m_word.exchange(pack(node, 0), std::memory_order_acq_rel);
+        Node* previous = pointer(old);
+
+        // Readers still announced in the old word now owe their pay-back to the node;
+        // the cell's own reference goes at the same time
+        int64_t announced = static_cast<int64_t>(old >> kPointerBits);
+        if (previous->refs.fetch_add(announced - 1, std::memory_order_acq_rel) == 1 - announced) {
+            delete previous;
+        }
+    }
+};
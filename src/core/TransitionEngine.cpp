@@ -0,0 +1,366 @@
+#include "TransitionEngine.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#ifdef HAVE_DRM
+#include <drm.h>
+#endif
+
+float applyEasing(Easing easing, float t) {
+    t = std::max(0.0f, std::min(1.0f, t));
+    switch (easing) {
+        case Easing::LINEAR:
+            return t;
+        case Easing::EASE_OUT: {
+            float u = 1.0f - t;
+            return 1.0f - u * u * u;
+        }
+        case Easing::EASE_IN_OUT:
+            if (t < 0.5f) return 4.0f * t * t * t;
+            float u = -2.0f * t + 2.0f;
+            return 1.0f - u * u * u / 2.0f;
+    }
+    return t;
+}
+
+TransitionEngine::TransitionEngine(ApplyFunction apply)
+    : m_apply(std::move(apply)) {}
+
+TransitionEngine::~TransitionEngine() {
+    stop();
+}
+
+void TransitionEngine::setTiming(const std::string& output, const OutputTiming& timing) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Track& track = m_tracks[output];
+    if (!track.id) track.id = m_nextId++;
+
+    bool wasActive = track.active;
+    disarmLocked(track);
+    track.timing = timing;
+    if (track.timing.refreshHz <= 0.0) {
+        track.timing.refreshHz = 60.0;
+    }
+
+    if (wasActive) {
+        track.active = true;
+        if (!armLocked(track)) track.active = false;
+        wake();
+    }
+}
+
+void TransitionEngine::transition(const std::string& output, int from, int target,
+                                  std::chrono::milliseconds duration, Easing easing) {
+    bool applyNow = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            m_wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+            if (m_wakeFd < 0) return;
+            m_running = true;
+            m_thread = std::thread(&TransitionEngine::run, this);
+        }
+
+        Track& track = m_tracks[output];
+        if (!track.id) track.id = m_nextId++;
+
+        if (track.active) {
+            // Continue from what is on screen; ease-out keeps the motion going instead of stalling
+            track.from = track.value;
+            if (easing == Easing::EASE_IN_OUT) easing = Easing::EASE_OUT;
+            m_retargets++;
+        } else {
+            track.from = from;
+            track.value = from;
+            track.applied = from;
+            m_transitions++;
+        }
+
+        track.target = target;
+        track.start = Clock::now();
+        track.duration = duration;
+        track.easing = easing;
+
+        if (duration.count() <= 0) {
+            disarmLocked(track);
+            track.value = target;
+            applyNow = (track.applied != target);
+            track.applied = target;
+        } else if (!track.active) {
+            track.active = true;
+            track.lastSequence = 0;
+            if (!armLocked(track)) {
+                // No clock at all: land on the target rather than not moving
+                track.active = false;
+                track.value = target;
+                applyNow = (track.applied != target);
+                track.applied = target;
+            }
+        }
+    }
+
+    if (applyNow) {
+        m_applies++;
+        m_apply(output, target);
+    }
+    wake();
+}
+
+void TransitionEngine::cancel(const std::string& output) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_tracks.find(output);
+    if (it != m_tracks.end()) {
+        disarmLocked(it->second);
+    }
+}
+
+void TransitionEngine::stop() {
+    bool wasRunning;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        wasRunning = m_running;
+        m_running = false;
+    }
+
+    if (wasRunning) {
+        wake();
+        if (m_thread.joinable()) m_thread.join();
+        close(m_wakeFd);
+        m_wakeFd = -1;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& pair : m_tracks) {
+        Track& track = pair.second;
+        track.active = false;
+        if (track.timerFd >= 0) {
+            close(track.timerFd);
+            track.timerFd = -1;
+        }
+    }
+}
+
+bool TransitionEngine::isActive(const std::string& output) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_tracks.find(output);
+    return it != m_tracks.end() && it->second.active;
+}
+
+TransitionEngine::Stats TransitionEngine::getStats() const {
+    Stats stats;
+    stats.transitions = m_transitions.load();
+    stats.retargets = m_retargets.load();
+    stats.frames = m_frames.load();
+    stats.applies = m_applies.load();
+    stats.missedFrames = m_missedFrames.load();
+    return stats;
+}
+
+void TransitionEngine::wake() {
+    if (m_wakeFd < 0) return;
+    uint64_t one = 1;
+    ssize_t written = write(m_wakeFd, &one, sizeof(one));
+    (void)written;
+}
+
+bool TransitionEngine::armLocked(Track& track) {
+    if (track.timing.drmFd >= 0 && requestVblankLocked(track)) {
+        track.vblankPaced = true;
+        return true;
+    }
+    track.vblankPaced = false;
+
+    if (track.timerFd < 0) {
+        track.timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+        if (track.timerFd < 0) return false;
+    }
+
+    // Periodic, so ticks that pass during a slow apply show up as extra expirations
+    long periodNs = std::lround(1e9 / track.timing.refreshHz);
+    struct itimerspec spec = {};
+    spec.it_interval.tv_sec = periodNs / 1000000000L;
+    spec.it_interval.tv_nsec = periodNs % 1000000000L;
+    spec.it_value = spec.it_interval;
+    return timerfd_settime(track.timerFd, 0, &spec, nullptr) == 0;
+}
+
+void TransitionEngine::disarmLocked(Track& track) {
+    track.active = false;
+    if (track.timerFd >= 0) {
+        struct itimerspec spec = {};
+        timerfd_settime(track.timerFd, 0, &spec, nullptr);
+    }
+}
+
+bool TransitionEngine::requestVblankLocked(Track& track) {
+#ifdef HAVE_DRM
+    // An event still in flight from an earlier transition serves as this one's first tick
+    if (track.vblankPending) return true;
+    if (track.timing.drmPipe < 0) return false;
+
+    unsigned int type = _DRM_VBLANK_RELATIVE | _DRM_VBLANK_EVENT;
+    type |= (static_cast<unsigned int>(track.timing.drmPipe) << _DRM_VBLANK_HIGH_CRTC_SHIFT) & _DRM_VBLANK_HIGH_CRTC_MASK;
+
+    union drm_wait_vblank vblank = {};
+    vblank.request.type = static_cast<enum drm_vblank_seq_type>(type);
+    vblank.request.sequence = 1;
+    vblank.request.signal = static_cast<unsigned long>(track.id);
+    if (ioctl(track.timing.drmFd, DRM_IOCTL_WAIT_VBLANK, &vblank) != 0) {
+        return false;
+    }
+    track.vblankPending = true;
+    return true;
+#else
+    (void)track;
+    return false;
+#endif
+}
+
+void TransitionEngine::readVblankEventsLocked(int fd, std::vector<std::pair<std::string, int>>& applies) {
+#ifdef HAVE_DRM
+    char buffer[1024];
+    ssize_t length = read(fd, buffer, sizeof(buffer));
+    if (length <= 0) return;
+
+    ssize_t offset = 0;
+    while (offset + static_cast<ssize_t>(sizeof(drm_event)) <= length) {
+        const drm_event* event = reinterpret_cast<const drm_event*>(buffer + offset);
+        if (event->length == 0) break;
+        offset += event->length;
+        if (event->type != DRM_EVENT_VBLANK || offset > length) continue;
+
+        const drm_event_vblank* vblank = reinterpret_cast<const drm_event_vblank*>(event);
+        for (auto& pair : m_tracks) {
+            Track& track = pair.second;
+            if (track.id != vblank->user_data) continue;
+
+            track.vblankPending = false;
+            uint64_t missed = 0;
+            if (track.lastSequence && vblank->sequence > track.lastSequence + 1) {
+                missed = vblank->sequence - track.lastSequence - 1;
+            }
+            track.lastSequence = vblank->sequence;
+
+            if (!track.active) break;
+
+            int level;
+            if (stepLocked(track, missed, level)) {
+                applies.emplace_back(pair.first, level);
+            }
+            break;
+        }
+    }
+#else
+    (void)fd;
+    (void)applies;
+#endif
+}
+
+bool TransitionEngine::stepLocked(Track& track, uint64_t missed, int& level) {
+    m_frames++;
+    m_missedFrames += missed;
+
+    // Position comes from elapsed time, so missed frames shorten nothing and lag nothing
+    double total = std::chrono::duration<double>(track.duration).count();
+    double elapsed = std::chrono::duration<double>(Clock::now() - track.start).count();
+    float t = (total > 0.0) ? static_cast<float>(elapsed / total) : 1.0f;
+
+    if (t >= 1.0f) {
+        track.value = track.target;
+        disarmLocked(track);
+    } else {
+        track.value = track.from + (track.target - track.from) * applyEasing(track.easing, t);
+        if (track.vblankPaced && !requestVblankLocked(track)) {
+            // Vblank source went away (e.g. CRTC disabled); keep going on the timer
+            track.timing.drmFd = -1;
+            if (!armLocked(track)) {
+                track.value = track.target;
+                disarmLocked(track);
+            }
+        }
+    }
+
+    int next = static_cast<int>(std::lround(track.value));
+    if (next == track.applied) return false;
+    track.applied = next;
+    level = next;
+    return true;
+}
+
+void TransitionEngine::run() {
+    std::vector<pollfd> fds;
+    std::vector<std::string> owners;  // timer fd owner; empty for the wake fd and DRM fds
+
+    while (true) {
+        fds.clear();
+        owners.clear();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_running) break;
+
+            fds.push_back({m_wakeFd, POLLIN, 0});
+            owners.emplace_back();
+
+            std::vector<int> drmFds;
+            for (const auto& pair : m_tracks) {
+                const Track& track = pair.second;
+                if (track.vblankPending) {
+                    if (std::find(drmFds.begin(), drmFds.end(), track.timing.drmFd) == drmFds.end()) {
+                        drmFds.push_back(track.timing.drmFd);
+                    }
+                } else if (track.active && track.timerFd >= 0) {
+                    fds.push_back({track.timerFd, POLLIN, 0});
+                    owners.push_back(pair.first);
+                }
+            }
+            for (int fd : drmFds) {
+                fds.push_back({fd, POLLIN, 0});
+                owners.emplace_back();
+            }
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        std::vector<std::pair<std::string, int>> applies;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (size_t i = 0; i < fds.size(); i++) {
+                if (!(fds[i].revents & POLLIN)) continue;
+
+                if (i == 0) {
+                    uint64_t value;
+                    ssize_t drained = read(m_wakeFd, &value, sizeof(value));
+                    (void)drained;
+                } else if (!owners[i].empty()) {
+                    uint64_t expirations = 0;
+                    if (read(fds[i].fd, &expirations, sizeof(expirations)) != sizeof(expirations)) continue;
+
+                    auto it = m_tracks.find(owners[i]);
+                    if (it == m_tracks.end() || !it->second.active || expirations == 0) continue;
+
+                    int level;
+                    if (stepLocked(it->second, expirations - 1, level)) {
+                        applies.emplace_back(owners[i], level);
+                    }
+                } else {
+                    readVblankEventsLocked(fds[i].fd, applies);
+                }
+            }
+        }
+
+        // Outside the lock: the callback may call back into transition()
+        for (const auto& apply : applies) {
+            m_applies++;
+            m_apply(apply.first, apply.second);
+        }
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class Easing {
+    LINEAR,
+    EASE_OUT,     // fast start, used when retargeting so motion never stalls
+    EASE_IN_OUT
+};
+
+float applyEasing(Easing easing, float t);
+
+// How frames are timed on one output
+struct OutputTiming {
+    double refreshHz = 60.0;
+    int drmFd = -1;     // DRM node for vblank events; -1 paces on a monotonic timerfd
+    int drmPipe = -1;   // CRTC index on that node
+};
+
+// Animates vibrance per output. Each output steps once per frame on its own clock
+// (DRM vblank events when available, a timerfd at the mode's refresh otherwise), and
+// only frames that change the integer level reach the apply callback.
+class TransitionEngine {
+public:
+    using ApplyFunction = std::function<bool(const std::string& output, int vibrance)>;
+
+    struct Stats {
+        uint64_t transitions = 0;
+        uint64_t retargets = 0;
+        uint64_t frames = 0;
+        uint64_t applies = 0;
+        uint64_t missedFrames = 0;  // frame ticks that passed while a step was still running
+    };
+
+    explicit TransitionEngine(ApplyFunction apply);
+    ~TransitionEngine();
+
+    void setTiming(const std::string& output, const OutputTiming& timing);
+
+    // from is where the output is now; a running transition ignores it and continues
+    // from its in-flight value, so a new target never jumps
+    void transition(const std::string& output, int from, int target,
+                    std::chrono::milliseconds duration, Easing easing = Easing::EASE_IN_OUT);
+
+    // Stops any transition on output without applying anything
+    void cancel(const std::string& output);
+    void stop();
+
+    bool isActive(const std::string& output) const;
+    Stats getStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Track {
+        uint64_t id = 0;
+        OutputTiming timing;
+        int timerFd = -1;
+        bool active = false;
+        bool vblankPaced = false;
+        bool vblankPending = false;
+        uint32_t lastSequence = 0;
+        double from = 0.0;
+        double target = 0.0;
+        double value = 0.0;
+        int applied = 0;
+        Clock::time_point start;
+        Clock::duration duration{};
+        Easing easing = Easing::EASE_IN_OUT;
+    };
+
+    ApplyFunction m_apply;
+    mutable std::mutex m_mutex;
+    std::map<std::string, Track> m_tracks;
+    uint64_t m_nextId = 1;
+    std::thread m_thread;
+    int m_wakeFd = -1;
+    bool m_running = false;
+
+    std::atomic<uint64_t> m_transitions{0};
+    std::atomic<uint64_t> m_retargets{0};
+    std::atomic<uint64_t> m_frames{0};
+    std::atomic<uint64_t> m_applies{0};
+    std::atomic<uint64_t> m_missedFrames{0};
+
+    void run();
+    void wake();
+    bool armLocked(Track& track);
+    void disarmLocked(Track& track);
+    bool requestVblankLocked(Track& track);
+    void readVblankEventsLocked(int fd, std::vector<std::pair<std::string, int>>& applies);
+
+    // Advances one frame; returns true and sets level when the output needs an apply
+    bool stepLocked(Track& track, uint64_t missed, int& level);
+};
@@ -1,4 +1,9 @@
 #include "VibranceController.h"
+#include "GammaRamp.h"
+#include "Metrics.h"
+#include "XrandrQuery.h"
+#include "../backends/GammaBackend.h"
+#include "../backends/HotplugMonitor.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -6,154 +11,299 @@
 #include <algorithm>
 #include <cmath>
 
-VibranceController::VibranceController() {
+#ifdef HAVE_X11
+#include "../backends/XRandrGammaBackend.h"
+#include "../backends/XRandrHotplugMonitor.h"
+#endif
+
+#ifdef HAVE_DRM
+#include "../backends/DrmAtomicBackend.h"
+#endif
+
+VibranceController::VibranceController(const ControllerOptions& options)
+    : m_options(options) {
+    initialize();
+}
+
+VibranceController::VibranceController(std::unique_ptr<GammaBackend> backend, const ControllerOptions& options)
+    : m_options(options)
+    , m_gammaBackend(std::move(backend)) {
     initialize();
 }
 
 VibranceController::~VibranceController() {
-    resetAllDisplays();
+    // These threads call back into this object; stop them before tearing down
+    if (m_hotplugMonitor) m_hotplugMonitor->stop();
+    if (m_transitions) m_transitions->stop();
+    
+    // A one-shot --set must outlive the process that made it
+    if (!m_options.oneShot) {
+        resetAllDisplays();
+    }
 }
 
 bool VibranceController::initialize() {
+    CapabilityProbe probe;
+    m_capabilities = probe.load();
+    
+#ifdef HAVE_X11
+    if (!m_gammaBackend) {
+        auto backend = std::make_unique<XRandrGammaBackend>();
+        if (m_options.oneShot && !m_options.targetOutput.empty()) {
+            backend->restrictTo(m_options.targetOutput);
+        }
+        if (backend->open()) {
+            m_gammaBackend = std::move(backend);
+        }
+    }
+#endif
+
+#ifdef HAVE_DRM
+    // No X server (TTY, kiosk): drive the CRTC colour pipeline directly
+    if (!m_gammaBackend && m_capabilities.sessionType == "tty") {
+        m_gammaBackend = DrmAtomicBackend::openFirstCapable();
+    }
+#endif
+
+    if (m_options.oneShot) {
+        // Nothing animates or hotplugs within one command; enumerate on first use
+        m_initialized = true;
+        return true;
+    }
+    
     if (!detectDisplays()) {
         return false;
     }
     
+    setupTransitions();
+    
+#ifdef HAVE_X11
+    if (dynamic_cast<XRandrGammaBackend*>(m_gammaBackend.get()) && !m_hotplugMonitor) {
+        auto monitor = std::make_unique<XRandrHotplugMonitor>([this]() { handleOutputsChanged(); });
+        if (monitor->start()) {
+            m_hotplugMonitor = std::move(monitor);
+        }
+    }
+#endif
+    
     m_initialized = true;
     return true;
 }
 
 bool VibranceController::detectDisplays() {
-    m_displays.clear();
-    
-    FILE* pipe = popen("xrandr --query 2>/dev/null | grep ' connected' | awk '{print $1}'", "r");
-    if (!pipe) return false;
+    DisplayList displays;
     
-    char buffer[256];
-    while (fgets(buffer, sizeof(buffer), pipe)) {
-        std::string displayId(buffer);
-        displayId.erase(displayId.find_last_not_of(" \n\r\t") + 1);
-        
-        if (!displayId.empty()) {
-            Display display;
-            display.id = displayId;
-            display.name = displayId;
-            display.currentVibrance = 0;
-            display.connected = true;
-            
-            m_displays.push_back(display);
-            m_currentVibrance[display.id] = 0;
+    // Persistent backend connection: one XRRGetScreenResourcesCurrent, no process spawn
+    if (m_gammaBackend) {
+        for (const auto& output : m_gammaBackend->getOutputs()) {
+            displays.push_back(makeDisplayLocked(output));
+        }
+    } else if (m_capabilities.hasTool("xrandr")) {
+        std::string query;
+        runXrandr("--query", query);
+        for (const auto& output : parseConnectedOutputs(query)) {
+            displays.push_back(makeDisplayLocked(output));
         }
     }
-    pclose(pipe);
     
-    if (m_displays.empty()) {
+    if (displays.empty()) {
         Display demo;
         demo.id = "eDP-1";
         demo.name = "Built-in Display";
         demo.currentVibrance = 0;
-        m_displays.push_back(demo);
+        displays.push_back(demo);
         m_currentVibrance["eDP-1"] = 0;
     }
     
-    return !m_displays.empty();
+    m_displays.publish(std::move(displays));
+    m_displaysDetected = true;
+    return true;
+}
+
+void VibranceController::ensureDisplaysLocked() {
+    if (!m_displaysDetected) {
+        detectDisplays();
+    }
+}
+
+Display VibranceController::makeDisplayLocked(const std::string& output) {
+    // Stored vibrance survives a disconnect, so a replugged monitor comes back as it was
+    Display display;
+    display.id = output;
+    display.name = output;
+    display.currentVibrance = m_currentVibrance[output];
+    display.connected = true;
+    return display;
+}
+
+void VibranceController::handleOutputsChanged() {
+    std::vector<std::string> added;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_gammaBackend || !m_gammaBackend->refresh()) {
+            return;
+        }
+        
+        std::vector<std::string> outputs = m_gammaBackend->getOutputs();
+        
+        // Next version: drop what went away, append what appeared
+        m_displays.update([&](DisplayList& displays) {
+            displays.erase(std::remove_if(displays.begin(), displays.end(),
+                                          [&](const Display& display) {
+                                              return std::find(outputs.begin(), outputs.end(), display.id) == outputs.end();
+                                          }),
+                           displays.end());
+            
+            for (const auto& output : outputs) {
+                bool known = std::any_of(displays.begin(), displays.end(),
+                                         [&](const Display& display) { return display.id == output; });
+                if (!known) {
+                    displays.push_back(makeDisplayLocked(output));
+                    added.push_back(output);
+                }
+            }
+        });
+        
+        // A new CRTC starts at identity; put the stored look back right away
+        for (const auto& output : added) {
+            int vibrance = m_currentVibrance[output];
+            if (vibrance != 0 || m_rampCache.getTemperature() != 6500) {
+                applyVibranceImmediate(output, vibrance);
+            }
+        }
+    }
+    
+    // Refresh rates and CRTC indices may have moved with the new configuration
+    setupTransitions();
+}
+
+void VibranceController::setupTransitions() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_transitions) {
+        m_transitions = std::make_unique<TransitionEngine>([this](const std::string& displayId, int vibrance) {
+            return setVibrance(displayId, vibrance);
+        });
+    }
+    
+    DisplaySnapshot displays = m_displays.load();
+    for (const auto& display : *displays) {
+        OutputTiming timing;
+        if (m_gammaBackend && m_gammaBackend->getRefreshRate(display.id) > 0.0) {
+            timing.refreshHz = m_gammaBackend->getRefreshRate(display.id);
+        }
+#ifdef HAVE_DRM
+        // Real vblank events when we drive the CRTC ourselves
+        if (auto* drm = dynamic_cast<DrmAtomicBackend*>(m_gammaBackend.get())) {
+            timing.drmFd = drm->getVblankFd();
+            timing.drmPipe = drm->getCrtcPipe(display.id);
+        }
+#endif
+        m_transitions->setTiming(display.id, timing);
+    }
 }
 
-std::vector<Display> VibranceController::getDisplays() {
-    return m_displays;
+DisplaySnapshot VibranceController::getDisplays() {
+    // Only a one-shot controller can get here before the first enumeration
+    if (!m_displaysDetected) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ensureDisplaysLocked();
+    }
+    return m_displays.load();
 }
 
 bool VibranceController::setVibrance(const std::string& displayId, int vibrance) {
     vibrance = std::max(-100, std::min(100, vibrance));
+    std::lock_guard<std::mutex> lock(m_mutex);
     
     if (applyVibranceImmediate(displayId, vibrance)) {
         m_currentVibrance[displayId] = vibrance;
         
-        for (auto& display : m_displays) {
-            if (display.id == displayId) {
-                display.currentVibrance = vibrance;
-                break;
+        m_displays.update([&](DisplayList& displays) {
+            for (auto& display : displays) {
+                if (display.id == displayId) {
+                    display.currentVibrance = vibrance;
+                    break;
+                }
             }
-        }
+        });
         return true;
     }
     return false;
 }
 
+bool VibranceController::animateVibrance(const std::string& displayId, int vibrance, std::chrono::milliseconds duration) {
+    vibrance = std::max(-100, std::min(100, vibrance));
+    if (!m_transitions) {
+        return setVibrance(displayId, vibrance);
+    }
+    
+    m_transitions->transition(displayId, getVibrance(displayId), vibrance, duration);
+    return true;
+}
+
+TransitionEngine::Stats VibranceController::getTransitionStats() const {
+    return m_transitions ? m_transitions->getStats() : TransitionEngine::Stats();
+}
+
 bool VibranceController::applyVibranceImmediate(const std::string& displayId, int vibrance) {
+    // Timed end to end under the method that won, failed attempts before it included
+    LatencyTimer timer;
+    
+    // Native backend: persistent connection, no process spawns
+    if (m_gammaBackend) {
+        auto ramp = m_rampCache.get(m_gammaBackend->getGammaSize(displayId), vibrance);
+        if (ramp && m_gammaBackend->applyRamp(displayId, ramp)) {
+            timer.record("apply.native", displayId);
+            return true;
+        }
+    }
+    
     // Method 1: Try xgamma (most effective for saturation)
     if (applyXGamma(displayId, vibrance)) {
+        timer.record("apply.xgamma", displayId);
         return true;
     }
     
-    // Method 2: Try redshift approach
-    if (applyRedshift(vibrance)) {
+    // Method 2: Try xcalib
+    if (applyXCalib(displayId, vibrance)) {
+        timer.record("apply.xcalib", displayId);
         return true;
     }
     
-    // Method 3: Try xcalib
-    if (applyXCalib(displayId, vibrance)) {
+    // Method 3: Fallback to xrandr
+    if (applyXRandr(displayId, vibrance)) {
+        timer.record("apply.xrandr", displayId);
         return true;
     }
     
-    // Method 4: Fallback to xrandr
-    return applyXRandr(displayId, vibrance);
+    Metrics::count(Counter::APPLY_FAILURES);
+    timer.record("apply.failed", displayId);
+    return false;
 }
 
 bool VibranceController::applyXGamma(const std::string& displayId, int vibrance) {
     // xgamma is more effective for color changes
-    float factor = 1.0f + (vibrance / 100.0f);
-    factor = std::max(0.1f, std::min(3.0f, factor));
-    
-    // Create different gamma values for RGB to simulate saturation
-    float red = std::pow(factor, 0.8f);
-    float green = factor;
-    float blue = std::pow(factor, 1.2f);
-    
-    red = std::max(0.1f, std::min(3.0f, red));
-    green = std::max(0.1f, std::min(3.0f, green));
-    blue = std::max(0.1f, std::min(3.0f, blue));
-    
-    std::ostringstream cmd;
-    cmd << "DISPLAY=:0 xgamma -rgamma " << red << " -ggamma " << green << " -bgamma " << blue << " 2>/dev/null";
-    
-    return system(cmd.str().c_str()) == 0;
-}
-
-bool VibranceController::applyRedshift(int vibrance) {
-    // Use redshift for color temperature adjustment
-    if (system("which redshift > /dev/null 2>&1") != 0) {
+    if (!m_capabilities.hasTool("xgamma")) {
         return false;
     }
     
-    // Kill existing redshift
-    system("pkill redshift 2>/dev/null");
-    
-    if (vibrance == 0) {
-        system("redshift -x 2>/dev/null");
-        return true;
-    }
-    
-    // Convert vibrance to color temperature and brightness
-    int temp = 6500 + (vibrance * 15); // 5000-8000K range
-    float brightness = 1.0f + (vibrance / 200.0f); // 0.5-1.5 range
-    
-    temp = std::max(3000, std::min(10000, temp));
-    brightness = std::max(0.3f, std::min(2.0f, brightness));
+    ChannelGamma gamma = vibranceToChannelGamma(vibrance);
     
     std::ostringstream cmd;
-    cmd << "redshift -O " << temp << " -b " << brightness << " 2>/dev/null &";
+    cmd << "DISPLAY=:0 xgamma -rgamma " << gamma.red << " -ggamma " << gamma.green << " -bgamma " << gamma.blue << " 2>/dev/null";
     
+    Metrics::count(Counter::PROCESS_SPAWNS);
     return system(cmd.str().c_str()) == 0;
 }
 
 bool VibranceController::applyXCalib(const std::string& displayId, int vibrance) {
-    if (system("which xcalib > /dev/null 2>&1") != 0) {
+    if (!m_capabilities.hasTool("xcalib")) {
         return false;
     }
     
     if (vibrance == 0) {
         std::string cmd = "xcalib -clear 2>/dev/null";
+        Metrics::count(Counter::PROCESS_SPAWNS);
         return system(cmd.c_str()) == 0;
     }
     
@@ -167,10 +317,15 @@ bool VibranceController::applyXCalib(const std::string& displayId, int vibrance)
     std::ostringstream cmd;
     cmd << "xcalib -alter -gamma " << sat << " 2>/dev/null";
     
+    Metrics::count(Counter::PROCESS_SPAWNS);
     return system(cmd.str().c_str()) == 0;
 }
 
 bool VibranceController::applyXRandr(const std::string& displayId, int vibrance) {
+    if (!m_capabilities.hasTool("xrandr")) {
+        return false;
+    }
+    
     float factor = 1.0f + (vibrance / 100.0f);
     factor = std::max(0.3f, std::min(2.0f, factor));
     
@@ -180,34 +335,92 @@ bool VibranceController::applyXRandr(const std::string& displayId, int vibrance)
     std::ostringstream cmd;
     cmd << "xrandr --output " << displayId << " --gamma " << gamma << ":" << gamma << ":" << gamma << " 2>/dev/null";
     
+    Metrics::count(Counter::PROCESS_SPAWNS);
     return system(cmd.str().c_str()) == 0;
 }
 
 int VibranceController::getVibrance(const std::string& displayId) {
+    // Connected outputs are in the published list; only unplugged ones need the map
+    if (m_displaysDetected) {
+        DisplaySnapshot displays = m_displays.load();
+        for (const auto& display : *displays) {
+            if (display.id == displayId) return display.currentVibrance;
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
     auto it = m_currentVibrance.find(displayId);
     return (it != m_currentVibrance.end()) ? it->second : 0;
 }
 
+bool VibranceController::setTemperature(int kelvin) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_rampCache.setTemperature(kelvin);
+    
+    // Colour temperature needs ramp control; the external tools cannot combine it with vibrance
+    if (!m_gammaBackend) {
+        return false;
+    }
+    
+    return applyCurrentRampsLocked();
+}
+
+bool VibranceController::applyCurrentRampsLocked() {
+    // One batch for every output, so a temperature step lands on all screens in the same flush
+    std::vector<RampTarget> targets;
+    for (const auto& output : m_gammaBackend->getOutputs()) {
+        auto it = m_currentVibrance.find(output);
+        int vibrance = (it != m_currentVibrance.end()) ? it->second : 0;
+        auto ramp = m_rampCache.get(m_gammaBackend->getGammaSize(output), vibrance);
+        if (ramp) {
+            targets.push_back({output, ramp});
+        }
+    }
+    return m_gammaBackend->applyRamps(targets);
+}
+
 bool VibranceController::resetAllDisplays() {
+    // A transition still running would step the screen away from neutral again
+    if (m_transitions) {
+        DisplaySnapshot displays = getDisplays();
+        for (const auto& display : *displays) {
+            m_transitions->cancel(display.id);
+        }
+    }
+    
     bool success = true;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ensureDisplaysLocked();
+    
+    DisplaySnapshot displays = m_displays.update([this](DisplayList& list) {
+        for (auto& display : list) {
+            display.currentVibrance = 0;
+            m_currentVibrance[display.id] = 0;
+        }
+    });
+    
+    if (m_gammaBackend) {
+        
+        // Keep the night light white point; only vibrance goes back to neutral
+        if (m_rampCache.getTemperature() == 6500) {
+            return m_gammaBackend->resetAll();
+        }
+        return applyCurrentRampsLocked();
+    }
+    
+    // One spawn per tool, plus one per display for xrandr
+    Metrics::count(Counter::PROCESS_SPAWNS, 2 + displays->size());
     
     // Reset xgamma
     system("DISPLAY=:0 xgamma -gamma 1.0 2>/dev/null");
     
-    // Reset redshift
-    system("pkill redshift 2>/dev/null");
-    system("redshift -x 2>/dev/null");
-    
     // Reset xcalib
     system("xcalib -clear 2>/dev/null");
     
     // Reset xrandr
-    for (auto& display : m_displays) {
+    for (const auto& display : *displays) {
         std::string cmd = "xrandr --output " + display.id + " --gamma 1:1:1 2>/dev/null";
         system(cmd.c_str());
-        
-        display.currentVibrance = 0;
-        m_currentVibrance[display.id] = 0;
     }
     
     return success;
@@ -1,7 +1,18 @@
 #pragma once
+#include <atomic>
+#include <chrono>
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
+#include <mutex>
+#include "GammaRampCache.h"
+#include "CapabilityProbe.h"
+#include "TransitionEngine.h"
+#include "SnapshotCell.h"
+
+class GammaBackend;
+class HotplugMonitor;
 
 struct Display {
     std::string id;
@@ -10,29 +21,62 @@ struct Display {
     bool connected = true;
 };
 
+using DisplayList = std::vector<Display>;
+using DisplaySnapshot = SnapshotCell<DisplayList>::Snapshot;
+
+// One-shot is for CLI invocations: no transition engine or hotplug thread, displays are
+// only enumerated when asked for, and whatever was set stays on screen after exit.
+struct ControllerOptions {
+    bool oneShot = false;
+    std::string targetOutput;  // one-shot: query only this output's CRTC
+};
+
 class VibranceController {
 public:
-    VibranceController();
+    explicit VibranceController(const ControllerOptions& options = ControllerOptions());
+    // Drives backend instead of opening X or DRM, e.g. the recording backend in vivid-bench
+    explicit VibranceController(std::unique_ptr<GammaBackend> backend,
+                                const ControllerOptions& options = ControllerOptions());
     ~VibranceController();
     
     bool initialize();
-    std::vector<Display> getDisplays();
+    // Lock-free and copy-free; keep the snapshot alive while iterating it
+    DisplaySnapshot getDisplays();
     bool setVibrance(const std::string& displayId, int vibrance);
+    // Eases from the current value to vibrance at the output's refresh rate; returns once scheduled
+    bool animateVibrance(const std::string& displayId, int vibrance, std::chrono::milliseconds duration);
     int getVibrance(const std::string& displayId);
+    // Re-uploads every display's current vibrance with the new white point
+    bool setTemperature(int kelvin);
     bool resetAllDisplays();
-    bool installSystemWide();
-    bool isSystemInstalled();
+    static bool installSystemWide();
+    static bool isSystemInstalled();
     bool isReady() const { return m_initialized; }
+    GammaRampCache::Stats getRampCacheStats() const { return m_rampCache.getStats(); }
+    TransitionEngine::Stats getTransitionStats() const;
     
 private:
-    std::vector<Display> m_displays;
+    ControllerOptions m_options;
+    SnapshotCell<DisplayList> m_displays;  // republished under m_mutex on every change
     std::map<std::string, int> m_currentVibrance;
     bool m_initialized = false;
+    std::atomic<bool> m_displaysDetected{false};
+    std::unique_ptr<GammaBackend> m_gammaBackend;
+    GammaRampCache m_rampCache;
+    CapabilityManifest m_capabilities;
+    std::mutex m_mutex; // serialises backend access between the apply worker and night light
+    std::unique_ptr<TransitionEngine> m_transitions;
+    std::unique_ptr<HotplugMonitor> m_hotplugMonitor;
     
     bool detectDisplays();
+    void ensureDisplaysLocked();
+    Display makeDisplayLocked(const std::string& output);
+    // Hotplug: republishes m_displays and re-applies stored vibrance on outputs that appeared
+    void handleOutputsChanged();
+    void setupTransitions();
+    bool applyCurrentRampsLocked();
     bool applyVibranceImmediate(const std::string& displayId, int vibrance);
     bool applyXGamma(const std::string& displayId, int vibrance);
-    bool applyRedshift(int vibrance);
     bool applyXCalib(const std::string& displayId, int vibrance);
     bool applyXRandr(const std::string& displayId, int vibrance);
 };
@@ -1,6 +1,13 @@
 #include "VividManager.h"
 #include "AutostartManager.h"
-#include <iostream>
+#include "GammaRamp.h"
+#include "Logger.h"
+#include "ColorMatrix.h"
+#include "Metrics.h"
+#include "XrandrQuery.h"
+#include "../backends/GammaBackend.h"
+#include "../backends/HotplugMonitor.h"
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <cstdlib>
@@ -8,67 +15,122 @@
 #include <thread>
 #include <chrono>
 #include <regex>
+#include <set>
+#include <cmath>
 
 #ifdef HAVE_X11
 #include <X11/Xlib.h>
 #include <X11/extensions/Xrandr.h>
 #include <X11/Xatom.h>
+#include "../backends/XRandrGammaBackend.h"
+#include "../backends/XRandrHotplugMonitor.h"
 using X11Display = Display;
 #endif
 
+#ifdef HAVE_DRM
+#include "../backends/DrmAtomicBackend.h"
+#endif
+
 VividManager::VividManager() 
     : m_currentMethod(VibranceMethod::DEMO_MODE)
     , m_initialized(false)
-    , m_monitoringEnabled(false) {
+    , m_rampCache(safeVibranceToChannelGamma) {
     m_autostartManager = std::make_unique<AutostartManager>();
+    m_profileManager = std::make_unique<ProfileManager>(
+        ProfileManager::getConfigDirectory(),
+        [this](const std::string& displayId, float vibrance) { return setVibrance(displayId, vibrance); },
+        [this]() {
+            // From the published list; the hotplug thread may be adding displays right now
+            std::map<std::string, float> base;
+            VividDisplaySnapshot displays = m_displays.load();
+            for (const auto& display : *displays) {
+                base[display.id] = display.baseVibrance;
+            }
+            return base;
+        },
+        [this](const AppProfile& profile) { prewarmProfileRamps(profile); });
 }
 
 VividManager::~VividManager() {
-    stopApplicationMonitoring();
+    // Its tracker and watcher threads call back into this object
+    m_profileManager.reset();
+    m_hotplugMonitor.reset();
     
     // Safety: Reset all displays to original values on exit
-    std::cout << "🛡️ Safety shutdown: Resetting all displays..." << std::endl;
-    for (const auto& display : m_displays) {
+    LOG_INFO << "🛡️ Safety shutdown: Resetting all displays...";
+    VividDisplaySnapshot displays = m_displays.load();
+    for (const auto& display : *displays) {
         resetVibrance(display.id);
     }
 }
 
 bool VividManager::initialize() {
-    std::cout << "Initializing Vivid Manager..." << std::endl;
+    LOG_INFO << "Initializing Vivid Manager...";
+    
+    // Probes run once per session/topology; later starts reuse the stored manifest
+    CapabilityProbe probe;
+    m_capabilities = probe.load();
+    
+#ifdef HAVE_X11
+    if (!m_gammaBackend) {
+        auto backend = std::make_unique<XRandrGammaBackend>();
+        if (backend->open()) {
+            m_gammaBackend = std::move(backend);
+        }
+    }
+#endif
+    
+#ifdef HAVE_DRM
+    if (!m_gammaBackend && m_capabilities.sessionType == "tty") {
+        m_gammaBackend = DrmAtomicBackend::openFirstCapable();
+    }
+#endif
     
     // Store original vibrance values for safety
     detectDisplays();
-    for (const auto& display : m_displays) {
+    VividDisplaySnapshot displays = m_displays.load();
+    for (const auto& display : *displays) {
         m_originalVibrance[display.id] = 0.0f; // Assume normal as original
     }
     
+#ifdef HAVE_X11
+    // Hotplug republishes m_displays instead of re-running detection
+    if (dynamic_cast<XRandrGammaBackend*>(m_gammaBackend.get())) {
+        auto monitor = std::make_unique<XRandrHotplugMonitor>([this]() { handleOutputsChanged(); });
+        if (monitor->start()) {
+            m_hotplugMonitor = std::move(monitor);
+        }
+    }
+#endif
+    
     // Detect session type
-    std::string sessionType = "unknown";
-    if (std::getenv("WAYLAND_DISPLAY")) {
-        sessionType = "wayland";
-        std::cout << "  Detected Wayland session" << std::endl;
-    } else if (std::getenv("DISPLAY")) {
-        sessionType = "x11";
-        std::cout << "  Detected X11 session" << std::endl;
+    const std::string& sessionType = m_capabilities.sessionType;
+    if (sessionType == "wayland") {
+        LOG_INFO << "  Detected Wayland session";
+    } else if (sessionType == "x11") {
+        LOG_INFO << "  Detected X11 session";
     }
     
-    // Try methods with safety priority
-    if (tryAMDColorProperties()) {
+    // Try methods with safety priority; a hardware CTM beats any gamma approximation
+    if (sessionType == "x11" && tryXRandrCTM()) {
+        m_currentMethod = VibranceMethod::XRANDR_CTM;
+        LOG_INFO << "✓ Using XRandR CTM method (real saturation)";
+    } else if (tryAMDColorProperties()) {
         m_currentMethod = VibranceMethod::AMD_COLOR_PROPERTIES;
-        std::cout << "✓ Using AMD Color Properties method (Safe)" << std::endl;
+        LOG_INFO << "✓ Using AMD Color Properties method (Safe)";
+    } else if (sessionType == "tty" && tryDrmAtomic()) {
+        m_currentMethod = VibranceMethod::DRM_ATOMIC;
+        LOG_INFO << "✓ Using DRM atomic color pipeline (CTM)";
     } else if (sessionType == "wayland" && tryWaylandColorMgmt()) {
         m_currentMethod = VibranceMethod::WAYLAND_COLOR_MGMT;
-        std::cout << "✓ Using Wayland Color Management method" << std::endl;
-    } else if (sessionType == "x11" && tryXRandrCTM()) {
-        m_currentMethod = VibranceMethod::XRANDR_CTM;
-        std::cout << "✓ Using XRandR method (Limited)" << std::endl;
+        LOG_INFO << "✓ Using Wayland Color Management method";
     } else {
         m_currentMethod = VibranceMethod::DEMO_MODE;
-        std::cout << "⚠ Using demo mode - Interface testing only" << std::endl;
-        std::cout << "  All controls work, but no actual display changes" << std::endl;
+        LOG_WARN << "⚠ Using demo mode - Interface testing only";
+        LOG_WARN << "  All controls work, but no actual display changes";
     }
     
-    loadProfiles();
+    m_profileManager->load();
     m_initialized = true;
     
     return true;
@@ -82,7 +144,7 @@ bool VividManager::setVibranceSafe(const std::string& displayId, float vibrance)
     // Clamp to safe range
     vibrance = std::max(SAFE_MIN, std::min(SAFE_MAX, vibrance));
     
-    std::cout << "🛡️ Safe vibrance change: " << displayId << " -> " << vibrance << std::endl;
+    LOG_DEBUG << "🛡️ Safe vibrance change: " << displayId << " -> " << vibrance;
     
     // Call the regular setVibrance with safety-clamped values
     return setVibrance(displayId, vibrance);
@@ -92,8 +154,13 @@ bool VividManager::setVibrance(const std::string& displayId, float vibrance) {
     // Additional safety check
     vibrance = std::max(-100.0f, std::min(100.0f, vibrance));
     
-    std::cout << "Setting " << displayId << " vibrance to " << vibrance << std::endl;
+    LOG_DEBUG << "Setting " << displayId << " vibrance to " << vibrance;
     
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return applyVibranceLocked(displayId, vibrance);
+}
+
+bool VividManager::applyVibranceLocked(const std::string& displayId, float vibrance) {
     bool success = false;
     switch (m_currentMethod) {
         case VibranceMethod::AMD_COLOR_PROPERTIES:
@@ -105,20 +172,24 @@ bool VividManager::setVibrance(const std::string& displayId, float vibrance) {
         case VibranceMethod::WAYLAND_COLOR_MGMT:
             success = setWaylandVibrance(displayId, vibrance);
             break;
+        case VibranceMethod::DRM_ATOMIC:
+            success = setDrmVibrance(displayId, vibrance);
+            break;
         case VibranceMethod::DEMO_MODE:
             success = true;
-            std::cout << "  Demo mode: vibrance simulated at " << vibrance << std::endl;
+            LOG_DEBUG << "  Demo mode: vibrance simulated at " << vibrance;
             break;
     }
     
     if (success) {
-        // Update display vibrance
-        for (auto& display : m_displays) {
-            if (display.id == displayId) {
-                display.currentVibrance = vibrance;
-                break;
+        m_displays.update([&](std::vector<VividDisplay>& displays) {
+            for (auto& display : displays) {
+                if (display.id == displayId) {
+                    display.currentVibrance = vibrance;
+                    break;
+                }
             }
-        }
+        });
     }
     
     return success;
@@ -129,102 +200,110 @@ bool VividManager::setAMDVibrance(const std::string& displayId, float vibrance)
     float saturation = 1.0f + (vibrance / 100.0f);
     saturation = std::max(0.3f, std::min(1.7f, saturation)); // Conservative limits
     
-    std::cout << "  Trying safe AMD vibrance control..." << std::endl;
+    LOG_DEBUG << "  Trying safe AMD vibrance control...";
     
     // Use gamma adjustment as it's safer than direct color properties
     float gamma = 1.0f / saturation;
     gamma = std::max(0.6f, std::min(1.6f, gamma)); // Very conservative gamma limits
     
+    if (m_gammaBackend) {
+        int level = static_cast<int>(std::lround(vibrance));
+        auto ramp = m_rampCache.get(m_gammaBackend->getGammaSize(displayId), level);
+        if (ramp && m_gammaBackend->applyRamp(displayId, ramp)) {
+            return true;
+        }
+    }
+    
     std::string command = "xrandr --output " + displayId + " --gamma " + 
                          std::to_string(gamma) + ":" + std::to_string(gamma) + ":" + std::to_string(gamma) + " 2>/dev/null";
     
-    std::cout << "    Safe command: " << command << std::endl;
+    LOG_DEBUG << "    Safe command: " << command;
+    Metrics::count(Counter::PROCESS_SPAWNS);
     int result = system(command.c_str());
     
     if (result == 0) {
-        std::cout << "    ✅ Safe gamma adjustment successful" << std::endl;
+        LOG_DEBUG << "    ✅ Safe gamma adjustment successful";
         return true;
     } else {
-        std::cout << "    ⚠ Gamma adjustment failed (this is normal in demo mode)" << std::endl;
+        LOG_DEBUG << "    ⚠ Gamma adjustment failed (this is normal in demo mode)";
         return false;
     }
 }
 
 bool VividManager::tryAMDColorProperties() {
-    std::cout << "  Checking for AMD GPU..." << std::endl;
-    
-    std::ifstream drmFile("/sys/class/drm/card0/device/vendor");
-    if (drmFile.is_open()) {
-        std::string vendor;
-        std::getline(drmFile, vendor);
-        if (vendor == "0x1002") {
-            std::cout << "    ✓ AMD GPU detected" << std::endl;
-            if (std::filesystem::exists("/sys/module/amdgpu")) {
-                std::cout << "    ✓ AMDGPU driver loaded" << std::endl;
-                return tryAMDXrandrFallback();
-            }
+    LOG_INFO << "  Checking for AMD GPU...";
+    
+    if (m_capabilities.gpuVendor == "0x1002") {
+        LOG_INFO << "    ✓ AMD GPU detected";
+        if (m_capabilities.amdgpuLoaded) {
+            LOG_INFO << "    ✓ AMDGPU driver loaded";
+            return tryAMDXrandrFallback();
         }
     }
     return false;
 }
 
 bool VividManager::tryAMDXrandrFallback() {
-    std::cout << "    Checking safe xrandr availability..." << std::endl;
-    int result = system("which xrandr > /dev/null 2>&1");
-    if (result == 0) {
-        result = system("xrandr --listmonitors > /dev/null 2>&1");
-        if (result == 0) {
-            std::cout << "    ✅ Safe xrandr method available" << std::endl;
-            return true;
-        }
+    LOG_INFO << "    Checking safe xrandr availability...";
+    if (m_capabilities.backend == "xrandr-gamma" || m_capabilities.backend == "xrandr-tool") {
+        LOG_INFO << "    ✅ Safe xrandr method available";
+        return true;
     }
     return false;
 }
 
 bool VividManager::tryXRandrCTM() {
-    return false; // Disabled for safety
+    LOG_INFO << "  Checking XRandR CTM output property...";
+    
+    // Only modesetting/amdgpu X drivers expose it; others keep the gamma paths
+    if (m_gammaBackend && m_gammaBackend->supportsColorMatrix()) {
+        LOG_INFO << "    ✅ CTM available on " << m_gammaBackend->name();
+        return true;
+    }
+    return false;
+}
+
+bool VividManager::tryDrmAtomic() {
+    LOG_INFO << "    Checking DRM atomic color properties...";
+    if (m_gammaBackend && m_gammaBackend->supportsColorMatrix()) {
+        LOG_INFO << "    ✅ CTM available on " << m_gammaBackend->name();
+        return true;
+    }
+    return false;
 }
 
 bool VividManager::tryWaylandColorMgmt() {
     if (!std::getenv("WAYLAND_DISPLAY")) return false;
-    std::cout << "    ⚠ Wayland color management not yet implemented" << std::endl;
+    LOG_WARN << "    ⚠ Wayland color management not yet implemented";
     return false;
 }
 
 void VividManager::detectDisplays() {
-    m_displays.clear();
-    std::cout << "  Detecting displays safely..." << std::endl;
+    std::vector<VividDisplay> displays;
+    LOG_INFO << "  Detecting displays safely...";
     
     bool foundRealDisplays = false;
     
-    // Try xrandr first
-    if (system("which xrandr > /dev/null 2>&1") == 0) {
-        FILE* pipe = popen("xrandr --listmonitors 2>/dev/null | grep -v '^Monitors:' | awk '{print $4}'", "r");
-        if (pipe) {
-            char buffer[256];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                std::string displayName = buffer;
-                displayName.erase(displayName.find_last_not_of(" \n\r\t") + 1);
-                if (!displayName.empty()) {
-                    VividDisplay display;
-                    display.id = displayName;
-                    display.name = displayName;
-                    display.connector = displayName;
-                    display.connected = true;
-                    display.currentVibrance = 0.0f;
-                    m_displays.push_back(display);
-                    m_baseVibrance[display.id] = 0.0f;
-                    foundRealDisplays = true;
-                    std::cout << "    Found display: " << displayName << std::endl;
-                }
-            }
-            pclose(pipe);
+    // Backend connection first: one XRRGetScreenResourcesCurrent (or DRM query), no process spawn
+    if (m_gammaBackend) {
+        for (const auto& output : m_gammaBackend->getOutputs()) {
+            addDisplay(displays, output);
+            foundRealDisplays = true;
+            LOG_INFO << "    Found display: " << output;
+        }
+    } else if (m_capabilities.hasTool("xrandr")) {
+        std::string listing;
+        runXrandr("--listmonitors", listing);
+        for (const auto& displayName : parseMonitorOutputs(listing)) {
+            addDisplay(displays, displayName);
+            foundRealDisplays = true;
+            LOG_INFO << "    Found display: " << displayName;
         }
     }
     
     // Fallback to demo displays
     if (!foundRealDisplays) {
-        std::cout << "    Using demo displays for interface testing" << std::endl;
+        LOG_INFO << "    Using demo displays for interface testing";
         
         VividDisplay display1;
         display1.id = "eDP-1";
@@ -232,7 +311,8 @@ void VividManager::detectDisplays() {
         display1.connector = "eDP";
         display1.connected = true;
         display1.currentVibrance = 0.0f;
-        m_displays.push_back(display1);
+        display1.baseVibrance = 0.0f;
+        displays.push_back(display1);
         
         VividDisplay display2;
         display2.id = "HDMI-A-1";
@@ -240,21 +320,71 @@ void VividManager::detectDisplays() {
         display2.connector = "HDMI-A";
         display2.connected = true;
         display2.currentVibrance = 0.0f;
-        m_displays.push_back(display2);
-        
-        m_baseVibrance["eDP-1"] = 0.0f;
-        m_baseVibrance["HDMI-A-1"] = 0.0f;
+        display2.baseVibrance = 0.0f;
+        displays.push_back(display2);
     }
     
-    std::cout << "    Total displays: " << m_displays.size() << std::endl;
+    LOG_INFO << "    Total displays: " << displays.size();
+    m_displays.publish(std::move(displays));
 }
 
-std::vector<VividDisplay> VividManager::getDisplays() {
-    return m_displays;
+void VividManager::addDisplay(std::vector<VividDisplay>& displays, const std::string& output) {
+    VividDisplay display;
+    display.id = output;
+    display.name = output;
+    display.connector = output;
+    display.connected = true;
+    display.currentVibrance = 0.0f;
+    display.baseVibrance = 0.0f;
+    displays.push_back(display);
+}
+
+void VividManager::handleOutputsChanged() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_gammaBackend || !m_gammaBackend->refresh()) return;
+    
+    std::vector<std::string> outputs = m_gammaBackend->getOutputs();
+    std::vector<std::pair<std::string, float>> restore;
+    
+    m_displays.update([&](std::vector<VividDisplay>& displays) {
+        // Unplugged displays stay listed as disconnected so their vibrance survives a replug
+        for (auto& display : displays) {
+            bool present = std::find(outputs.begin(), outputs.end(), display.id) != outputs.end();
+            if (display.connected && !present) {
+                display.connected = false;
+                LOG_INFO << "  Display disconnected: " << display.id;
+            }
+        }
+        
+        for (const auto& output : outputs) {
+            auto it = std::find_if(displays.begin(), displays.end(),
+                                   [&](const VividDisplay& display) { return display.id == output; });
+            if (it == displays.end()) {
+                addDisplay(displays, output);
+                LOG_INFO << "  Display connected: " << output;
+            } else if (!it->connected) {
+                it->connected = true;
+                LOG_INFO << "  Display reconnected: " << output;
+                if (it->currentVibrance != 0.0f) {
+                    restore.emplace_back(output, it->currentVibrance);
+                }
+            }
+        }
+    });
+    
+    // A fresh CRTC starts neutral; restore what the user had
+    for (const auto& pair : restore) {
+        applyVibranceLocked(pair.first, pair.second);
+    }
+}
+
+VividDisplaySnapshot VividManager::getDisplays() {
+    return m_displays.load();
 }
 
 float VividManager::getVibrance(const std::string& displayId) {
-    for (const auto& display : m_displays) {
+    VividDisplaySnapshot displays = m_displays.load();
+    for (const auto& display : *displays) {
         if (display.id == displayId) {
             return display.currentVibrance;
         }
@@ -263,7 +393,7 @@ float VividManager::getVibrance(const std::string& displayId) {
 }
 
 bool VividManager::resetVibrance(const std::string& displayId) {
-    std::cout << "🔄 Resetting " << displayId << " to normal vibrance" << std::endl;
+    LOG_DEBUG << "🔄 Resetting " << displayId << " to normal vibrance";
     return setVibrance(displayId, 0.0f);
 }
 
@@ -272,117 +402,92 @@ std::string VividManager::getMethodName() const {
         case VibranceMethod::AMD_COLOR_PROPERTIES:
             return "AMD Safe Mode";
         case VibranceMethod::XRANDR_CTM:
-            return "XRandR Limited";
+            return "XRandR CTM";
         case VibranceMethod::WAYLAND_COLOR_MGMT:
             return "Wayland Color Management";
+        case VibranceMethod::DRM_ATOMIC:
+            return "DRM Atomic (CTM)";
         case VibranceMethod::DEMO_MODE:
             return "Demo Mode (Interface Testing)";
     }
     return "Unknown";
 }
 
-bool VividManager::setXRandrVibrance(const std::string& displayId __attribute__((unused)), float vibrance __attribute__((unused))) {
-    return false;
+bool VividManager::setXRandrVibrance(const std::string& displayId, float vibrance) {
+    if (!m_gammaBackend) {
+        return false;
+    }
+    
+    // Precomputed matrix; the apply is a single property upload
+    return m_gammaBackend->applyColorMatrix(displayId, vibranceToCtm(static_cast<int>(std::lround(vibrance))));
 }
 
 bool VividManager::setWaylandVibrance(const std::string& displayId __attribute__((unused)), float vibrance __attribute__((unused))) {
     return false;
 }
 
-// Profile management
-bool VividManager::saveProfile(const AppProfile& profile) {
-    auto it = std::find_if(m_profiles.begin(), m_profiles.end(),
-                          [&](const AppProfile& p) { return p.name == profile.name; });
-    
-    if (it != m_profiles.end()) {
-        *it = profile;
-    } else {
-        m_profiles.push_back(profile);
+bool VividManager::setDrmVibrance(const std::string& displayId, float vibrance) {
+    if (!m_gammaBackend || !m_gammaBackend->supportsColorMatrix()) {
+        return false;
     }
     
-    saveProfiles();
-    return true;
+    // The CTM mixes channels, so this is real saturation rather than a gamma approximation
+    return m_gammaBackend->applyColorMatrix(displayId, vibranceToCtm(static_cast<int>(std::lround(vibrance))));
+}
+
+// Profile management
+bool VividManager::saveProfile(const AppProfile& profile) {
+    return m_profileManager->saveProfile(profile);
 }
 
 bool VividManager::deleteProfile(const std::string& name) {
-    auto it = std::find_if(m_profiles.begin(), m_profiles.end(),
-                          [&](const AppProfile& p) { return p.name == name; });
-    
-    if (it != m_profiles.end()) {
-        m_profiles.erase(it);
-        saveProfiles();
-        return true;
-    }
-    return false;
+    return m_profileManager->deleteProfile(name);
 }
 
-std::vector<AppProfile> VividManager::getProfiles() {
-    return m_profiles;
+ProfileSnapshot VividManager::getProfiles() {
+    return m_profileManager->getProfiles();
 }
 
-AppProfile* VividManager::findProfile(const std::string& name) {
-    auto it = std::find_if(m_profiles.begin(), m_profiles.end(),
-                          [&](const AppProfile& p) { return p.name == name; });
-    return (it != m_profiles.end()) ? &(*it) : nullptr;
+bool VividManager::findProfile(const std::string& name, AppProfile& profile) {
+    return m_profileManager->findProfile(name, profile);
 }
 
-void VividManager::loadProfiles() {
-    std::string configPath = getConfigPath();
-    std::ifstream file(configPath);
-    if (file.is_open()) {
-        std::string line;
-        while (std::getline(file, line)) {
-            // Simple profile parsing
-        }
-    }
+ProfileReloadStats VividManager::getProfileReloadStats() {
+    return m_profileManager->getReloadStats();
 }
 
-void VividManager::saveProfiles() {
-    std::string configPath = getConfigPath();
-    std::filesystem::create_directories(std::filesystem::path(configPath).parent_path());
-    
-    std::ofstream file(configPath);
-    if (file.is_open()) {
-        for (const auto& profile : m_profiles) {
-            file << "profile:" << profile.name << ":" << profile.executable << std::endl;
+void VividManager::prewarmProfileRamps(const AppProfile& profile) {
+    // Profile switches should only cost a lookup and an upload
+    // The CRTC table belongs to the hotplug thread's refresh(), so read sizes under m_mutex
+    // and build the ramps outside it
+    std::vector<std::pair<int, int>> ramps;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_gammaBackend) return;
+        for (const auto& pair : profile.displayVibrance) {
+            ramps.emplace_back(m_gammaBackend->getGammaSize(pair.first), static_cast<int>(std::lround(pair.second)));
         }
     }
-}
-
-std::string VividManager::getConfigPath() {
-    std::string home = std::getenv("HOME");
-    return home + "/.config/vivid/profiles.conf";
+    
+    for (const auto& ramp : ramps) {
+        m_rampCache.prewarm(ramp.first, ramp.second);
+    }
 }
 
 void VividManager::setMonitoringEnabled(bool enabled) {
-    if (enabled && !m_monitoringEnabled) {
+    if (enabled) {
         startApplicationMonitoring();
-    } else if (!enabled && m_monitoringEnabled) {
+    } else {
         stopApplicationMonitoring();
     }
-    m_monitoringEnabled = enabled;
 }
 
 void VividManager::startApplicationMonitoring() {
-    m_monitoringEnabled = true;
-    std::thread([this]() {
-        while (m_monitoringEnabled) {
-            checkActiveApplication();
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-        }
-    }).detach();
+    m_profileManager->startMonitoring();
 }
 
 void VividManager::stopApplicationMonitoring() {
-    m_monitoringEnabled = false;
-}
-
-void VividManager::checkActiveApplication() {
-    // Application monitoring implementation
-}
-
-std::string VividManager::getCurrentActiveWindow() {
-    return "";
+    m_profileManager->stopMonitoring();
 }
 
 // Autostart functionality
@@ -4,9 +4,17 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <mutex>
+#include "AppProfile.h"
+#include "GammaRampCache.h"
+#include "ProfileManager.h"
+#include "SnapshotCell.h"
+#include "CapabilityProbe.h"
 
 // Forward declaration
 class AutostartManager;
+class GammaBackend;
+class HotplugMonitor;
 
 struct VividDisplay {
     std::string id;
@@ -14,21 +22,16 @@ struct VividDisplay {
     std::string connector;
     bool connected;
     float currentVibrance;
+    float baseVibrance;  // restored when the focused app has no profile
 };
 
-struct AppProfile {
-    std::string name;
-    std::string executable;
-    std::string windowTitle;
-    std::map<std::string, float> displayVibrance;
-    bool pathMatching;
-    bool enabled;
-};
+using VividDisplaySnapshot = SnapshotCell<std::vector<VividDisplay>>::Snapshot;
 
 enum class VibranceMethod {
     AMD_COLOR_PROPERTIES,
     XRANDR_CTM,
     WAYLAND_COLOR_MGMT,
+    DRM_ATOMIC,
     DEMO_MODE
 };
 
@@ -39,7 +42,7 @@ public:
     
     // Core functionality
     bool initialize();
-    std::vector<VividDisplay> getDisplays();
+    VividDisplaySnapshot getDisplays();  // lock-free; hold the snapshot while iterating
     bool setVibrance(const std::string& displayId, float vibrance); // -100 to +100
     bool setVibranceSafe(const std::string& displayId, float vibrance); // Safe version with limits
     float getVibrance(const std::string& displayId);
@@ -48,13 +51,13 @@ public:
     // Profile management
     bool saveProfile(const AppProfile& profile);
     bool deleteProfile(const std::string& name);
-    std::vector<AppProfile> getProfiles();
-    AppProfile* findProfile(const std::string& name);
+    ProfileSnapshot getProfiles();
+    bool findProfile(const std::string& name, AppProfile& profile);
     
     // Application monitoring
     void startApplicationMonitoring();
     void stopApplicationMonitoring();
-    bool isMonitoringEnabled() const { return m_monitoringEnabled; }
+    bool isMonitoringEnabled() const { return m_profileManager->isMonitoring(); }
     void setMonitoringEnabled(bool enabled);
 
     // Autostart functionality
@@ -67,38 +70,51 @@ public:
     VibranceMethod getCurrentMethod() const { return m_currentMethod; }
     std::string getMethodName() const;
     bool isInitialized() const { return m_initialized; }
+    GammaRampCache::Stats getRampCacheStats() const { return m_rampCache.getStats(); }
+    const CapabilityManifest& getCapabilities() const { return m_capabilities; }
+    ProfileReloadStats getProfileReloadStats();
 
 private:
     VibranceMethod m_currentMethod;
     bool m_initialized;
-    bool m_monitoringEnabled;
-    std::vector<VividDisplay> m_displays;
-    std::vector<AppProfile> m_profiles;
-    std::map<std::string, float> m_baseVibrance;
+    
+    // Readers load these without locking; writers publish a new version. Everything the
+    // tracker and hotplug threads share lives in one of them (base vibrance is per display).
+    SnapshotCell<std::vector<VividDisplay>> m_displays;  // written under m_mutex
     std::map<std::string, float> m_originalVibrance; // Store original values for safety
     
     // Autostart manager
     std::unique_ptr<AutostartManager> m_autostartManager;
     
+    // In-process gamma backend (null when unavailable)
+    std::unique_ptr<GammaBackend> m_gammaBackend;
+    GammaRampCache m_rampCache;
+    CapabilityManifest m_capabilities;
+    std::unique_ptr<HotplugMonitor> m_hotplugMonitor;
+    
+    // Serialises the backend and display writers against the hotplug thread
+    std::mutex m_mutex;
+    
+    // Store, matcher, live reload and focus switching; applies through setVibrance
+    std::unique_ptr<ProfileManager> m_profileManager;
+    
     // Detection methods
     bool tryAMDColorProperties();
     bool tryAMDXrandrFallback();
     bool tryXRandrCTM();
     bool tryWaylandColorMgmt();
+    bool tryDrmAtomic();
     
     // Implementation methods
     bool setAMDVibrance(const std::string& displayId, float vibrance);
     bool setXRandrVibrance(const std::string& displayId, float vibrance);
     bool setWaylandVibrance(const std::string& displayId, float vibrance);
+    bool setDrmVibrance(const std::string& displayId, float vibrance);
     
     // Helper methods
+    bool applyVibranceLocked(const std::string& displayId, float vibrance);
     void detectDisplays();
-    void loadProfiles();
-    void saveProfiles();
-    std::string getConfigPath();
-    
-    // Application monitoring
-    void checkActiveApplication();
-    std::string getCurrentActiveWindow();
-    void applyProfileForApp(const std::string& appName, const std::string& windowTitle);
+    void addDisplay(std::vector<VividDisplay>& displays, const std::string& output);
+    void handleOutputsChanged();
+    void prewarmProfileRamps(const AppProfile& profile);
 };
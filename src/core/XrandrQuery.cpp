@@ -0,0 +1,74 @@
+#include "XrandrQuery.h"
+#include "Metrics.h"
+#include <cstdio>
+
+namespace {
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Splits one line into at most maxFields whitespace-separated fields
+size_t splitFields(const std::string& text, size_t begin, size_t end, std::string* fields, size_t maxFields) {
+    size_t count = 0;
+    size_t i = begin;
+    while (i < end && count < maxFields) {
+        while (i < end && isBlank(text[i])) i++;
+        size_t start = i;
+        while (i < end && !isBlank(text[i])) i++;
+        if (i > start) fields[count++].assign(text, start, i - start);
+    }
+    return count;
+}
+
+template <typename Line>
+void forEachLine(const std::string& text, Line line) {
+    size_t begin = 0;
+    while (begin < text.size()) {
+        size_t end = text.find('\n', begin);
+        if (end == std::string::npos) end = text.size();
+        line(begin, end);
+        begin = end + 1;
+    }
+}
+
+} // namespace
+
+bool runXrandr(const std::string& arguments, std::string& output) {
+    Metrics::count(Counter::PROCESS_SPAWNS);
+    std::string command = "xrandr " + arguments + " 2>/dev/null";
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe) return false;
+
+    char buffer[4096];
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+        output.append(buffer, length);
+    }
+    return pclose(pipe) == 0;
+}
+
+std::vector<std::string> parseConnectedOutputs(const std::string& query) {
+    std::vector<std::string> outputs;
+    std::string fields[2];
+    forEachLine(query, [&](size_t begin, size_t end) {
+        // Output lines start in column 0; indented lines are modes and properties
+        if (begin == end || isBlank(query[begin])) return;
+        if (splitFields(query, begin, end, fields, 2) == 2 && fields[1] == "connected") {
+            outputs.push_back(fields[0]);
+        }
+    });
+    return outputs;
+}
+
+std::vector<std::string> parseMonitorOutputs(const std::string& listing) {
+    std::vector<std::string> outputs;
+    std::string fields[4];
+    forEachLine(listing, [&](size_t begin, size_t end) {
+        // " 0: +*DP-1 2560/597x1440/336+0+0  DP-1": the fourth field names the output
+        if (splitFields(listing, begin, end, fields, 4) == 4 && fields[0] != "Monitors:") {
+            outputs.push_back(fields[3]);
+        }
+    });
+    return outputs;
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Display enumeration through the xrandr tool, for when no backend connection exists.
+// The tool's whole output is read in one spawn and parsed here, instead of piping it
+// through grep and awk.
+
+// Runs `xrandr <arguments>` and collects its stdout; false when it could not be run
+bool runXrandr(const std::string& arguments, std::string& output);
+
+// Names of the connected outputs in `xrandr --query` output, in listed order
+std::vector<std::string> parseConnectedOutputs(const std::string& query);
+
+// Output names from `xrandr --listmonitors`, one per active monitor
+std::vector<std::string> parseMonitorOutputs(const std::string& listing);
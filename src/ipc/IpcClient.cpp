@@ -0,0 +1,211 @@
+#include "IpcClient.h"
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+IpcClient::~IpcClient() {
+    close();
+}
+
+bool IpcClient::connect(const std::string& path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_fd >= 0) return true;
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) return false;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    m_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_fd < 0) return false;
+
+    if (::connect(m_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    // A wedged daemon must not hang a hotkey forever
+    timeval timeout = {2, 0};
+    setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(m_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    return true;
+}
+
+void IpcClient::close() {
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+bool IpcClient::call(const IpcRequest& request, IpcResponse& response) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_fd < 0) return false;
+
+    m_buffer.clear();
+    encodeRequest(request, m_buffer);
+
+    size_t sent = 0;
+    while (sent < m_buffer.size()) {
+        ssize_t written = send(m_fd, m_buffer.data() + sent, m_buffer.size() - sent, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) {
+            close();
+            return false;
+        }
+        sent += written;
+    }
+
+    // Requests are answered in order, so the next complete frame is ours
+    m_buffer.clear();
+    uint8_t chunk[4096];
+    while (true) {
+        long payload = completeFrame(m_buffer.data(), m_buffer.size());
+        if (payload < 0) {
+            close();
+            return false;
+        }
+        if (payload > 0) {
+            bool ok = decodeResponse(m_buffer.data() + kIpcFrameHeader, payload, response);
+            if (!ok) close();
+            return ok;
+        }
+
+        ssize_t length = recv(m_fd, chunk, sizeof(chunk), 0);
+        if (length < 0 && errno == EINTR) continue;
+        if (length <= 0) {
+            close();
+            return false;
+        }
+        m_buffer.insert(m_buffer.end(), chunk, chunk + length);
+    }
+}
+
+bool IpcClient::simpleCall(const IpcRequest& request, IpcResponse& response) {
+    return call(request, response) && response.status == IpcStatus::OK;
+}
+
+bool IpcClient::ping() {
+    IpcRequest request;
+    IpcResponse response;
+    return simpleCall(request, response);
+}
+
+bool IpcClient::list(std::vector<IpcOutputState>& outputs) {
+    IpcRequest request;
+    request.opcode = IpcOpcode::LIST;
+    IpcResponse response;
+    if (!simpleCall(request, response)) return false;
+    outputs = std::move(response.outputs);
+    return true;
+}
+
+bool IpcClient::getVibrance(const std::string& output, int& vibrance) {
+    IpcRequest request;
+    request.opcode = IpcOpcode::GET;
+    request.output = output;
+    IpcResponse response;
+    if (!simpleCall(request, response)) return false;
+    vibrance = response.value;
+    return true;
+}
+
+bool IpcClient::setVibrance(const std::string& output, int vibrance, uint32_t durationMs) {
+    IpcRequest request;
+    request.opcode = IpcOpcode::SET;
+    request.output = output;
+    request.value = vibrance;
+    request.durationMs = durationMs;
+    IpcResponse response;
+    return simpleCall(request, response);
+}
+
+bool IpcClient::reset() {
+    IpcRequest request;
+    request.opcode = IpcOpcode::RESET;
+    IpcResponse response;
+    return simpleCall(request, response);
+}
+
+bool IpcClient::setTemperature(int kelvin) {
+    IpcRequest request;
+    request.opcode = IpcOpcode::SET_TEMPERATURE;
+    request.value = kelvin;
+    IpcResponse response;
+    return simpleCall(request, response);
+}
+
+bool IpcClient::stats(std::string& report) {
+    IpcRequest request;
+    request.opcode = IpcOpcode::STATS;
+    IpcResponse response;
+    if (!simpleCall(request, response)) return false;
+    report = std::move(response.text);
+    return true;
+}
+
+bool IpcClient::listProfiles(std::vector<AppProfile>& profiles, std::string& active) {
+    IpcRequest request;
+    request.opcode = IpcOpcode::PROFILE_LIST;
+    IpcResponse response;
+    if (!simpleCall(request, response)) return false;
+    profiles = std::move(response.profiles);
+    active = std::move(response.text);
+    return true;
+}
+
+bool IpcClient::getProfile(const std::string& name, AppProfile& profile) {
+    IpcRequest request;
+    request.opcode = IpcOpcode::PROFILE_GET;
+    request.output = name;
+    IpcResponse response;
+    if (!simpleCall(request, response) || response.profiles.size() != 1) return false;
+    profile = std::move(response.profiles[0]);
+    return true;
+}
+
+bool IpcClient::saveProfile(const AppProfile& profile) {
+    IpcRequest request;
+    request.opcode = IpcOpcode::PROFILE_SAVE;
+    request.profile = profile;
+    IpcResponse response;
+    return simpleCall(request, response);
+}
+
+bool IpcClient::applyProfile(const std::string& name) {
+    IpcRequest request;
+    request.opcode = IpcOpcode::PROFILE_APPLY;
+    request.output = name;
+    IpcResponse response;
+    return simpleCall(request, response);
+}
+
+bool IpcClient::deleteProfile(const std::string& name) {
+    IpcRequest request;
+    request.opcode = IpcOpcode::PROFILE_DELETE;
+    request.output = name;
+    IpcResponse response;
+    return simpleCall(request, response);
+}
+
+bool IpcClient::ddcList(std::vector<IpcOutputState>& monitors) {
+    IpcRequest request;
+    request.opcode = IpcOpcode::DDC_LIST;
+    IpcResponse response;
+    if (!simpleCall(request, response)) return false;
+    monitors = std::move(response.outputs);
+    return true;
+}
+
+bool IpcClient::setDdcSaturation(const std::string& monitor, int percent) {
+    IpcRequest request;
+    request.opcode = IpcOpcode::DDC_SET_SATURATION;
+    request.output = monitor;
+    request.value = percent;
+    IpcResponse response;
+    return simpleCall(request, response);
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "Protocol.h"
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Blocking client for the daemon socket. Calls are serialised, so one client can be
+// shared by the GUI's apply worker and night light threads.
+class IpcClient {
+public:
+    IpcClient() = default;
+    ~IpcClient();
+
+    IpcClient(const IpcClient&) = delete;
+    IpcClient& operator=(const IpcClient&) = delete;
+
+    // False when no daemon is listening
+    bool connect(const std::string& path = defaultSocketPath());
+    void close();
+    bool isConnected() const { return m_fd >= 0; }
+
+    // Transport errors close the connection and return false; response.status carries
+    // the daemon's own verdict
+    bool call(const IpcRequest& request, IpcResponse& response);
+
+    bool ping();
+    bool list(std::vector<IpcOutputState>& outputs);
+    bool getVibrance(const std::string& output, int& vibrance);
+    bool setVibrance(const std::string& output, int vibrance, uint32_t durationMs = 0);
+    bool reset();
+    bool setTemperature(int kelvin);
+    bool stats(std::string& report);
+    // active is empty while no profile is applied
+    bool listProfiles(std::vector<AppProfile>& profiles, std::string& active);
+    bool getProfile(const std::string& name, AppProfile& profile);
+    bool saveProfile(const AppProfile& profile);
+    bool applyProfile(const std::string& name);
+    bool deleteProfile(const std::string& name);
+    // Monitor saturation over DDC/CI, in percent: 100 is neutral, 0 to 200
+    bool ddcList(std::vector<IpcOutputState>& monitors);
+    bool setDdcSaturation(const std::string& monitor, int percent);
+
+private:
+    int m_fd = -1;
+    std::mutex m_mutex;
+    std::vector<uint8_t> m_buffer;
+
+    bool simpleCall(const IpcRequest& request, IpcResponse& response);
+};
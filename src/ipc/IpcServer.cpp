@@ -0,0 +1,204 @@
+#include "IpcServer.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/file.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kMaxClients = 64;
+
+} // namespace
+
+IpcServer::IpcServer(Handler handler)
+    : m_handler(std::move(handler)) {}
+
+IpcServer::~IpcServer() {
+    stop();
+    closeAll();
+}
+
+bool IpcServer::listen(const std::string& path) {
+    if (m_listenFd >= 0) return true;
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) return false;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    // The lock, not the socket file, decides who owns the session; a stale socket
+    // left by a crash is simply replaced by whoever gets the lock next
+    std::string lockPath = path + ".lock";
+    m_lockFd = ::open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (m_lockFd < 0) return false;
+    if (flock(m_lockFd, LOCK_EX | LOCK_NB) != 0) {
+        closeAll();
+        return false;
+    }
+
+    m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    m_stopFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_listenFd < 0 || m_stopFd < 0) {
+        closeAll();
+        return false;
+    }
+
+    unlink(path.c_str());
+    mode_t previous = umask(0077);
+    bool bound = bind(m_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+    umask(previous);
+    if (!bound || ::listen(m_listenFd, 16) != 0) {
+        closeAll();
+        return false;
+    }
+
+    m_path = path;
+    return true;
+}
+
+bool IpcServer::start() {
+    if (m_listenFd < 0 || m_thread.joinable()) return false;
+    m_thread = std::thread(&IpcServer::run, this);
+    return true;
+}
+
+void IpcServer::stop() {
+    if (m_stopFd >= 0) {
+        uint64_t one = 1;
+        ssize_t written = write(m_stopFd, &one, sizeof(one));
+        (void)written;
+    }
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void IpcServer::run() {
+    std::vector<pollfd> fds;
+
+    while (true) {
+        fds.clear();
+        fds.push_back({m_stopFd, POLLIN, 0});
+        fds.push_back({m_listenFd, static_cast<short>(m_clients.size() < kMaxClients ? POLLIN : 0), 0});
+        for (const auto& client : m_clients) {
+            fds.push_back({client.fd, static_cast<short>(client.output.empty() ? POLLIN : POLLOUT), 0});
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            uint64_t value;
+            ssize_t drained = read(m_stopFd, &value, sizeof(value));
+            (void)drained;
+            break;
+        }
+
+        // Clients first: accepting appends to m_clients, which would shift the indices
+        for (size_t i = m_clients.size(); i-- > 0;) {
+            short revents = fds[i + 2].revents;
+            if (!revents) continue;
+
+            Client& client = m_clients[i];
+            bool keep = true;
+            if (revents & POLLOUT) {
+                keep = writeClient(client);
+            } else if (revents & POLLIN) {
+                keep = readClient(client);
+            } else {
+                keep = false;
+            }
+
+            if (!keep) {
+                close(client.fd);
+                m_clients.erase(m_clients.begin() + i);
+            }
+        }
+
+        if (fds[1].revents & POLLIN) {
+            acceptClients();
+        }
+    }
+}
+
+void IpcServer::acceptClients() {
+    while (m_clients.size() < kMaxClients) {
+        int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+        if (fd < 0) return;
+
+        Client client;
+        client.fd = fd;
+        m_clients.push_back(std::move(client));
+    }
+}
+
+bool IpcServer::readClient(Client& client) {
+    uint8_t buffer[4096];
+    ssize_t length = recv(client.fd, buffer, sizeof(buffer), 0);
+    if (length == 0) return false;
+    if (length < 0) return errno == EAGAIN || errno == EINTR;
+    client.input.insert(client.input.end(), buffer, buffer + length);
+
+    // Answer every complete frame; a pipelining client gets all its responses in one write
+    size_t offset = 0;
+    while (true) {
+        long payload = completeFrame(client.input.data() + offset, client.input.size() - offset);
+        if (payload < 0) return false;
+        if (payload == 0) break;
+
+        IpcRequest request;
+        IpcResponse response;
+        if (decodeRequest(client.input.data() + offset + kIpcFrameHeader, payload, request)) {
+            response = m_handler(request);
+        } else {
+            response.status = IpcStatus::BAD_REQUEST;
+        }
+        encodeResponse(response, client.output);
+        m_requests++;
+        offset += kIpcFrameHeader + payload;
+    }
+    client.input.erase(client.input.begin(), client.input.begin() + offset);
+
+    return client.output.empty() || writeClient(client);
+}
+
+bool IpcServer::writeClient(Client& client) {
+    while (!client.output.empty()) {
+        ssize_t written = send(client.fd, client.output.data(), client.output.size(), MSG_NOSIGNAL);
+        if (written < 0) {
+            // Full socket buffer: poll for POLLOUT and finish later
+            return errno == EAGAIN || errno == EINTR;
+        }
+        client.output.erase(client.output.begin(), client.output.begin() + written);
+    }
+    return true;
+}
+
+void IpcServer::closeAll() {
+    for (const auto& client : m_clients) {
+        close(client.fd);
+    }
+    m_clients.clear();
+
+    if (m_listenFd >= 0) {
+        close(m_listenFd);
+        m_listenFd = -1;
+        unlink(m_path.c_str());
+    }
+    if (m_stopFd >= 0) {
+        close(m_stopFd);
+        m_stopFd = -1;
+    }
+    if (m_lockFd >= 0) {
+        close(m_lockFd);
+        m_lockFd = -1;
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "Protocol.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Unix-socket request server. Holding the socket is what makes a process the broker:
+// listen() takes an exclusive lock next to the socket, so only one daemon (or GUI
+// acting as one) per session ever touches gamma, and everyone else becomes a client.
+class IpcServer {
+public:
+    using Handler = std::function<IpcResponse(const IpcRequest& request)>;
+
+    explicit IpcServer(Handler handler);
+    ~IpcServer();
+
+    IpcServer(const IpcServer&) = delete;
+    IpcServer& operator=(const IpcServer&) = delete;
+
+    // False when another instance holds the lock or the socket cannot be bound
+    bool listen(const std::string& path = defaultSocketPath());
+
+    // Serves on the calling thread until stop(); start() does the same on its own thread
+    void run();
+    bool start();
+    void stop();
+
+    uint64_t getRequestCount() const { return m_requests.load(); }
+
+private:
+    struct Client {
+        int fd = -1;
+        std::vector<uint8_t> input;
+        std::vector<uint8_t> output;
+    };
+
+    Handler m_handler;
+    std::string m_path;
+    int m_listenFd = -1;
+    int m_lockFd = -1;
+    int m_stopFd = -1;
+    std::thread m_thread;
+    std::vector<Client> m_clients;
+    std::atomic<uint64_t> m_requests{0};
+
+    void acceptClients();
+    // False when the client hung up or sent something that is not a frame
+    bool readClient(Client& client);
+    bool writeClient(Client& client);
+    void closeAll();
+};
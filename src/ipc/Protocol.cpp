@@ -0,0 +1,220 @@
+#include "Protocol.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+namespace {
+
+void putU16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void putU32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+void putString(std::vector<uint8_t>& out, const std::string& value) {
+    uint16_t length = static_cast<uint16_t>(std::min<size_t>(value.size(), 0xFFFF));
+    putU16(out, length);
+    out.insert(out.end(), value.begin(), value.begin() + length);
+}
+
+void putProfile(std::vector<uint8_t>& out, const AppProfile& profile) {
+    putString(out, profile.name);
+    putString(out, profile.executable);
+    putString(out, profile.windowTitle);
+    out.push_back(static_cast<uint8_t>((profile.pathMatching ? 1 : 0) | (profile.enabled ? 2 : 0)));
+    putU16(out, static_cast<uint16_t>(std::min<size_t>(profile.displayVibrance.size(), 0xFFFF)));
+    size_t written = 0;
+    for (const auto& pair : profile.displayVibrance) {
+        if (written++ == 0xFFFF) break;
+        putString(out, pair.first);
+        uint32_t bits;
+        std::memcpy(&bits, &pair.second, sizeof(bits));
+        putU32(out, bits);
+    }
+}
+
+// Reserves the header, returns its offset so the length can be patched in afterwards
+size_t beginFrame(std::vector<uint8_t>& out) {
+    size_t offset = out.size();
+    out.resize(offset + kIpcFrameHeader);
+    return offset;
+}
+
+void endFrame(std::vector<uint8_t>& out, size_t offset) {
+    uint32_t length = static_cast<uint32_t>(out.size() - offset - kIpcFrameHeader);
+    for (size_t i = 0; i < kIpcFrameHeader; i++) {
+        out[offset + i] = static_cast<uint8_t>(length >> (8 * i));
+    }
+}
+
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+    bool u8(uint8_t& value) {
+        if (m_offset + 1 > m_size) return false;
+        value = m_data[m_offset++];
+        return true;
+    }
+
+    bool u16(uint16_t& value) {
+        if (m_offset + 2 > m_size) return false;
+        value = static_cast<uint16_t>(m_data[m_offset] | (m_data[m_offset + 1] << 8));
+        m_offset += 2;
+        return true;
+    }
+
+    bool u32(uint32_t& value) {
+        if (m_offset + 4 > m_size) return false;
+        value = 0;
+        for (int i = 0; i < 4; i++) {
+            value |= static_cast<uint32_t>(m_data[m_offset + i]) << (8 * i);
+        }
+        m_offset += 4;
+        return true;
+    }
+
+    bool i32(int32_t& value) {
+        uint32_t raw;
+        if (!u32(raw)) return false;
+        value = static_cast<int32_t>(raw);
+        return true;
+    }
+
+    bool string(std::string& value) {
+        uint16_t length;
+        if (!u16(length) || m_offset + length > m_size) return false;
+        value.assign(reinterpret_cast<const char*>(m_data + m_offset), length);
+        m_offset += length;
+        return true;
+    }
+
+    bool f32(float& value) {
+        uint32_t bits;
+        if (!u32(bits)) return false;
+        std::memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
+
+    bool profile(AppProfile& value) {
+        uint8_t flags;
+        uint16_t count;
+        if (!string(value.name) || !string(value.executable) || !string(value.windowTitle) ||
+            !u8(flags) || !u16(count)) {
+            return false;
+        }
+        value.pathMatching = (flags & 1) != 0;
+        value.enabled = (flags & 2) != 0;
+        value.displayVibrance.clear();
+        for (uint16_t i = 0; i < count; i++) {
+            std::string output;
+            float vibrance;
+            if (!string(output) || !f32(vibrance)) return false;
+            value.displayVibrance[output] = vibrance;
+        }
+        return true;
+    }
+
+    bool done() const { return m_offset == m_size; }
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_offset = 0;
+};
+
+} // namespace
+
+void encodeRequest(const IpcRequest& request, std::vector<uint8_t>& out) {
+    size_t frame = beginFrame(out);
+    out.push_back(static_cast<uint8_t>(request.opcode));
+    putU32(out, static_cast<uint32_t>(request.value));
+    putU32(out, request.durationMs);
+    putString(out, request.output);
+    if (request.opcode == IpcOpcode::PROFILE_SAVE) {
+        putProfile(out, request.profile);
+    }
+    endFrame(out, frame);
+}
+
+void encodeResponse(const IpcResponse& response, std::vector<uint8_t>& out) {
+    size_t frame = beginFrame(out);
+    out.push_back(static_cast<uint8_t>(response.status));
+    putU32(out, static_cast<uint32_t>(response.value));
+    putU16(out, static_cast<uint16_t>(std::min<size_t>(response.outputs.size(), 0xFFFF)));
+    for (size_t i = 0; i < response.outputs.size() && i < 0xFFFF; i++) {
+        putString(out, response.outputs[i].output);
+        putU32(out, static_cast<uint32_t>(response.outputs[i].vibrance));
+    }
+    putString(out, response.text);
+    putU16(out, static_cast<uint16_t>(std::min<size_t>(response.profiles.size(), 0xFFFF)));
+    for (size_t i = 0; i < response.profiles.size() && i < 0xFFFF; i++) {
+        putProfile(out, response.profiles[i]);
+    }
+    endFrame(out, frame);
+}
+
+bool decodeRequest(const uint8_t* data, size_t size, IpcRequest& request) {
+    Reader reader(data, size);
+    uint8_t opcode;
+    if (!reader.u8(opcode) || !reader.i32(request.value) || !reader.u32(request.durationMs) ||
+        !reader.string(request.output)) {
+        return false;
+    }
+    if (opcode < static_cast<uint8_t>(IpcOpcode::PING) ||
+        opcode > static_cast<uint8_t>(IpcOpcode::DDC_SET_SATURATION)) {
+        return false;
+    }
+    request.opcode = static_cast<IpcOpcode>(opcode);
+    if (request.opcode == IpcOpcode::PROFILE_SAVE && !reader.profile(request.profile)) {
+        return false;
+    }
+    return reader.done();
+}
+
+bool decodeResponse(const uint8_t* data, size_t size, IpcResponse& response) {
+    Reader reader(data, size);
+    uint8_t status;
+    uint16_t count;
+    if (!reader.u8(status) || !reader.i32(response.value) || !reader.u16(count)) {
+        return false;
+    }
+    if (status > static_cast<uint8_t>(IpcStatus::BAD_REQUEST)) return false;
+    response.status = static_cast<IpcStatus>(status);
+
+    response.outputs.resize(count);
+    for (auto& output : response.outputs) {
+        if (!reader.string(output.output) || !reader.i32(output.vibrance)) return false;
+    }
+    if (!reader.string(response.text) || !reader.u16(count)) return false;
+
+    response.profiles.resize(count);
+    for (auto& profile : response.profiles) {
+        if (!reader.profile(profile)) return false;
+    }
+    return reader.done();
+}
+
+long completeFrame(const uint8_t* data, size_t size) {
+    if (size < kIpcFrameHeader) return 0;
+
+    uint32_t length = 0;
+    for (size_t i = 0; i < kIpcFrameHeader; i++) {
+        length |= static_cast<uint32_t>(data[i]) << (8 * i);
+    }
+    if (length == 0 || length > kIpcMaxFrame) return -1;
+    return (size - kIpcFrameHeader >= length) ? static_cast<long>(length) : 0;
+}
+
+std::string defaultSocketPath() {
+    if (const char* runtimeDir = std::getenv("XDG_RUNTIME_DIR")) {
+        if (*runtimeDir) return std::string(runtimeDir) + "/vivid.sock";
+    }
+    return "/tmp/vivid-" + std::to_string(getuid()) + ".sock";
+}
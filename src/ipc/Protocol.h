@@ -0,0 +1,80 @@
+#pragma once
+#include "../core/AppProfile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Daemon wire format. Every message is a frame: a little-endian uint32 payload length
+// followed by the payload. Requests and responses have one fixed layout each, so a
+// message is a handful of bytes and decodes without allocation beyond its strings.
+//
+//   request:  u8 opcode | i32 value | u32 durationMs | u16 length, output bytes
+//             | PROFILE_SAVE only: profile
+//   response: u8 status | i32 value | u16 count, count x (u16 length, output bytes | i32 vibrance)
+//             | u16 length, text bytes | u16 count, count x profile
+//   profile:  name, executable, windowTitle (each u16 length, bytes) | u8 flags (1 pathMatching,
+//             2 enabled) | u16 count, count x (u16 length, output bytes | f32 vibrance as u32)
+
+// Room for a PROFILE_LIST of several thousand profiles
+constexpr uint32_t kIpcMaxFrame = 1024 * 1024;
+constexpr size_t kIpcFrameHeader = 4;
+
+enum class IpcOpcode : uint8_t {
+    PING = 1,
+    LIST = 2,
+    GET = 3,
+    SET = 4,              // output, value; durationMs > 0 animates
+    RESET = 5,
+    SET_TEMPERATURE = 6,  // value in kelvin
+    STATS = 7,            // text carries the daemon's formatted metrics
+    PROFILE_LIST = 8,     // profiles; text names the active profile
+    PROFILE_GET = 9,      // output carries the name; one profile back
+    PROFILE_SAVE = 10,    // the request's profile; replaces one of the same name
+    PROFILE_APPLY = 11,   // output carries the name
+    PROFILE_DELETE = 12,  // output carries the name
+    DDC_LIST = 13,        // DDC/CI monitors; outputs carry saturation in percent, 100 neutral
+    DDC_SET_SATURATION = 14  // output, value in percent from 0 to 200
+};
+
+enum class IpcStatus : uint8_t {
+    OK = 0,
+    FAILED = 1,
+    BAD_REQUEST = 2
+};
+
+struct IpcRequest {
+    IpcOpcode opcode = IpcOpcode::PING;
+    int32_t value = 0;
+    uint32_t durationMs = 0;
+    std::string output;
+    AppProfile profile;  // PROFILE_SAVE only
+};
+
+struct IpcOutputState {
+    std::string output;
+    int32_t vibrance = 0;
+};
+
+struct IpcResponse {
+    IpcStatus status = IpcStatus::OK;
+    int32_t value = 0;
+    std::vector<IpcOutputState> outputs;
+    std::string text;
+    std::vector<AppProfile> profiles;
+};
+
+// Append one complete frame to out
+void encodeRequest(const IpcRequest& request, std::vector<uint8_t>& out);
+void encodeResponse(const IpcResponse& response, std::vector<uint8_t>& out);
+
+// Decode a payload (frame header already stripped)
+bool decodeRequest(const uint8_t* data, size_t size, IpcRequest& request);
+bool decodeResponse(const uint8_t* data, size_t size, IpcResponse& response);
+
+// Payload length of the frame at the start of buffer: >0 when it is fully buffered,
+// 0 when more bytes are needed, -1 when the length is out of range
+long completeFrame(const uint8_t* data, size_t size);
+
+// $XDG_RUNTIME_DIR/vivid.sock, or a per-user path in /tmp when that is unset
+std::string defaultSocketPath();
@@ -0,0 +1,151 @@
+#include "VividDaemon.h"
+#include "../core/VibranceController.h"
+#include "../core/ProfileManager.h"
+#include "../core/Metrics.h"
+#include "../SaturationController.h"
+#include <chrono>
+#include <cmath>
+
+VividDaemon::VividDaemon()
+    : m_server([this](const IpcRequest& request) { return handle(request); }) {}
+
+VividDaemon::~VividDaemon() {
+    m_server.stop();
+}
+
+VibranceController& VividDaemon::controller() {
+    if (!m_controller) {
+        m_controller = std::make_unique<VibranceController>();
+    }
+    return *m_controller;
+}
+
+ProfileManager& VividDaemon::profiles() {
+    if (!m_profiles) {
+        VibranceController& target = controller();
+        m_profiles = std::make_unique<ProfileManager>(
+            ProfileManager::getConfigDirectory(),
+            [&target](const std::string& displayId, float vibrance) {
+                return target.setVibrance(displayId, static_cast<int>(std::lround(vibrance)));
+            },
+            [&target]() {
+                // Whatever the user had set, to go back to once no profile matches
+                std::map<std::string, float> current;
+                DisplaySnapshot displays = target.getDisplays();
+                for (const auto& display : *displays) {
+                    current[display.id] = static_cast<float>(display.currentVibrance);
+                }
+                return current;
+            });
+        m_profiles->load();
+    }
+    return *m_profiles;
+}
+
+SaturationController* VividDaemon::ddc() {
+    if (!m_ddc) {
+        auto controller = std::make_unique<SaturationController>(true);
+        if (!controller->isInitialized()) return nullptr;
+        // Detection registers each monitor with the write scheduler
+        controller->getDisplays();
+        m_ddc = std::move(controller);
+    }
+    return m_ddc.get();
+}
+
+void VividDaemon::run() {
+    profiles().startMonitoring();
+    m_server.run();
+}
+
+bool VividDaemon::start() {
+    profiles().startMonitoring();
+    return m_server.start();
+}
+
+IpcResponse VividDaemon::handle(const IpcRequest& request) {
+    VibranceController& target = controller();
+    IpcResponse response;
+    bool ok = true;
+
+    switch (request.opcode) {
+        case IpcOpcode::PING:
+            break;
+        case IpcOpcode::LIST: {
+            DisplaySnapshot displays = target.getDisplays();
+            for (const auto& display : *displays) {
+                response.outputs.push_back({display.id, display.currentVibrance});
+            }
+            break;
+        }
+        case IpcOpcode::GET:
+            response.value = target.getVibrance(request.output);
+            break;
+        case IpcOpcode::SET:
+            if (request.output.empty()) {
+                response.status = IpcStatus::BAD_REQUEST;
+                return response;
+            }
+            ok = (request.durationMs > 0)
+                ? target.animateVibrance(request.output, request.value,
+                                         std::chrono::milliseconds(request.durationMs))
+                : target.setVibrance(request.output, request.value);
+            break;
+        case IpcOpcode::RESET:
+            ok = target.resetAllDisplays();
+            break;
+        case IpcOpcode::SET_TEMPERATURE:
+            ok = target.setTemperature(request.value);
+            break;
+        case IpcOpcode::STATS:
+            response.text = Metrics::format(Metrics::collect());
+            break;
+        case IpcOpcode::PROFILE_LIST: {
+            ProfileSnapshot snapshot = profiles().getProfiles();
+            response.profiles = snapshot->profiles;
+            response.text = profiles().getActiveProfile();
+            break;
+        }
+        case IpcOpcode::PROFILE_GET:
+            response.profiles.resize(1);
+            ok = profiles().findProfile(request.output, response.profiles[0]);
+            if (!ok) response.profiles.clear();
+            break;
+        case IpcOpcode::PROFILE_SAVE:
+            if (request.profile.name.empty()) {
+                response.status = IpcStatus::BAD_REQUEST;
+                return response;
+            }
+            ok = profiles().saveProfile(request.profile);
+            break;
+        case IpcOpcode::PROFILE_APPLY:
+            ok = profiles().applyProfile(request.output);
+            break;
+        case IpcOpcode::PROFILE_DELETE:
+            ok = profiles().deleteProfile(request.output);
+            break;
+        case IpcOpcode::DDC_LIST: {
+            SaturationController* monitors = ddc();
+            ok = monitors != nullptr;
+            if (!ok) break;
+            // Re-detects, so monitors plugged in since the last request show up
+            for (const auto& monitor : monitors->getDisplays()) {
+                int percent = static_cast<int>(std::lround(monitors->getSaturation(monitor) * 100.0f));
+                response.outputs.push_back({monitor, percent});
+            }
+            break;
+        }
+        case IpcOpcode::DDC_SET_SATURATION: {
+            if (request.output.empty() || request.value < 0 || request.value > 200) {
+                response.status = IpcStatus::BAD_REQUEST;
+                return response;
+            }
+            SaturationController* monitors = ddc();
+            ok = monitors && monitors->setSaturation(request.output, request.value / 100.0f);
+            break;
+        }
+    }
+
+    if (!ok) response.status = IpcStatus::FAILED;
+    return response;
+}
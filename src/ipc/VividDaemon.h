@@ -0,0 +1,38 @@
+#pragma once
+#include "IpcServer.h"
+#include <memory>
+
+class VibranceController;
+class ProfileManager;
+class SaturationController;
+
+// Serves a VibranceController and the profiles applied through it over the session
+// socket. Run by `vivid --daemon`, or by the GUI when it finds no daemon, so one process
+// per session owns gamma and the profile store.
+class VividDaemon {
+public:
+    VividDaemon();
+    ~VividDaemon();
+
+    // Take the session lock before anything touches a display
+    bool listen(const std::string& path = defaultSocketPath()) { return m_server.listen(path); }
+    // Both also start focus tracking, so profiles follow the active window
+    void run();
+    bool start();
+    void stop() { m_server.stop(); }
+
+    // Created on first use, so a daemon that loses the lock never opens a backend
+    VibranceController& controller();
+    ProfileManager& profiles();
+    IpcResponse handle(const IpcRequest& request);
+
+private:
+    // Null while no DDC/CI bus is accessible; asks again on the next request
+    SaturationController* ddc();
+
+    std::unique_ptr<VibranceController> m_controller;
+    std::unique_ptr<ProfileManager> m_profiles;  // applies through m_controller
+    // DDC/CI saturation, opened on the first DDC request; only the server thread uses it
+    std::unique_ptr<SaturationController> m_ddc;
+    IpcServer m_server;  // declared last: its thread stops before the controller goes away
+};
@@ -1,8 +1,60 @@
 #include "MainWindow.h"
 #include <iostream>
 
+namespace {
+
+// Slider moves and resets ease in over a few frames; new positions retarget mid-flight
+constexpr std::chrono::milliseconds kVibranceTransition(150);
+
+struct ApplyCompletion {
+    std::shared_ptr<MainWindow*> window;
+    std::string displayId;
+    int vibrance;
+    bool success;
+};
+
+} // namespace
+
 MainWindow::MainWindow(GtkApplication* app) {
-    m_controller = std::make_unique<VibranceController>();
+    m_client = std::make_unique<IpcClient>();
+    if (!m_client->connect()) {
+        // Nobody owns the session yet: this window does, and serves the CLI meanwhile
+        m_client.reset();
+        m_daemon = std::make_unique<VividDaemon>();
+        if (m_daemon->listen()) {
+            m_daemon->start();
+        }
+        m_controller = &m_daemon->controller();
+    }
+    m_self = std::make_shared<MainWindow*>(this);
+    
+    std::shared_ptr<MainWindow*> self = m_self;
+    m_applyWorker = std::make_unique<ApplyWorker>(
+        [this](const std::string& displayId, int vibrance) {
+            return applyVibrance(displayId, vibrance);
+        },
+        [self](const std::string& displayId, int vibrance, bool success) {
+            // Hand the result back to the GTK main loop; widgets are not thread-safe
+            auto* completion = new ApplyCompletion{self, displayId, vibrance, success};
+            g_main_context_invoke_full(nullptr, G_PRIORITY_DEFAULT,
+                [](gpointer data) -> gboolean {
+                    auto* completion = static_cast<ApplyCompletion*>(data);
+                    if (MainWindow* window = *completion->window) {
+                        window->onApplyCompleted(completion->displayId, completion->vibrance, completion->success);
+                    }
+                    return G_SOURCE_REMOVE;
+                },
+                completion,
+                [](gpointer data) { delete static_cast<ApplyCompletion*>(data); });
+        });
+    
+    NightLightConfig nightLightConfig = NightLightConfig::load(NightLightConfig::getConfigPath());
+    if (nightLightConfig.enabled) {
+        m_nightLight = std::make_unique<NightLight>([this](int kelvin) {
+            applyTemperature(kelvin);
+        });
+        m_nightLight->start(nightLightConfig);
+    }
     
     m_window = gtk_application_window_new(app);
     gtk_window_set_title(GTK_WINDOW(m_window), "Vivid");
@@ -13,7 +65,27 @@ MainWindow::MainWindow(GtkApplication* app) {
     setupUI();
 }
 
-MainWindow::~MainWindow() = default;
+MainWindow::~MainWindow() {
+    // Join the threads before the controller they call into goes away
+    m_nightLight.reset();
+    m_applyWorker.reset();
+    *m_self = nullptr;
+}
+
+bool MainWindow::applyVibrance(const std::string& displayId, int vibrance) {
+    if (m_client) {
+        return m_client->setVibrance(displayId, vibrance, static_cast<uint32_t>(kVibranceTransition.count()));
+    }
+    return m_controller->animateVibrance(displayId, vibrance, kVibranceTransition);
+}
+
+void MainWindow::applyTemperature(int kelvin) {
+    if (m_client) {
+        m_client->setTemperature(kelvin);
+    } else {
+        m_controller->setTemperature(kelvin);
+    }
+}
 
 void MainWindow::applyTheme() {
     GtkCssProvider* provider = gtk_css_provider_new();
@@ -123,9 +195,24 @@ void MainWindow::setupUI() {
 }
 
 void MainWindow::setupDisplayControls() {
-    auto displays = m_controller->getDisplays();
+    DisplaySnapshot displays;
+    if (m_client) {
+        std::vector<IpcOutputState> outputs;
+        m_client->list(outputs);
+        DisplayList list;
+        for (const auto& output : outputs) {
+            Display display;
+            display.id = output.output;
+            display.name = output.output;
+            display.currentVibrance = output.vibrance;
+            list.push_back(display);
+        }
+        displays = DisplaySnapshot::make(std::move(list));
+    } else {
+        displays = m_controller->getDisplays();
+    }
     
-    for (const auto& display : displays) {
+    for (const auto& display : *displays) {
         GtkWidget* displaySection = gtk_box_new(GTK_ORIENTATION_VERTICAL, 6);
         gtk_widget_add_css_class(displaySection, "display-section");
         
@@ -175,24 +262,27 @@ void MainWindow::onVibranceChanged(GtkRange* range, gpointer user_data) {
     double value = gtk_range_get_value(range);
     int vibrance = static_cast<int>(value);
     
-    window->m_controller->setVibrance(displayId, vibrance);
-    window->updateValueLabel(displayId, vibrance);
+    window->m_applyWorker->submit(displayId, vibrance);
+}
+
+void MainWindow::onApplyCompleted(const std::string& displayId, int vibrance, bool success) {
+    if (success) {
+        updateValueLabel(displayId, vibrance);
+    }
 }
 
 void MainWindow::onResetClicked(GtkButton* button, gpointer user_data) {
     auto* window = static_cast<MainWindow*>(user_data);
     
-    window->m_controller->resetAllDisplays();
-    
+    // Resets go through the worker like slider moves so the main thread never blocks
     for (const auto& pair : window->m_vibranceScales) {
         gtk_range_set_value(GTK_RANGE(pair.second), 0.0);
-        window->updateValueLabel(pair.first, 0);
+        window->m_applyWorker->submit(pair.first, 0);
     }
 }
 
 void MainWindow::onInstallClicked(GtkButton* button, gpointer user_data) {
-    auto* window = static_cast<MainWindow*>(user_data);
-    window->m_controller->installSystemWide();
+    VibranceController::installSystemWide();
 }
 
 void MainWindow::show() {
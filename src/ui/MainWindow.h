@@ -4,6 +4,10 @@
 #include <map>
 #include <functional>
 #include "../core/VibranceController.h"
+#include "../core/ApplyWorker.h"
+#include "../core/NightLight.h"
+#include "../ipc/IpcClient.h"
+#include "../ipc/VividDaemon.h"
 
 class MainWindow {
 public:
@@ -16,12 +20,22 @@ private:
     GtkWidget* m_mainBox = nullptr;
     std::map<std::string, GtkWidget*> m_vibranceScales;
     std::map<std::string, GtkWidget*> m_valueLabels;
-    std::unique_ptr<VibranceController> m_controller;
+    // Either a client of the running daemon, or the daemon itself when there is none
+    std::unique_ptr<IpcClient> m_client;
+    std::unique_ptr<VividDaemon> m_daemon;
+    VibranceController* m_controller = nullptr;
+    std::unique_ptr<ApplyWorker> m_applyWorker;
+    std::unique_ptr<NightLight> m_nightLight;
+    std::shared_ptr<MainWindow*> m_self; // cleared on destruction so late completions are dropped
     
     void setupUI();
     void setupDisplayControls();
     void applyTheme();
     void updateValueLabel(const std::string& displayId, int vibrance);
+    bool applyVibrance(const std::string& displayId, int vibrance);
+    void applyTemperature(int kelvin);
+    
+    void onApplyCompleted(const std::string& displayId, int vibrance, bool success);
     
     static void onVibranceChanged(GtkRange* range, gpointer user_data);
     static void onResetClicked(GtkButton* button, gpointer user_data);
@@ -0,0 +1,51 @@
+#!/bin/bash
+
+echo "🧪 Testing DRM atomic backend on vkms"
+echo "====================================="
+
+if [ ! -f "builddir/vivid-cli" ]; then
+    echo "❌ Please build first: ./quick-build.sh"
+    exit 1
+fi
+
+if [ "$(id -u)" -ne 0 ]; then
+    echo "❌ Needs root to load vkms and become DRM master: sudo $0"
+    exit 1
+fi
+
+if ! modprobe vkms 2>/dev/null; then
+    echo "❌ Could not load the vkms module"
+    exit 1
+fi
+sleep 1
+
+CARD=""
+for dev in /sys/class/drm/card*; do
+    if [ "$(basename "$(readlink -f "$dev/device/driver")")" = "vkms" ]; then
+        CARD="/dev/dri/$(basename "$dev")"
+        break
+    fi
+done
+if [ -z "$CARD" ]; then
+    echo "❌ vkms loaded but no card node found"
+    exit 1
+fi
+echo "🖥️ Device: $CARD"
+
+# Pretend to be a TTY session pinned to the virtual card
+export VIVID_DRM_DEVICE="$CARD"
+unset DISPLAY WAYLAND_DISPLAY
+
+OUTPUT=$(./builddir/vivid-cli --list | head -1 | awk '{print $1}')
+if [ -z "$OUTPUT" ]; then
+    echo "❌ No connector with colour properties on $CARD"
+    exit 1
+fi
+echo "📺 Output: $OUTPUT"
+
+if ./builddir/vivid-cli --set "$OUTPUT" 50 && ./builddir/vivid-cli --reset; then
+    echo "✅ GAMMA_LUT commits accepted by vkms"
+else
+    echo "❌ Atomic commit rejected (is another process DRM master?)"
+    exit 1
+fi
@@ -0,0 +1,28 @@
+#!/bin/bash
+
+echo "🧪 Stress-testing SnapshotCell under ThreadSanitizer"
+echo "===================================================="
+
+CXX="${CXX:-g++}"
+if ! command -v "$CXX" &> /dev/null; then
+    echo "❌ $CXX not found"
+    exit 1
+fi
+
+# Header-only, so no meson setup (and no GTK) is needed for a sanitizer build
+BUILD_DIR=$(mktemp -d)
+trap 'rm -rf "$BUILD_DIR"' EXIT
+
+if ! "$CXX" -std=c++17 -O1 -g -fsanitize=thread -Isrc bench/SnapshotBench.cpp \
+        -o "$BUILD_DIR/snapshot-stress" -pthread; then
+    echo "❌ Build with -fsanitize=thread failed"
+    exit 1
+fi
+
+# Any report is a failure, not just a crash
+if TSAN_OPTIONS="halt_on_error=1 exitcode=66" "$BUILD_DIR/snapshot-stress" --stress; then
+    echo "✅ No data races, torn versions or leaked versions"
+else
+    echo "❌ Stress test failed"
+    exit 1
+fi
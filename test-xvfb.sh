@@ -0,0 +1,73 @@
+#!/bin/bash
+
+echo "🧪 Testing native XRandR gamma backend under Xvfb"
+echo "================================================"
+
+if [ ! -f "builddir/vivid-cli" ]; then
+    echo "❌ Please build first: ./quick-build.sh"
+    exit 1
+fi
+
+if ! command -v Xvfb &> /dev/null; then
+    echo "❌ Xvfb not found. Install with:"
+    echo "   Fedora: sudo dnf install xorg-x11-server-Xvfb"
+    echo "   Ubuntu: sudo apt install xvfb"
+    exit 1
+fi
+
+XVFB_DISPLAY=":${XVFB_DISPLAY_NUM:-99}"
+Xvfb "$XVFB_DISPLAY" -screen 0 1920x1080x24 +extension RANDR &> /dev/null &
+XVFB_PID=$!
+trap 'kill $XVFB_PID 2>/dev/null' EXIT
+sleep 1
+
+export DISPLAY="$XVFB_DISPLAY"
+
+OUTPUT=$(xrandr --query 2>/dev/null | grep ' connected' | head -1 | awk '{print $1}')
+if [ -z "$OUTPUT" ]; then
+    echo "❌ Xvfb exposes no connected RandR output"
+    exit 1
+fi
+echo "📺 Output: $OUTPUT"
+
+# Hide the helper tools so only the in-process backend can succeed
+SHIM_DIR=$(mktemp -d)
+trap 'kill $XVFB_PID 2>/dev/null; rm -rf "$SHIM_DIR"' EXIT
+for tool in xgamma redshift xcalib xrandr; do
+    printf '#!/bin/sh\nexit 1\n' > "$SHIM_DIR/$tool"
+    chmod +x "$SHIM_DIR/$tool"
+done
+
+gamma_of() {
+    xrandr --verbose 2>/dev/null | awk -v out="$1" '$1 == out {found=1} found && /Gamma:/ {print $2; exit}'
+}
+
+# Skew the ramp with the real xrandr, then let vivid restore it in-process
+xrandr --output "$OUTPUT" --gamma 0.6:0.8:1.2
+BEFORE=$(gamma_of "$OUTPUT")
+PATH="$SHIM_DIR:$PATH" ./builddir/vivid-cli --reset
+AFTER=$(gamma_of "$OUTPUT")
+
+echo "  Gamma before reset: $BEFORE"
+echo "  Gamma after reset:  $AFTER"
+
+if [ -n "$AFTER" ] && [ "$BEFORE" != "$AFTER" ]; then
+    echo "✅ Gamma ramps uploaded without external tools"
+else
+    echo "❌ Gamma ramp did not change"
+    exit 1
+fi
+
+# The CLI must leave its change on screen after it exits
+PATH="$SHIM_DIR:$PATH" ./builddir/vivid-cli --set "$OUTPUT" 60
+SET=$(gamma_of "$OUTPUT")
+echo "  Gamma after --set:  $SET"
+
+if [ -n "$SET" ] && [ "$SET" != "$AFTER" ]; then
+    echo "✅ --set persists after the CLI exits"
+else
+    echo "❌ --set was undone on exit"
+    exit 1
+fi
+
+PATH="$SHIM_DIR:$PATH" ./builddir/vivid-cli --reset